@@ -0,0 +1,97 @@
+#include "Benchmark.h"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+
+Benchmark::Benchmark(double minSeconds) : _minSeconds(minSeconds)
+{
+}
+
+
+void Benchmark::measure(const std::string& name, const std::string& dataset,
+    int tips, const std::function<void()>& operation)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::cerr << "Benchmarking " << name << " on " << dataset << "...\n";
+
+    ScopedQuiet quiet;
+
+    // The first run is a warm-up, unless it alone takes the minimum time
+    Clock::time_point start = Clock::now();
+    operation();
+    double seconds = std::chrono::duration_cast
+        <std::chrono::duration<double> >(Clock::now() - start).count();
+    if (seconds >= _minSeconds) {
+        record(name, dataset, tips, 1, seconds);
+        return;
+    }
+
+    long long operations = 0;
+    seconds = 0.0;
+    start = Clock::now();
+
+    // Check the clock less often as the operations prove to be fast
+    long long batch = 1;
+    while (seconds < _minSeconds) {
+        for (long long i = 0; i < batch; i++) {
+            operation();
+        }
+        operations += batch;
+
+        seconds = std::chrono::duration_cast<std::chrono::duration<double> >
+            (Clock::now() - start).count();
+        if (seconds < _minSeconds / 100.0) {
+            batch *= 2;
+        }
+    }
+
+    record(name, dataset, tips, operations, seconds);
+}
+
+
+void Benchmark::record(const std::string& name, const std::string& dataset,
+    int tips, long long operations, double seconds)
+{
+    Result result = {name, dataset, tips, operations, seconds};
+    _results.push_back(result);
+}
+
+
+void Benchmark::writeResults(std::ostream& out) const
+{
+    out << "benchmark,dataset,tips,operations,seconds,ns_per_op,ops_per_sec\n";
+
+    for (const Result& result : _results) {
+        double nsPerOp = 0.0;
+        double opsPerSecond = 0.0;
+        if (result.operations > 0 && result.seconds > 0.0) {
+            nsPerOp = 1.0e9 * result.seconds / result.operations;
+            opsPerSecond = result.operations / result.seconds;
+        }
+
+        out << result.name << ","
+            << result.dataset << ","
+            << result.tips << ","
+            << result.operations << ","
+            << std::setprecision(6) << result.seconds << ","
+            << std::fixed << std::setprecision(1) << nsPerOp << ","
+            << std::setprecision(3) << opsPerSecond << "\n";
+        out.unsetf(std::ios::floatfield);
+    }
+}
+
+
+// A stream without a buffer ignores what is written to it;
+// restoring the buffer clears the stream's error state
+ScopedQuiet::ScopedQuiet() : _coutBuffer(std::cout.rdbuf(NULL))
+{
+}
+
+
+ScopedQuiet::~ScopedQuiet()
+{
+    std::cout.rdbuf(_coutBuffer);
+}
@@ -0,0 +1,64 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <ostream>
+
+
+// Times operations and collects the results, one row per operation and
+// dataset, for writing in CSV format.
+// Screen output (std::cout) is suppressed while an operation is timed.
+
+class Benchmark
+{
+public:
+
+    Benchmark(double minSeconds);
+
+    // Runs the operation once as a warm-up, then repeatedly until at
+    // least minSeconds have passed, and records the time per operation.
+    // Operations slower than minSeconds are only run (and timed) once.
+    void measure(const std::string& name, const std::string& dataset,
+        int tips, const std::function<void()>& operation);
+
+    // Records an operation timed elsewhere
+    void record(const std::string& name, const std::string& dataset,
+        int tips, long long operations, double seconds);
+
+    void writeResults(std::ostream& out) const;
+
+private:
+
+    struct Result
+    {
+        std::string name;
+        std::string dataset;
+        int tips;
+        long long operations;
+        double seconds;
+    };
+
+    double _minSeconds;
+    std::vector<Result> _results;
+};
+
+
+// Suppresses screen output for as long as it is in scope
+
+class ScopedQuiet
+{
+public:
+
+    ScopedQuiet();
+    ~ScopedQuiet();
+
+private:
+
+    std::streambuf* _coutBuffer;
+};
+
+
+#endif
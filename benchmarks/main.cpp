@@ -0,0 +1,385 @@
+// Benchmarks of the main operations of BAMM on the bundled datasets
+// and on synthetic trees. Build and run with "make benchmark", or run
+//     bamm-benchmark [--data-dir DIR] [--output FILE]
+//         [--min-time SECONDS] [--no-synthetic]
+// DIR is the BAMM source directory (default: current directory).
+// Output files of the benchmarked runs are written to the current
+// directory, and the results to FILE (default: benchmark_results.csv).
+
+#include "Benchmark.h"
+
+#include "Settings.h"
+#include "Random.h"
+#include "RandomStreams.h"
+#include "Tree.h"
+#include "Model.h"
+#include "MCMC.h"
+#include "ModelFactory.h"
+#include "ModelDataWriter.h"
+#include "SpExModelFactory.h"
+#include "TraitModelFactory.h"
+#include "ProposalTimer.h"
+#include "SamplingFractions.h"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+
+#define BENCHMARK_SEED 12345
+
+// Speciation rate of the synthetic (pure-birth) trees
+#define SYNTHETIC_SPECIATION_RATE 0.2
+
+// Number of tips per clade in the sampling fraction files of the
+// synthetic trees
+#define SYNTHETIC_CLADE_SIZE 1000
+
+
+struct Dataset
+{
+    std::string name;
+    std::string modelType;
+    std::string controlFile;
+    std::vector<UserParameter> parameters;
+};
+
+
+std::vector<Dataset> bundledDatasets(const std::string& dataDir);
+std::vector<Dataset> syntheticDatasets(const std::string& dataDir);
+void benchmarkDataset(Benchmark& benchmark, const Dataset& dataset);
+void writeSyntheticTree(const std::string& fileName, int tips, Random& random);
+void writeSyntheticTraits(const std::string& fileName, int tips,
+    Random& random);
+void writeSyntheticSamplingFractions(const std::string& fileName, int tips);
+std::string tipName(int tip);
+void exitWithUsage(const char* program);
+
+
+int main(int argc, char* argv[])
+{
+    std::string dataDir = ".";
+    std::string outputFile = "benchmark_results.csv";
+    double minSeconds = 0.5;
+    bool synthetic = true;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--data-dir") == 0 && i + 1 < argc) {
+            dataDir = argv[++i];
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--no-synthetic") == 0) {
+            synthetic = false;
+        } else {
+            exitWithUsage(argv[0]);
+        }
+    }
+
+    std::vector<Dataset> datasets = bundledDatasets(dataDir);
+    if (synthetic) {
+        std::vector<Dataset> syntheticSets = syntheticDatasets(dataDir);
+        datasets.insert(datasets.end(),
+            syntheticSets.begin(), syntheticSets.end());
+    }
+
+    Benchmark benchmark(minSeconds);
+    for (const Dataset& dataset : datasets) {
+        benchmarkDataset(benchmark, dataset);
+    }
+
+    std::ofstream out(outputFile.c_str());
+    if (!out) {
+        std::cerr << "Could not write to " << outputFile << ".\n";
+        return 1;
+    }
+
+    benchmark.writeResults(out);
+    benchmark.writeResults(std::cout);
+
+    return 0;
+}
+
+
+// The diversification trees in problems/ are run with the settings
+// of the whales example
+std::vector<Dataset> bundledDatasets(const std::string& dataDir)
+{
+    const std::string div = dataDir + "/examples/diversification/";
+    const std::string traits = dataDir + "/examples/traits/";
+
+    const char* divExamples[][3] = {
+        {"whales", "whales", "whaletree.tre"},
+        {"anoles", "anoles", "GA_Anolis_MCC.tre"},
+        {"acanthurid", "whales", "../../../problems/acanthurid.tre"},
+        {"balistoidae", "whales", "../../../problems/balistoidae.tre"},
+        {"tetraodontidae", "whales", "../../../problems/tetraodontidae.tre"}
+    };
+
+    const char* traitExamples[][4] = {
+        {"whalesize", "whalesize", "whaletree.tre", "whale_size.txt"},
+        {"primatemass", "primatemass", "primates.tre", "primates_logmass.txt"},
+        {"fishsize", "fishsize", "fishtreeFinalPL_Feb8.tre", "fishmorph.txt"}
+    };
+
+    std::vector<Dataset> datasets;
+
+    for (int i = 0; i < 5; i++) {
+        std::string dir = div + divExamples[i][1] + "/";
+
+        Dataset dataset;
+        dataset.name = divExamples[i][0];
+        dataset.modelType = "speciationextinction";
+        dataset.controlFile = dir + "divcontrol.txt";
+        dataset.parameters.push_back
+            (UserParameter("treefile", dir + divExamples[i][2]));
+        datasets.push_back(dataset);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        std::string dir = traits + traitExamples[i][1] + "/";
+
+        Dataset dataset;
+        dataset.name = traitExamples[i][0];
+        dataset.modelType = "trait";
+        dataset.controlFile = dir + "traitcontrol.txt";
+        dataset.parameters.push_back
+            (UserParameter("treefile", dir + traitExamples[i][2]));
+        dataset.parameters.push_back
+            (UserParameter("traitfile", dir + traitExamples[i][3]));
+        datasets.push_back(dataset);
+    }
+
+    return datasets;
+}
+
+
+// Pure-birth trees (with random trait values, and sampling fractions by
+// clade so that treeLoading includes reading them) are written to the
+// current directory and run with the settings of the whales examples
+std::vector<Dataset> syntheticDatasets(const std::string& dataDir)
+{
+    const int tipCounts[] = {10000, 100000};
+
+    Random random(BENCHMARK_SEED);
+    std::vector<Dataset> datasets;
+
+    for (int tips : tipCounts) {
+        std::ostringstream name;
+        name << "synthetic" << tips;
+
+        std::string treeFile = name.str() + ".tre";
+        std::string traitFile = name.str() + "_traits.txt";
+        std::string samplingFile = name.str() + "_sample_probs.txt";
+        writeSyntheticTree(treeFile, tips, random);
+        writeSyntheticTraits(traitFile, tips, random);
+        writeSyntheticSamplingFractions(samplingFile, tips);
+
+        Dataset divDataset;
+        divDataset.name = name.str();
+        divDataset.modelType = "speciationextinction";
+        divDataset.controlFile =
+            dataDir + "/examples/diversification/whales/divcontrol.txt";
+        divDataset.parameters.push_back(UserParameter("treefile", treeFile));
+        divDataset.parameters.push_back
+            (UserParameter("useGlobalSamplingProbability", "0"));
+        divDataset.parameters.push_back
+            (UserParameter("sampleProbsFilename", samplingFile));
+        datasets.push_back(divDataset);
+
+        Dataset traitDataset;
+        traitDataset.name = name.str();
+        traitDataset.modelType = "trait";
+        traitDataset.controlFile =
+            dataDir + "/examples/traits/whalesize/traitcontrol.txt";
+        traitDataset.parameters.push_back
+            (UserParameter("treefile", treeFile));
+        traitDataset.parameters.push_back
+            (UserParameter("traitfile", traitFile));
+        datasets.push_back(traitDataset);
+    }
+
+    return datasets;
+}
+
+
+void benchmarkDataset(Benchmark& benchmark, const Dataset& dataset)
+{
+    // Every generation is written, to time the output
+    std::vector<UserParameter> parameters = dataset.parameters;
+    parameters.push_back(UserParameter("outName",
+        dataset.name + "_" + dataset.modelType));
+    parameters.push_back(UserParameter("overwrite", "1"));
+    parameters.push_back(UserParameter("numberOfChains", "1"));
+    parameters.push_back(UserParameter("printFreq", "0"));
+    parameters.push_back(UserParameter("mcmcWriteFreq", "1"));
+    parameters.push_back(UserParameter("eventDataWriteFreq", "1"));
+
+    Settings* settings;
+    {
+        ScopedQuiet quiet;
+        settings = new Settings(dataset.controlFile, parameters);
+    }
+
+    ModelFactory* modelFactory = NULL;
+    if (dataset.modelType == "speciationextinction") {
+        modelFactory = new SpExModelFactory;
+    } else {
+        modelFactory = new TraitModelFactory;
+    }
+
+    Random random(BENCHMARK_SEED);
+    RandomStreams streams(BENCHMARK_SEED);
+
+    MCMC* mcmc;
+    {
+        ScopedQuiet quiet;
+        mcmc = new MCMC(streams, 0, *settings, *modelFactory);
+    }
+
+    Model& model = mcmc->model();
+    int tips = model.getTreePtr()->getNumberTips();
+
+    // Name results by model, e.g., "SpExModel::computeLogLikelihood"
+    std::string modelName = (dataset.modelType == "speciationextinction") ?
+        "SpExModel" : "TraitModel";
+
+    benchmark.measure("generation", dataset.name, tips,
+        [&]() { mcmc->step(); });
+
+    const ProposalTimer& timer = model.proposalTimer();
+    for (int p = 0; p < timer.numberOfProposals(); p++) {
+        double seconds = 0.0;
+        for (int phase = 0; phase < ProposalTimer::NumberOfPhases; phase++) {
+            seconds += timer.seconds(p, (ProposalTimer::Phase)phase);
+        }
+
+        benchmark.record("proposal:" + model.proposalName(p), dataset.name,
+            tips, timer.proposalCount(p), seconds);
+    }
+
+    benchmark.measure(modelName + "::computeLogLikelihood", dataset.name,
+        tips, [&]() { model.computeLogLikelihood(); });
+
+    benchmark.measure(modelName + "::setMeanBranchParameters", dataset.name,
+        tips, [&]() { model.setMeanBranchParameters(); });
+
+    // A global event move or a new event resolves a random map position
+    Tree& tree = *model.getTreePtr();
+    benchmark.measure("Tree::mapEventToTree", dataset.name, tips, [&]() {
+        tree.mapEventToTree(random.uniform(0.0, tree.getTotalMapLength()));
+    });
+
+    ModelDataWriter* dataWriter;
+    {
+        ScopedQuiet quiet;
+        dataWriter = modelFactory->createModelDataWriter(*settings);
+    }
+
+    int generation = 0;
+    benchmark.measure("writeData", dataset.name, tips,
+        [&]() { dataWriter->writeData(generation++, model); });
+
+    // The sampling fraction file is read once per process, so it is
+    // forgotten before each tree to be timed with it
+    benchmark.measure("treeLoading", dataset.name, tips, [&]() {
+        SamplingFractions::unloadAll();
+        Tree tree(random, *settings);
+    });
+
+    delete dataWriter;
+    delete mcmc;
+    delete modelFactory;
+    delete settings;
+}
+
+
+// Joins random pairs of lineages backward in time, with exponential
+// waiting times (rate = number of lineages times the speciation rate),
+// so the tree is ultrametric
+void writeSyntheticTree(const std::string& fileName, int tips, Random& random)
+{
+    std::vector<std::string> subtrees;
+    std::vector<double> heights;
+    for (int i = 0; i < tips; i++) {
+        subtrees.push_back(tipName(i));
+        heights.push_back(0.0);
+    }
+
+    std::ostringstream branch;
+    branch << std::setprecision(12);
+
+    double time = 0.0;
+    while (subtrees.size() > 1) {
+        int lineages = (int)subtrees.size();
+        time += random.exponential(lineages * SYNTHETIC_SPECIATION_RATE);
+
+        int first = random.uniformInteger(0, lineages - 1);
+        int second;
+        do {
+            second = random.uniformInteger(0, lineages - 1);
+        } while (second == first);
+
+        branch.str("");
+        branch << "(" << subtrees[first] << ":" << time - heights[first]
+               << "," << subtrees[second] << ":" << time - heights[second]
+               << ")";
+
+        // Replace the first lineage with the joined one,
+        // and the second with the last lineage
+        subtrees[first] = branch.str();
+        heights[first] = time;
+        subtrees[second].swap(subtrees.back());
+        heights[second] = heights.back();
+        subtrees.pop_back();
+        heights.pop_back();
+    }
+
+    std::ofstream treeFile(fileName.c_str());
+    treeFile << subtrees[0] << ";\n";
+}
+
+
+void writeSyntheticTraits(const std::string& fileName, int tips,
+    Random& random)
+{
+    std::ofstream traitFile(fileName.c_str());
+    for (int i = 0; i < tips; i++) {
+        traitFile << tipName(i) << "\t" << random.normal(0.0, 1.0) << "\n";
+    }
+}
+
+
+// Clades are runs of consecutive tip numbers, which are not monophyletic,
+// so internal nodes are assigned to the backbone
+void writeSyntheticSamplingFractions(const std::string& fileName, int tips)
+{
+    std::ofstream samplingFile(fileName.c_str());
+    samplingFile << "1.0\n";
+    for (int i = 0; i < tips; i++) {
+        samplingFile << tipName(i) << "\tclade" << i / SYNTHETIC_CLADE_SIZE
+                     << "\t0.9\n";
+    }
+}
+
+
+std::string tipName(int tip)
+{
+    std::ostringstream name;
+    name << "t" << tip + 1;
+    return name.str();
+}
+
+
+void exitWithUsage(const char* program)
+{
+    std::cerr << "Usage: " << program << " [--data-dir DIR] [--output FILE]"
+              << " [--min-time SECONDS] [--no-synthetic]\n";
+    std::exit(1);
+}
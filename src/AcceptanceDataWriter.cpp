@@ -8,8 +8,14 @@
 
 AcceptanceDataWriter::AcceptanceDataWriter(const Settings& settings) :
     _shouldOutputData(settings.get<bool>("outputAcceptanceInfo")),
-    _outputFileName(settings.get("acceptanceInfoFileName"))
+    _outputFileName(settings.get("acceptanceInfoFileName")),
+    _writeFirstStageRejected(false)
 {
+    // Delayed acceptance is a speciation-extinction setting
+    if (settings.get("modeltype") == "speciationextinction") {
+        _writeFirstStageRejected = settings.get<bool>("delayedAcceptance");
+    }
+
     if (_shouldOutputData) {
         initializeStream();
         writeHeader();
@@ -31,7 +37,12 @@ void AcceptanceDataWriter::writeHeader()
 
 std::string AcceptanceDataWriter::header()
 {
-    return "param,accepted";
+    std::string header = "param,accepted";
+    if (_writeFirstStageRejected) {
+        header += ",firstStageRejected";
+    }
+
+    return header;
 }
 
 
@@ -50,5 +61,9 @@ void AcceptanceDataWriter::writeData(Model& model)
     }
 
     _outputStream << model.getLastParameterUpdated() << ","
-                  << model.getAcceptLastUpdate()     << std::endl;
+                  << model.getAcceptLastUpdate();
+    if (_writeFirstStageRejected) {
+        _outputStream << "," << model.getFirstStageRejectLastUpdate();
+    }
+    _outputStream << std::endl;
 }
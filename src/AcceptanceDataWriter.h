@@ -28,6 +28,9 @@ private:
 
     std::string _outputFileName;
     std::ofstream _outputStream;
+
+    // Only with delayed acceptance, whose first stage can reject
+    bool _writeFirstStageRejected;
 };
 
 
@@ -11,8 +11,8 @@ BetaInitProposal::BetaInitProposal
     (Random& random, Settings& settings, Model& model, Prior& prior) :
         EventParameterProposal(random, settings, model, prior)
 {
-    _weight = _settings.get<double>("updateRateBeta0");
-    _updateBetaInitScale = _settings.get<double>("updateBetaInitScale");
+    _weight = _settings.traitSettings().updateRateBeta0;
+    _updateBetaInitScale = _settings.traitSettings().updateBetaInitScale;
 }
 
 
@@ -66,3 +66,21 @@ double BetaInitProposal::computeLogQRatio()
 {
     return std::log(_cterm);
 }
+
+
+std::string BetaInitProposal::scaleName() const
+{
+    return "updateBetaInitScale";
+}
+
+
+double BetaInitProposal::scale() const
+{
+    return _updateBetaInitScale;
+}
+
+
+void BetaInitProposal::setScale(double scale)
+{
+    _updateBetaInitScale = scale;
+}
@@ -11,18 +11,16 @@ BetaShiftProposal::BetaShiftProposal
     (Random& random, Settings& settings, Model& model, Prior& prior) :
         EventParameterProposal(random, settings, model, prior)
 {
-    _weight = _settings.get<double>("updateRateBetaShift");
-    _updateBetaShiftScale = _settings.get<double>("updateBetaShiftScale");
+    _weight = _settings.traitSettings().updateRateBetaShift;
+    _updateBetaShiftScale = _settings.traitSettings().updateBetaShiftScale;
 }
 
 
-double BetaShiftProposal::acceptanceRatio()
+// Time-constant events have no shift to propose
+bool BetaShiftProposal::canBeAccepted()
 {
-    if (static_cast<TraitBranchEvent*>(_event)->isTimeVariable()) {
-        return EventParameterProposal::acceptanceRatio();
-    } else {
-        return 0.0;
-    }
+    return static_cast<TraitBranchEvent*>(_event)->isTimeVariable() &&
+        EventParameterProposal::canBeAccepted();
 }
 
 
@@ -70,3 +68,21 @@ double BetaShiftProposal::computeNonRootLogPriorRatio()
     return _prior.betaShiftPrior(_proposedParameterValue) -
            _prior.betaShiftPrior(_currentParameterValue);
 }
+
+
+std::string BetaShiftProposal::scaleName() const
+{
+    return "updateBetaShiftScale";
+}
+
+
+double BetaShiftProposal::scale() const
+{
+    return _updateBetaShiftScale;
+}
+
+
+void BetaShiftProposal::setScale(double scale)
+{
+    _updateBetaShiftScale = scale;
+}
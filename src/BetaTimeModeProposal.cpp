@@ -12,7 +12,7 @@ BetaTimeModeProposal::BetaTimeModeProposal
     (Random& random, Settings& settings, Model& model)
     : TimeModeProposal(random, settings, model)
 {
-    _weight = settings.get<double>("updateRateBetaTimeMode");
+    _weight = settings.traitSettings().updateRateBetaTimeMode;
 }
 
 
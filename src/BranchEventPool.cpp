@@ -0,0 +1,69 @@
+#include "BranchEventPool.h"
+#include "BranchEvent.h"
+#include "Log.h"
+
+#include <cstdlib>
+#include <new>
+
+
+BranchEventPool::BranchEventPool() :
+    _slotSize(0), _numberOfAllocations(0), _numberOfReuses(0)
+{
+}
+
+
+BranchEventPool::~BranchEventPool()
+{
+    for (char* chunk : _chunks) {
+        ::operator delete(chunk);
+    }
+}
+
+
+void* BranchEventPool::allocate(std::size_t size)
+{
+    if (_slotSize == 0) {
+        // Round up so that every slot is suitably aligned
+        std::size_t alignment = alignof(std::max_align_t);
+        _slotSize = (size + alignment - 1) / alignment * alignment;
+    } else if (size > _slotSize) {
+        log(Error) << "Branch events of different sizes in the same pool.\n";
+        std::exit(1);
+    }
+
+    _numberOfAllocations++;
+
+    if (_freeSlots.empty()) {
+        allocateChunk();
+    } else {
+        _numberOfReuses++;
+    }
+
+    void* slot = _freeSlots.back();
+    _freeSlots.pop_back();
+    return slot;
+}
+
+
+void BranchEventPool::destroy(BranchEvent* event)
+{
+    if (event == NULL) {
+        return;
+    }
+
+    event->~BranchEvent();
+    _freeSlots.push_back(event);
+}
+
+
+// Slots are pushed in reverse so that they are handed out in address order
+void BranchEventPool::allocateChunk()
+{
+    char* chunk = static_cast<char*>
+        (::operator new(_slotSize * EVENTS_PER_CHUNK));
+    _chunks.push_back(chunk);
+
+    for (int i = EVENTS_PER_CHUNK - 1; i >= 0; i--) {
+        _freeSlots.push_back(chunk + i * _slotSize);
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef BRANCH_EVENT_POOL_H
+#define BRANCH_EVENT_POOL_H
+
+
+#include <vector>
+#include <cstddef>
+
+class BranchEvent;
+
+
+// Recycles the memory of branch events, which are created and destroyed
+// by every event number proposal. Each model (and so each chain) owns
+// its own pool, so chains do not contend for the global allocator.
+// Memory is taken from the heap in chunks of EVENTS_PER_CHUNK events and
+// is only returned to it when the pool is destroyed. All events of a
+// pool must have the same size (that of the model's event type).
+//
+// Events are created with placement new on allocate(), e.g.,
+//     new (pool.allocate(sizeof(SpExBranchEvent))) SpExBranchEvent(...)
+// and must be destroyed with destroy().
+
+#define EVENTS_PER_CHUNK 64
+
+class BranchEventPool
+{
+public:
+
+    BranchEventPool();
+    ~BranchEventPool();
+
+    void* allocate(std::size_t size);
+    void destroy(BranchEvent* event);
+
+    long long numberOfAllocations() const;
+    int numberOfChunks() const;
+
+    // Allocations served without allocating a new chunk
+    long long numberOfReuses() const;
+
+private:
+
+    void allocateChunk();
+
+    std::size_t _slotSize;
+
+    std::vector<char*> _chunks;
+    std::vector<void*> _freeSlots;
+
+    long long _numberOfAllocations;
+    long long _numberOfReuses;
+};
+
+
+inline long long BranchEventPool::numberOfAllocations() const
+{
+    return _numberOfAllocations;
+}
+
+
+inline long long BranchEventPool::numberOfReuses() const
+{
+    return _numberOfReuses;
+}
+
+
+inline int BranchEventPool::numberOfChunks() const
+{
+    return (int)_chunks.size();
+}
+
+
+#endif
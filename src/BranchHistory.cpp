@@ -1,11 +1,13 @@
 #include "BranchHistory.h"
 #include "BranchEvent.h"
+#include "StateLog.h"
 #include "Log.h"
 
 #include <cstdlib>
 
 
-BranchHistory::BranchHistory() : _nodeEvent(NULL), _ancestralNodeEvent(NULL)
+BranchHistory::BranchHistory() : _nodeEvent(NULL), _ancestralNodeEvent(NULL),
+    _stateLog(NULL)
 {
 }
 
@@ -180,6 +182,10 @@ void BranchHistory::printEvent(BranchEvent* event)
 
 void BranchHistory::setNodeEvent(BranchEvent* x)
 {
+    if (_stateLog != NULL) {
+        _stateLog->record(_nodeEvent, x);
+    }
+
     _nodeEvent = x;
 }
 
@@ -192,10 +198,20 @@ BranchEvent* BranchHistory::getNodeEvent()
 
 void BranchHistory::setAncestralNodeEvent(BranchEvent* x)
 {
+    if (_stateLog != NULL) {
+        _stateLog->record(_ancestralNodeEvent, x);
+    }
+
     _ancestralNodeEvent = x;
 }
 
 
+void BranchHistory::setStateLog(StateLog* stateLog)
+{
+    _stateLog = stateLog;
+}
+
+
 BranchEvent* BranchHistory::getAncestralNodeEvent()
 {
     return _ancestralNodeEvent;
@@ -4,6 +4,8 @@
 #include <set>
 #include "BranchEvent.h"
 
+class StateLog;
+
 
 class BranchHistory
 {
@@ -20,6 +22,9 @@ private:
     // the event referenced at nodeEvent
     EventSet _eventsOnBranch;
 
+    // Saves the event pointers overwritten by a proposal (may be NULL)
+    StateLog* _stateLog;
+
 public:
 
     BranchHistory();
@@ -39,6 +44,8 @@ public:
     void   setAncestralNodeEvent(BranchEvent* x);
     BranchEvent* getAncestralNodeEvent();
 
+    void setStateLog(StateLog* stateLog);
+
     void printBranchHistory();
     void reversePrintBranchHistory();
     void printEvent(BranchEvent* event);
@@ -0,0 +1,75 @@
+#include "BranchRatesDataWriter.h"
+#include "Settings.h"
+#include "Model.h"
+#include "Tree.h"
+#include "Node.h"
+
+#include <vector>
+
+
+BranchRatesDataWriter::BranchRatesDataWriter(Settings& settings) :
+    _outputFileName(settings.get("branchRatesOutfile")),
+    _outputFreq(settings.get<int>("branchRatesWriteFreq")),
+    _headerWritten(false)
+{
+    if (_outputFreq > 0) {
+        _outputStream.open(_outputFileName.c_str());
+    }
+}
+
+
+BranchRatesDataWriter::~BranchRatesDataWriter()
+{
+    if (_outputFreq > 0) {
+        _outputStream.close();
+    }
+}
+
+
+// Not all proposals keep the mean branch rates up to date (they are not
+// needed by every likelihood), so they are computed here before writing
+void BranchRatesDataWriter::writeData(int generation, Model& model)
+{
+    if (_outputFreq == 0 || generation % _outputFreq != 0) {
+        return;
+    }
+
+    Tree& tree = *model.getTreePtr();
+    writeHeaderOnce(tree);
+
+    model.setMeanBranchParameters();
+
+    const std::vector<Node*>& nodes = tree.postOrderNodes();
+
+    _outputStream << generation;
+    for (int rate = 0; rate < numberOfRates(); rate++) {
+        for (int i = 0; i < (int)nodes.size(); i++) {
+            _outputStream << "," << branchRate(nodes[i], rate);
+        }
+    }
+    _outputStream << "\n";
+}
+
+
+void BranchRatesDataWriter::writeHeaderOnce(Tree& tree)
+{
+    if (_headerWritten) {
+        return;
+    }
+
+    tree.writeBranchLengthTree(tree.getRoot(), _outputStream);
+    _outputStream << ";\n";
+
+    int numberOfBranches = (int)tree.postOrderNodes().size();
+
+    _outputStream << "generation";
+    for (int rate = 0; rate < numberOfRates(); rate++) {
+        for (int i = 0; i < numberOfBranches; i++) {
+            _outputStream << "," << rateName(rate) << "_" << i;
+        }
+    }
+    _outputStream << "\n";
+
+    _headerWritten = true;
+}
+
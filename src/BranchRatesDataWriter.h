@@ -0,0 +1,47 @@
+#ifndef BRANCH_RATES_DATA_WRITER_H
+#define BRANCH_RATES_DATA_WRITER_H
+
+
+#include <string>
+#include <fstream>
+
+class Settings;
+class Model;
+class Tree;
+class Node;
+
+
+// Writes the mean rates of every branch to a single, persistently open
+// file. The topology is written once, as a Newick tree, followed by a
+// header line. Each sample is then one row with the generation and the
+// mean rates of all branches, in the order in which the branches appear
+// in the Newick tree (post-order, the root last). Models with several
+// rates (e.g., speciation and extinction) write the rates one after the
+// other, all branches for each rate.
+
+class BranchRatesDataWriter
+{
+public:
+
+    BranchRatesDataWriter(Settings& settings);
+    virtual ~BranchRatesDataWriter();
+
+    void writeData(int generation, Model& model);
+
+protected:
+
+    void writeHeaderOnce(Tree& tree);
+
+    virtual int numberOfRates() = 0;
+    virtual std::string rateName(int rate) = 0;
+    virtual double branchRate(Node* node, int rate) = 0;
+
+    std::string _outputFileName;
+    std::ofstream _outputStream;
+    int _outputFreq;
+
+    bool _headerWritten;
+};
+
+
+#endif
@@ -8,7 +8,13 @@
 CommandLineProcessor::CommandLineProcessor(int argc, char* argv[])
 {
     // Start at argv[1] because argv[0] is the program name
-    for (int i = 1; i < argc; i += 2) {
+    int first = 1;
+    if (argc > 1 && std::string(argv[1]) == "simulate") {
+        _command = argv[1];
+        first = 2;
+    }
+
+    for (int i = first; i < argc; i += 2) {
         std::string argName(argv[i]);
 
         // Print help message
@@ -42,7 +48,8 @@ CommandLineProcessor::CommandLineProcessor(int argc, char* argv[])
     }
 
     // Print help message if control file was not specified
-    if (_controlFileName == "") {
+    // (simulations take only parameters)
+    if (_controlFileName == "" && _command == "") {
         exitWithMessage(usageText());
     }
 }
@@ -51,7 +58,8 @@ CommandLineProcessor::CommandLineProcessor(int argc, char* argv[])
 std::string CommandLineProcessor::usageText() const
 {
     return "Usage: bamm -c <control-file> "
-        "[--<parameter-name> <parameter-value> ...]";
+        "[--<parameter-name> <parameter-value> ...]\n"
+        "       bamm simulate [--<parameter-name> <parameter-value> ...]";
 }
 
 
@@ -81,6 +89,12 @@ std::string CommandLineProcessor::invalidArgumentNameText() const
 }
 
 
+const std::string& CommandLineProcessor::command() const
+{
+    return _command;
+}
+
+
 const std::string& CommandLineProcessor::controlFileName() const
 {
     return _controlFileName;
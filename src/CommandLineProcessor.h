@@ -14,6 +14,9 @@ public:
 
     CommandLineProcessor(int argc, char* argv[]);
 
+    // Empty, or "simulate" for "bamm simulate [--<parameter> <value> ...]"
+    const std::string& command() const;
+
     const std::string& controlFileName() const;
     const std::vector<UserParameter>& parameters() const;
 
@@ -25,6 +28,7 @@ private:
     bool startsWithTwoHyphens(const std::string& str) const;
     std::string invalidArgumentNameText() const;
 
+    std::string _command;
     std::string _controlFileName;
     std::vector<UserParameter> _parameters;
 };
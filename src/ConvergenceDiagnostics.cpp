@@ -0,0 +1,196 @@
+#include "ConvergenceDiagnostics.h"
+#include "Settings.h"
+#include "Model.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+
+// Number of values followed (N_shifts, logPrior, logLik, eventRate)
+#define NUMBER_OF_DIAGNOSED_VALUES 4
+
+// Fewer samples (after the burn-in) give no diagnostics
+#define MIN_DIAGNOSED_SAMPLES 10
+
+
+ConvergenceDiagnostics::ConvergenceDiagnostics(Settings& settings) :
+    _sampleFreq(settings.get<int>("mcmcWriteFreq")),
+    _bufferSize(settings.get<int>("convergenceBufferSize")),
+    _burnIn(settings.get<double>("convergenceBurnIn")),
+    _targetEffectiveSampleSize(settings.get<double>("convergenceTargetESS")),
+    _targetRhat(settings.get<double>("convergenceMaxRhat")),
+    _thinning(1),
+    _numberOfSampledGenerations(0),
+    _samples(NUMBER_OF_DIAGNOSED_VALUES),
+    _hasDiagnostics(false),
+    _minEffectiveSampleSize(0.0),
+    _maxSplitRhat(0.0)
+{
+    if (_bufferSize < 2 * MIN_DIAGNOSED_SAMPLES) {
+        log(Error) << "convergenceBufferSize must be at least "
+                   << 2 * MIN_DIAGNOSED_SAMPLES << ".\n";
+        std::exit(1);
+    }
+
+    if (_burnIn < 0.0 || _burnIn >= 1.0) {
+        log(Error) << "convergenceBurnIn must be at least 0 "
+                   << "and less than 1.\n";
+        std::exit(1);
+    }
+
+    if (_targetEffectiveSampleSize > 0.0 && _sampleFreq == 0) {
+        log(Error) << "The convergence stopping rule (convergenceTargetESS) "
+                   << "requires mcmcWriteFreq to be greater than 0.\n";
+        std::exit(1);
+    }
+}
+
+
+void ConvergenceDiagnostics::addSample(int generation, Model& model)
+{
+    if (_sampleFreq == 0 || generation % _sampleFreq != 0) {
+        return;
+    }
+
+    _numberOfSampledGenerations++;
+    if ((_numberOfSampledGenerations - 1) % _thinning != 0) {
+        return;
+    }
+
+    _samples[0].push_back(model.getNumberOfEvents());
+    _samples[1].push_back(model.computeLogPrior());
+    _samples[2].push_back(model.getCurrentLogLikelihood());
+    _samples[3].push_back(model.getEventRate());
+
+    if ((int)_samples[0].size() >= _bufferSize) {
+        thinSamples();
+    }
+
+    updateDiagnostics();
+}
+
+
+void ConvergenceDiagnostics::thinSamples()
+{
+    for (std::vector<double>& values : _samples) {
+        int kept = 0;
+        for (int i = 0; i < (int)values.size(); i += 2) {
+            values[kept++] = values[i];
+        }
+        values.resize(kept);
+    }
+
+    _thinning *= 2;
+}
+
+
+void ConvergenceDiagnostics::updateDiagnostics()
+{
+    int numberOfSamples = (int)_samples[0].size();
+    int burnInSamples = (int)(_burnIn * numberOfSamples);
+
+    if (numberOfSamples - burnInSamples < MIN_DIAGNOSED_SAMPLES) {
+        _hasDiagnostics = false;
+        return;
+    }
+
+    _minEffectiveSampleSize = INFINITY;
+    _maxSplitRhat = 0.0;
+
+    for (const std::vector<double>& values : _samples) {
+        std::vector<double> sampled(values.begin() + burnInSamples,
+            values.end());
+
+        _minEffectiveSampleSize = std::min(_minEffectiveSampleSize,
+            effectiveSampleSize(sampled));
+        _maxSplitRhat = std::max(_maxSplitRhat, splitRhat(sampled));
+    }
+
+    _hasDiagnostics = true;
+}
+
+
+bool ConvergenceDiagnostics::hasConverged() const
+{
+    return _targetEffectiveSampleSize > 0.0 && _hasDiagnostics &&
+        _minEffectiveSampleSize >= _targetEffectiveSampleSize &&
+        _maxSplitRhat <= _targetRhat;
+}
+
+
+// Batch means: the samples are divided into about sqrt(n) batches of
+// about sqrt(n) samples. A value that does not vary is taken as having
+// an effective sample size equal to the number of samples.
+double ConvergenceDiagnostics::effectiveSampleSize
+    (const std::vector<double>& values)
+{
+    int n = (int)values.size();
+    int batchSize = (int)std::sqrt((double)n);
+    int numberOfBatches = n / batchSize;
+
+    std::vector<double> batchMeans;
+    for (int b = 0; b < numberOfBatches; b++) {
+        double sum = 0.0;
+        for (int i = b * batchSize; i < (b + 1) * batchSize; i++) {
+            sum += values[i];
+        }
+        batchMeans.push_back(sum / batchSize);
+    }
+
+    double sampleVariance = variance(values);
+    double batchMeansVariance = variance(batchMeans);
+
+    if (batchMeansVariance <= 0.0) {
+        return n;
+    }
+
+    double ess = n * sampleVariance / (batchSize * batchMeansVariance);
+    return std::min(ess, (double)n);
+}
+
+
+// Gelman et al. (2013), Bayesian Data Analysis, 3rd edition, p. 284-285,
+// with the two halves of the trace as the chains
+double ConvergenceDiagnostics::splitRhat(const std::vector<double>& values)
+{
+    int m = (int)values.size() / 2;
+
+    std::vector<double> firstHalf(values.begin(), values.begin() + m);
+    std::vector<double> secondHalf(values.end() - m, values.end());
+
+    double within = 0.5 * (variance(firstHalf) + variance(secondHalf));
+    if (within <= 0.0) {
+        return 1.0;
+    }
+
+    double meanDifference = mean(firstHalf) - mean(secondHalf);
+    double betweenOverM = 0.5 * meanDifference * meanDifference;
+
+    double pooledVariance = (m - 1.0) / m * within + betweenOverM;
+    return std::sqrt(pooledVariance / within);
+}
+
+
+double ConvergenceDiagnostics::mean(const std::vector<double>& values)
+{
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    return sum / values.size();
+}
+
+
+// Two-pass algorithm, which is exact (zero) for constant values
+double ConvergenceDiagnostics::variance(const std::vector<double>& values)
+{
+    double m = mean(values);
+
+    double sumSquares = 0.0;
+    for (double value : values) {
+        sumSquares += (value - m) * (value - m);
+    }
+    return sumSquares / (values.size() - 1);
+}
@@ -0,0 +1,85 @@
+#ifndef CONVERGENCE_DIAGNOSTICS_H
+#define CONVERGENCE_DIAGNOSTICS_H
+
+
+#include <vector>
+
+class Settings;
+class Model;
+
+
+// Tracks the convergence of the cold chain while it runs. The values
+// written to the MCMC output file (N_shifts, logPrior, logLik and
+// eventRate) are sampled every mcmcWriteFreq generations into a buffer
+// of bounded size; when it is full, every other sample is dropped and
+// the sampling interval doubles, so the buffer always spans the run.
+// After discarding convergenceBurnIn (a fraction) of the buffer, the
+// effective sample size of each value is estimated by batch means and
+// the potential scale reduction factor by split-R-hat (the trace is
+// split in two halves, which are compared as two chains).
+
+class ConvergenceDiagnostics
+{
+public:
+
+    ConvergenceDiagnostics(Settings& settings);
+
+    void addSample(int generation, Model& model);
+
+    bool hasDiagnostics() const;
+    double minEffectiveSampleSize() const;
+    double maxSplitRhat() const;
+
+    // True if the stopping rule is enabled (convergenceTargetESS > 0)
+    // and all effective sample sizes and R-hats meet their targets
+    bool hasConverged() const;
+
+private:
+
+    void thinSamples();
+    void updateDiagnostics();
+
+    static double effectiveSampleSize(const std::vector<double>& values);
+    static double splitRhat(const std::vector<double>& values);
+    static double mean(const std::vector<double>& values);
+    static double variance(const std::vector<double>& values);
+
+    int _sampleFreq;
+    int _bufferSize;
+    double _burnIn;
+
+    double _targetEffectiveSampleSize;
+    double _targetRhat;
+
+    // Only every _thinning-th sample is kept
+    int _thinning;
+    long long _numberOfSampledGenerations;
+
+    // Indexed by value, then by sample
+    std::vector<std::vector<double> > _samples;
+
+    bool _hasDiagnostics;
+    double _minEffectiveSampleSize;
+    double _maxSplitRhat;
+};
+
+
+inline bool ConvergenceDiagnostics::hasDiagnostics() const
+{
+    return _hasDiagnostics;
+}
+
+
+inline double ConvergenceDiagnostics::minEffectiveSampleSize() const
+{
+    return _minEffectiveSampleSize;
+}
+
+
+inline double ConvergenceDiagnostics::maxSplitRhat() const
+{
+    return _maxSplitRhat;
+}
+
+
+#endif
@@ -23,3 +23,14 @@ EventCountLog::EventCountLog(int x)
 }
 
 
+void EventCountLog::add(const EventCountLog& other)
+{
+    _addProposeCount += other._addProposeCount;
+    _addAcceptCount += other._addAcceptCount;
+    _subtractProposeCount += other._subtractProposeCount;
+    _subtractAcceptCount += other._subtractAcceptCount;
+
+    _inStateCount += other._inStateCount;
+}
+
+
@@ -19,19 +19,22 @@ public:
     EventCountLog(int x);
     
     
-    int getAddProposeCount();
+    int getAddProposeCount() const;
     void incrementAddProposeCount();
-    int getAddAcceptCount();
+    int getAddAcceptCount() const;
     void incrementAddAcceptCount();
-    int getSubtractProposeCount();
+    int getSubtractProposeCount() const;
     void incrementSubtractProposeCount();
-    int getSubtractAcceptCount();
+    int getSubtractAcceptCount() const;
     void incrementSubtractAcceptCount();
     
-    int getEventCount();
+    int getEventCount() const;
  
-    int getInStateCount();
+    int getInStateCount() const;
     void incrementInStateCount();
+
+    // Adds the counts of another log of the same event count
+    void add(const EventCountLog& other);
     
 private:
 
@@ -47,7 +50,7 @@ private:
 };
  
 
-inline int EventCountLog::getAddAcceptCount()
+inline int EventCountLog::getAddAcceptCount() const
 {
     return _addAcceptCount;
 }
@@ -57,7 +60,7 @@ inline void EventCountLog::incrementAddAcceptCount()
     _addAcceptCount++;
 }
 
-inline int EventCountLog::getAddProposeCount()
+inline int EventCountLog::getAddProposeCount() const
 {
     return _addProposeCount;
 }
@@ -67,7 +70,7 @@ inline void EventCountLog::incrementAddProposeCount()
     _addProposeCount++;
 }
 
-inline int EventCountLog::getSubtractProposeCount()
+inline int EventCountLog::getSubtractProposeCount() const
 {
     return _subtractProposeCount;
 }
@@ -77,7 +80,7 @@ inline void EventCountLog::incrementSubtractProposeCount()
     _subtractProposeCount++;
 }
 
-inline int EventCountLog::getSubtractAcceptCount()
+inline int EventCountLog::getSubtractAcceptCount() const
 {
     return _subtractAcceptCount;
 }
@@ -87,13 +90,13 @@ inline void EventCountLog::incrementSubtractAcceptCount()
     _subtractAcceptCount++;
 }
 
-inline int EventCountLog::getEventCount()
+inline int EventCountLog::getEventCount() const
 {
     return _eventCount;
 }
 
 
-inline int EventCountLog::getInStateCount()
+inline int EventCountLog::getInStateCount() const
 {
     return _inStateCount;
 }
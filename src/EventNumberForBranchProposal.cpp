@@ -4,16 +4,17 @@
 #include "Model.h"
 
 #include <algorithm>
+#include <cmath>
 
 
 EventNumberForBranchProposal::EventNumberForBranchProposal
     (Random& random, Settings& settings, Model& model) :
         _random(random), _model(model)
 {
-    _weight = settings.get<double>("updateRateEventNumberForBranch");
+    _weight = settings.proposalSettings().updateRateEventNumberForBranch;
 
     _validateEventConfiguration =
-        settings.get<bool>("validateEventConfiguration");
+        settings.modelSettings().validateEventConfiguration;
 
     Tree& tree = *(model.getTreePtr());
     _numberOfBranches = tree.getNumberOfNodes() - 1;    // don't count the root
@@ -27,6 +28,11 @@ void EventNumberForBranchProposal::propose()
     _currentLogLikelihood = _model.getCurrentLogLikelihood();
     _currentLogPrior = _model.computeLogPrior();
 
+    if (_model.delayedAcceptance()) {
+        _currentSurrogateLogLikelihood =
+            _model.getCurrentSurrogateLogLikelihood();
+    }
+
     bool shouldAddEvent = (_currentEventCount == 0) ||
         _random.trueWithProbability(0.5);
 
@@ -41,8 +47,17 @@ void EventNumberForBranchProposal::propose()
     _model.setMeanBranchParameters();
 
     _proposedEventCount = _model.getNumberOfEvents();
-    _proposedLogLikelihood = _model.computeLogLikelihood();
     _proposedLogPrior = _model.computeLogPrior();
+
+    _canBeAccepted = canBeAccepted();
+
+    // The exact likelihood is computed in acceptanceRatio(), only if the
+    // proposal can be accepted (with delayed acceptance, only if it also
+    // passes the first stage)
+    if (_model.delayedAcceptance()) {
+        _proposedSurrogateLogLikelihood =
+            _model.computeSurrogateLogLikelihood();
+    }
 }
 
 
@@ -50,41 +65,60 @@ void EventNumberForBranchProposal::accept()
 {
     if (_lastProposal == RemoveEvent) {
         if (_lastEventChanged != NULL) {
-            delete _lastEventChanged;
+            _model.destroyBranchEvent(_lastEventChanged);
             _lastEventChanged = NULL;
         }
     }
 
     _model.setCurrentLogLikelihood(_proposedLogLikelihood);
+
+    if (_model.delayedAcceptance()) {
+        _model.setCurrentSurrogateLogLikelihood
+            (_proposedSurrogateLogLikelihood);
+    }
 }
 
 
 void EventNumberForBranchProposal::reject()
 {
     if (_lastProposal == AddEvent) {
-        _model.removeEventFromTree(_lastEventChanged);
-        _model.setMeanBranchParameters();
-        delete _lastEventChanged;
+        _model.detachEvent(_lastEventChanged);
+        _model.rollbackState();
+        _model.destroyBranchEvent(_lastEventChanged);
         _lastEventChanged = NULL;
     } else if (_lastProposal == RemoveEvent) {
-        _model.addEventToTree(_lastEventChanged);
+        _model.reattachEvent(_lastEventChanged);
+        _model.rollbackState();
     }
 }
 
 
 double EventNumberForBranchProposal::acceptanceRatio()
 {
-    if (_validateEventConfiguration && _lastProposal == AddEvent &&
-            !_model.isEventConfigurationValid(_lastEventChanged)) {
+    if (!_canBeAccepted) {
+        _model.skipLikelihoodEvaluation();
         return 0.0;
     }
 
-    double logLikelihoodRatio = computeLogLikelihoodRatio();
-    double logPriorRatio = computeLogPriorRatio();
-    double logQRatio = computeLogQRatio();
-
     double t = _model.getTemperatureMH();
-    double logRatio = t * (logLikelihoodRatio + logPriorRatio) + logQRatio;
+    double logRatio;
+
+    if (_model.delayedAcceptance()) {
+        double logSurrogateRatio =
+            _proposedSurrogateLogLikelihood - _currentSurrogateLogLikelihood;
+        if (!_model.passesFirstStage
+                (t * (logSurrogateRatio + _logPriorRatio) + _logQRatio)) {
+            return 0.0;
+        }
+
+        // Second stage corrects for the error of the surrogate
+        _proposedLogLikelihood = _model.computeLogLikelihood();
+        logRatio = t * (computeLogLikelihoodRatio() - logSurrogateRatio);
+    } else {
+        _proposedLogLikelihood = _model.computeLogLikelihood();
+        double logLikelihoodRatio = computeLogLikelihoodRatio();
+        logRatio = t * (logLikelihoodRatio + _logPriorRatio) + _logQRatio;
+    }
 
     if (std::isfinite(logRatio)) {
         return std::min(1.0, std::exp(logRatio));
@@ -94,6 +128,27 @@ double EventNumberForBranchProposal::acceptanceRatio()
 }
 
 
+bool EventNumberForBranchProposal::needsLikelihood() const
+{
+    return _canBeAccepted && !_model.delayedAcceptance();
+}
+
+
+// Computes the ratios that do not depend on the likelihood
+bool EventNumberForBranchProposal::canBeAccepted()
+{
+    if (_validateEventConfiguration && _lastProposal == AddEvent &&
+            !_model.isEventConfigurationValid(_lastEventChanged)) {
+        return false;
+    }
+
+    _logPriorRatio = computeLogPriorRatio();
+    _logQRatio = computeLogQRatio();
+
+    return std::isfinite(_logPriorRatio) && std::isfinite(_logQRatio);
+}
+
+
 double EventNumberForBranchProposal::computeLogLikelihoodRatio()
 {
     return _proposedLogLikelihood - _currentLogLikelihood;
@@ -4,16 +4,17 @@
 #include "Model.h"
 
 #include <algorithm>
+#include <cmath>
 
 
 EventNumberProposal::EventNumberProposal
     (Random& random, Settings& settings, Model& model) :
         _random(random), _model(model)
 {
-    _weight = settings.get<double>("updateRateEventNumber");
+    _weight = settings.proposalSettings().updateRateEventNumber;
 
     _validateEventConfiguration =
-        settings.get<bool>("validateEventConfiguration");
+        settings.modelSettings().validateEventConfiguration;
 }
 
 
@@ -23,6 +24,11 @@ void EventNumberProposal::propose()
     _currentLogLikelihood = _model.getCurrentLogLikelihood();
     _currentLogPrior = _model.computeLogPrior();
 
+    if (_model.delayedAcceptance()) {
+        _currentSurrogateLogLikelihood =
+            _model.getCurrentSurrogateLogLikelihood();
+    }
+
     bool shouldAddEvent = (_currentEventCount == 0) ||
         _random.trueWithProbability(0.5);
 
@@ -37,8 +43,17 @@ void EventNumberProposal::propose()
     _model.setMeanBranchParameters();
 
     _proposedEventCount = _model.getNumberOfEvents();
-    _proposedLogLikelihood = _model.computeLogLikelihood();
     _proposedLogPrior = _model.computeLogPrior();
+
+    _canBeAccepted = canBeAccepted();
+
+    // The exact likelihood is computed in acceptanceRatio(), only if the
+    // proposal can be accepted (with delayed acceptance, only if it also
+    // passes the first stage)
+    if (_model.delayedAcceptance()) {
+        _proposedSurrogateLogLikelihood =
+            _model.computeSurrogateLogLikelihood();
+    }
 }
 
 
@@ -46,41 +61,60 @@ void EventNumberProposal::accept()
 {
     if (_lastProposal == RemoveEvent) {
         if (_lastEventChanged != NULL) {
-            delete _lastEventChanged;
+            _model.destroyBranchEvent(_lastEventChanged);
             _lastEventChanged = NULL;
         }
     }
 
     _model.setCurrentLogLikelihood(_proposedLogLikelihood);
+
+    if (_model.delayedAcceptance()) {
+        _model.setCurrentSurrogateLogLikelihood
+            (_proposedSurrogateLogLikelihood);
+    }
 }
 
 
 void EventNumberProposal::reject()
 {
     if (_lastProposal == AddEvent) {
-        _model.removeEventFromTree(_lastEventChanged);
-        _model.setMeanBranchParameters();
-        delete _lastEventChanged;
+        _model.detachEvent(_lastEventChanged);
+        _model.rollbackState();
+        _model.destroyBranchEvent(_lastEventChanged);
         _lastEventChanged = NULL;
     } else if (_lastProposal == RemoveEvent) {
-        _model.addEventToTree(_lastEventChanged);
+        _model.reattachEvent(_lastEventChanged);
+        _model.rollbackState();
     }
 }
 
 
 double EventNumberProposal::acceptanceRatio()
 {
-    if (_validateEventConfiguration && _lastProposal == AddEvent &&
-            !_model.isEventConfigurationValid(_lastEventChanged)) {
+    if (!_canBeAccepted) {
+        _model.skipLikelihoodEvaluation();
         return 0.0;
     }
 
-    double logLikelihoodRatio = computeLogLikelihoodRatio();
-    double logPriorRatio = computeLogPriorRatio();
-    double logQRatio = computeLogQRatio();
-
     double t = _model.getTemperatureMH();
-    double logRatio = t * (logLikelihoodRatio + logPriorRatio) + logQRatio;
+    double logRatio;
+
+    if (_model.delayedAcceptance()) {
+        double logSurrogateRatio =
+            _proposedSurrogateLogLikelihood - _currentSurrogateLogLikelihood;
+        if (!_model.passesFirstStage
+                (t * (logSurrogateRatio + _logPriorRatio) + _logQRatio)) {
+            return 0.0;
+        }
+
+        // Second stage corrects for the error of the surrogate
+        _proposedLogLikelihood = _model.computeLogLikelihood();
+        logRatio = t * (computeLogLikelihoodRatio() - logSurrogateRatio);
+    } else {
+        _proposedLogLikelihood = _model.computeLogLikelihood();
+        double logLikelihoodRatio = computeLogLikelihoodRatio();
+        logRatio = t * (logLikelihoodRatio + _logPriorRatio) + _logQRatio;
+    }
 
     if (std::isfinite(logRatio)) {
         return std::min(1.0, std::exp(logRatio));
@@ -90,6 +124,27 @@ double EventNumberProposal::acceptanceRatio()
 }
 
 
+bool EventNumberProposal::needsLikelihood() const
+{
+    return _canBeAccepted && !_model.delayedAcceptance();
+}
+
+
+// Computes the ratios that do not depend on the likelihood
+bool EventNumberProposal::canBeAccepted()
+{
+    if (_validateEventConfiguration && _lastProposal == AddEvent &&
+            !_model.isEventConfigurationValid(_lastEventChanged)) {
+        return false;
+    }
+
+    _logPriorRatio = computeLogPriorRatio();
+    _logQRatio = computeLogQRatio();
+
+    return std::isfinite(_logPriorRatio) && std::isfinite(_logQRatio);
+}
+
+
 double EventNumberProposal::computeLogLikelihoodRatio()
 {
     return _proposedLogLikelihood - _currentLogLikelihood;
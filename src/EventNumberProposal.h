@@ -27,9 +27,13 @@ public:
     virtual void reject();
 
     virtual double acceptanceRatio();
+    virtual bool needsLikelihood() const;
 
 private:
 
+    // Whether the proposal can be accepted whatever its likelihood
+    bool canBeAccepted();
+
     double computeLogLikelihoodRatio();
     double computeLogPriorRatio();
     double computeLogQRatio();
@@ -42,10 +46,16 @@ private:
     int _currentEventCount;
     double _currentLogLikelihood;
     double _currentLogPrior;
+    double _currentSurrogateLogLikelihood;
 
     int _proposedEventCount;
     double _proposedLogLikelihood;
     double _proposedLogPrior;
+    double _proposedSurrogateLogLikelihood;
+
+    bool _canBeAccepted;
+    double _logPriorRatio;
+    double _logQRatio;
 
     ProposalType _lastProposal;
     BranchEvent* _lastEventChanged;
@@ -29,7 +29,7 @@ void EventParameterProposal::propose()
 
     updateParameterOnTree();
 
-    _proposedLogLikelihood = _model.computeLogLikelihood();
+    _canBeAccepted = canBeAccepted();
 }
 
 
@@ -42,18 +42,24 @@ void EventParameterProposal::accept()
 void EventParameterProposal::reject()
 {
     revertToOldParameterValue();
-    updateParameterOnTree();
+    _model.rollbackState();
 }
 
 
+// The likelihood is not computed at all if the proposal is rejected
+// whatever its value
 double EventParameterProposal::acceptanceRatio()
 {
+    if (!_canBeAccepted) {
+        _model.skipLikelihoodEvaluation();
+        return 0.0;
+    }
+
+    _proposedLogLikelihood = _model.computeLogLikelihood();
     double logLikelihoodRatio = computeLogLikelihoodRatio();
-    double logPriorRatio = computeLogPriorRatio();
-    double logQRatio = computeLogQRatio();
 
     double t = _model.getTemperatureMH();
-    double logRatio = t * (logLikelihoodRatio + logPriorRatio) + logQRatio;
+    double logRatio = t * (logLikelihoodRatio + _logPriorRatio) + _logQRatio;
 
     if (std::isfinite(logRatio)) {
         return std::min(1.0, std::exp(logRatio));
@@ -63,6 +69,22 @@ double EventParameterProposal::acceptanceRatio()
 }
 
 
+bool EventParameterProposal::needsLikelihood() const
+{
+    return _canBeAccepted;
+}
+
+
+// Computes the ratios that do not depend on the likelihood
+bool EventParameterProposal::canBeAccepted()
+{
+    _logPriorRatio = computeLogPriorRatio();
+    _logQRatio = computeLogQRatio();
+
+    return std::isfinite(_logPriorRatio) && std::isfinite(_logQRatio);
+}
+
+
 double EventParameterProposal::computeLogLikelihoodRatio()
 {
     return _proposedLogLikelihood - _currentLogLikelihood;
@@ -24,9 +24,13 @@ public:
     virtual void reject();
 
     virtual double acceptanceRatio();
+    virtual bool needsLikelihood() const;
 
 protected:
 
+    // Whether the proposal can be accepted whatever its likelihood
+    virtual bool canBeAccepted();
+
     virtual double getCurrentParameterValue() = 0;
     virtual double computeNewParameterValue() = 0;
 
@@ -54,6 +58,10 @@ protected:
 
     double _currentLogLikelihood;
     double _proposedLogLikelihood;
+
+    bool _canBeAccepted;
+    double _logPriorRatio;
+    double _logQRatio;
 };
 
 
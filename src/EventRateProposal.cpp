@@ -13,8 +13,9 @@ EventRateProposal::EventRateProposal
     (Random& random, Settings& settings, Model& model, Prior& prior) :
         _random(random), _settings(settings), _model(model), _prior(prior)
 {
-    _weight = _settings.get<double>("updateRateEventRate");
-    _updateEventRateScale = _settings.get<double>("updateEventRateScale");
+    _weight = _settings.proposalSettings().updateRateEventRate;
+    _updateEventRateScale = _settings.proposalSettings().updateEventRateScale;
+    _poissonRatePrior = _settings.priorSettings().poissonRatePrior;
 }
 
 
@@ -90,7 +91,7 @@ double EventRateProposal::computeLogPosteriorRatio()
     double NN = (double)_model.getNumberOfEvents();
     
     double logPosteriorRatio = NN * (std::log(_proposedEventRate) - std::log(_currentEventRate) );
-    logPosteriorRatio += (_settings.get<double>("poissonRatePrior") + 1 ) * (_currentEventRate - _proposedEventRate);
+    logPosteriorRatio += (_poissonRatePrior + 1 ) * (_currentEventRate - _proposedEventRate);
     
     return logPosteriorRatio;
 
@@ -99,3 +100,19 @@ double EventRateProposal::computeLogPosteriorRatio()
 #undef USE_ANALYTICAL_POSTERIOR
 
 
+std::string EventRateProposal::scaleName() const
+{
+    return "updateEventRateScale";
+}
+
+
+double EventRateProposal::scale() const
+{
+    return _updateEventRateScale;
+}
+
+
+void EventRateProposal::setScale(double scale)
+{
+    _updateEventRateScale = scale;
+}
@@ -23,6 +23,10 @@ public:
 
     virtual double acceptanceRatio();
 
+    virtual std::string scaleName() const;
+    virtual double scale() const;
+    virtual void setScale(double scale);
+
 private:
 
     double computeLogLikelihoodRatio();
@@ -36,6 +40,7 @@ private:
     Prior& _prior;
 
     double _updateEventRateScale;
+    double _poissonRatePrior;
 
     double _currentEventRate;
     double _proposedEventRate;
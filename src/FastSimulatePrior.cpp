@@ -8,48 +8,44 @@
 
 #include "FastSimulatePrior.h"
 
-#include <sstream>
+#include <algorithm>
 #include <fstream>
 #include <iostream>
-#include <iomanip>
 #include <cstdlib>
+#include <limits>
+#include <thread>
 #include <vector>
 
 #include "Random.h"
 #include "Settings.h"
-#include "Stat.h"
-#include "EventCountLog.h"
+#include "Log.h"
 
-#define USE_ANALYTICAL_POSTERIOR_EVENTRATE
 
-FastSimulatePrior::FastSimulatePrior(Random& random, Settings* sp) :
-    _random(random), sttings(sp)
+FastSimulatePrior::Simulation::Simulation
+    (unsigned long int seed, double eventRate, int maxEvents) :
+        random(seed), eventRate(eventRate), numberEvents(0)
 {
+    for (int i = 0; i <= maxEvents; i++) {
+        trackingVector.push_back(EventCountLog(i));
+    }
+}
 
-    /**** New params May 23 2014 ****/
-
-    _maxEvents = sttings->get<double>("maxNumberEvents");
-    _intervalGens = sttings->get<double>("priorSim_IntervalGenerations");
-
-
-    // End new params
-
-    _generations = 0;
 
-    _eventRate = 1 / sttings->get<double>("poissonRatePrior");
+FastSimulatePrior::FastSimulatePrior(Random& random, Settings* sp) :
+    _random(random), sttings(sp), _nextInterval(1)
+{
+    _maxEvents = sttings->get<int>("maxNumberEvents");
+    _intervalGens = sttings->get<int>("priorSim_IntervalGenerations");
 
     _updateEventRateScale = sttings->get<double>("updateEventRateScale");
-
     _poissonRatePrior = sttings->get<double>("poissonRatePrior");
-    _numberEvents = 0;
 
-    /********* EventCountLog stuff *****************/
-    // Setting up vector of event transition data...
-    for (int i = 0; i <= _maxEvents; i++){
-        EventCountLog *ecl = new EventCountLog(i);
-        _TrackingVector.push_back(ecl);
-    }
+    _outfileName = sttings->get("priorOutputFileName");
 
+    if (sttings->get<bool>("exactPriorShifts")) {
+        computeExactPrior();
+        return;
+    }
 
     // Cannot figure out why new way and old ways of doing this
     // give different results, hence leave "old way" as the default.
@@ -57,181 +53,226 @@ FastSimulatePrior::FastSimulatePrior(Random& random, Settings* sp) :
     // but for now, I (DLR) find slight discrepancies between distributions
     // generated by these that I cannot yet reconcile
 
-
-    if (sttings->get<bool>("fastSimulatePriorExperimental")){
+    if (sttings->get<bool>("fastSimulatePriorExperimental")) {
         fastSimulatePriorExperimental();
-    }else{
+    } else {
         fastSimulatePriorOldWay();
     }
+}
 
 
+// Integrating the Poisson probability of k events over the exponential
+// prior on its rate gives p / (1 + p)^(k + 1)
+void FastSimulatePrior::computeExactPrior()
+{
+    log() << "\nComputing the prior distribution on shifts "
+          << "with poissonRatePrior = " << _poissonRatePrior << ".\n";
 
+    double logSuccess = std::log(_poissonRatePrior) -
+        std::log(1.0 + _poissonRatePrior);
+    double logFailure = -std::log(1.0 + _poissonRatePrior);
 
-}
+    std::vector<double> probs;
+    for (int k = 0; k <= _maxEvents; k++) {
+        probs.push_back(std::exp(logSuccess + k * logFailure));
+    }
 
-FastSimulatePrior::~FastSimulatePrior()
-{
-    _fspOutStream.close();
+    writePriorProbsToFile(probs);
 }
 
 
-void FastSimulatePrior::fastSimulatePriorExperimental()
+// Each thread runs its own chain, with its own burn-in,
+// for an equal share of the generations
+void FastSimulatePrior::fastSimulatePriorOldWay()
 {
+    int threads = numberOfThreads();
 
-    std::cout << "\nSimulating prior distribution with poissonRatePrior = << ";
-    std::cout << _poissonRatePrior << " >>\n" << std::endl;
+    log() << "\nSimulating prior distribution on shifts with "
+          << threads << " threads...\n";
 
+    int generations = sttings->get<int>("fastSimulatePrior_Generations");
+    double burnIn = sttings->get<double>("fastSimulatePrior_BurnIn");
 
-    for (int i = 1; i < _maxEvents; i++){
-        // Must set the number of events:
-        _numberEvents = _random.uniformInteger(i-1, i);
-
-        for (int k = 0; k < _intervalGens; k++){
+    std::vector<Simulation*> simulations;
+    std::vector<std::thread> workers;
 
-            updateState(i-1, i);
+    for (int i = 0; i < threads; i++) {
+        int threadGenerations = generations / threads +
+            (i < generations % threads ? 1 : 0);
 
-        }
+        simulations.push_back(new Simulation(_random.uniformInteger
+            (1, std::numeric_limits<int>::max()), 1 / _poissonRatePrior,
+                _maxEvents));
+        workers.push_back(std::thread(&FastSimulatePrior::runOldWay, this,
+            simulations[i], round(burnIn * threadGenerations),
+                threadGenerations));
     }
 
-    //std::cout << "Writing transition probs..." << std::endl;
-    //writeTransitionProbsToFile();
-
-    writePriorProbsToFile_Experimental();
-    std::cout << "Done generating prior distribution\n" << std::endl;
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
 
+    writePriorProbsToFile_OldWay(sumTrackingVectors(simulations));
 
+    for (Simulation* simulation : simulations) {
+        delete simulation;
+    }
 }
 
 
-void FastSimulatePrior::fastSimulatePriorOldWay()
+void FastSimulatePrior::runOldWay
+    (Simulation* simulation, int burnIn, int generations) const
 {
+    // Burnin phase:
+    for (int i = 0; i < burnIn; i++) {
+        updateState(*simulation);
+    }
 
-    //_outfileName = sttings->get("priorOutputFileName");
-    // Open streams for writing
-    //_fspOutStream.open(_outfileName.c_str());
-
-    //writeHeaderToOutputFile();
+    // sampling phase:
+    for (int i = burnIn; i < generations; i++) {
+        simulation->trackingVector[simulation->numberEvents].
+            incrementInStateCount();
+        updateState(*simulation);
+    }
+}
 
 
+// Each pair of adjacent event counts (an interval) is simulated
+// separately, so intervals are shared among the threads
+void FastSimulatePrior::fastSimulatePriorExperimental()
+{
+    int threads = numberOfThreads();
 
+    log() << "\nSimulating prior distribution with poissonRatePrior = "
+          << _poissonRatePrior << " with " << threads << " threads...\n";
 
-    std::cout << "\nSimulating prior distribution on shifts....\n" << std::endl;
-    std::cout << "Progress: 0% ";
-    std::cout.flush();
+    // Seeds are drawn in interval order, so that results do not depend
+    // on the number of threads
+    _intervalSeeds.assign(_maxEvents, 0);
+    for (int i = 1; i < _maxEvents; i++) {
+        _intervalSeeds[i] = _random.uniformInteger
+            (1, std::numeric_limits<int>::max());
+    }
 
+    std::vector<Simulation*> simulations;
+    std::vector<std::thread> workers;
 
+    for (int i = 0; i < threads; i++) {
+        simulations.push_back
+            (new Simulation(1, 1 / _poissonRatePrior, _maxEvents));
+        workers.push_back(std::thread(&FastSimulatePrior::runIntervals, this,
+            simulations[i]));
+    }
 
-    int fints =
-        round(sttings->get<double>("fastSimulatePrior_Generations") / 32.0);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
 
-    double burnin = sttings->get<double>("fastSimulatePrior_BurnIn");
-    int samplestart =
-        round(burnin * sttings->get<double>("fastSimulatePrior_Generations"));
+    writePriorProbsToFile_Experimental(sumTrackingVectors(simulations));
 
-    // Burnin phase:
-    for (int i = 0; i < samplestart; i++){
-        updateState();
+    for (Simulation* simulation : simulations) {
+        delete simulation;
     }
+}
 
-    // sampling phase:
-    for (int i = samplestart; i < sttings->get<int>("fastSimulatePrior_Generations"); i++){
 
-        _TrackingVector[_numberEvents]->incrementInStateCount();
+void FastSimulatePrior::runIntervals(Simulation* simulation)
+{
+    int i;
+    while ((i = nextInterval()) < _maxEvents) {
+        simulation->random = Random(_intervalSeeds[i]);
+        simulation->eventRate = 1 / _poissonRatePrior;
 
-        updateState();
+        // Must set the number of events:
+        simulation->numberEvents = simulation->random.uniformInteger(i - 1, i);
 
-        // No longer writing state to file
-        //if ((i % sttings->get<int>("fastSimulatePrior_SampleFreq")) == 0){
-        //  writeStateTofile();
-        // }
+        for (int k = 0; k < _intervalGens; k++) {
+            updateState(*simulation, i - 1, i);
+        }
+    }
+}
 
-        if ((i % fints) == 0){
 
-            if (i == (fints*16)){
-                std::cout << " 50% ";
-            }
+int FastSimulatePrior::nextInterval()
+{
+    return _nextInterval++;
+}
 
-            std::cout << "|";
-            std::cout.flush();
-        }
 
+std::vector<EventCountLog> FastSimulatePrior::sumTrackingVectors
+    (const std::vector<Simulation*>& simulations) const
+{
+    std::vector<EventCountLog> trackingVector;
+    for (int i = 0; i <= _maxEvents; i++) {
+        trackingVector.push_back(EventCountLog(i));
     }
 
-    writePriorProbsToFile_OldWay();
-
-    std::cout << " 100% \n\nDone...Results written to file << ";
-    std::cout << sttings->get("priorOutputFileName");
-    std::cout << " >>\n" << std::endl;
-
+    for (const Simulation* simulation : simulations) {
+        for (int i = 0; i <= _maxEvents; i++) {
+            trackingVector[i].add(simulation->trackingVector[i]);
+        }
+    }
 
+    return trackingVector;
 }
 
 
-void FastSimulatePrior::writeStateTofile()
+int FastSimulatePrior::numberOfThreads() const
 {
-    writeStateToStream(_fspOutStream);
-}
+    int threads = sttings->get<int>("priorSimulationThreads");
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+    }
 
-void FastSimulatePrior::writeStateToStream(std::ostream &outStream)
-{
-    outStream   << _generations      << ","
-                << _numberEvents    << ","
-                << _eventRate       << std::endl;
+    return std::max(threads, 1);
 }
 
-void FastSimulatePrior::updateEventRateMH()
+
+void FastSimulatePrior::updateEventRateMH(Simulation& simulation) const
 {
+    double oldEventRate = simulation.eventRate;
 
-    double oldEventRate = getEventRate();
+    double cterm = exp(_updateEventRateScale *
+        (simulation.random.uniform() - 0.5));
+    simulation.eventRate = cterm * oldEventRate;
 
-    double cterm = exp( _updateEventRateScale * (_random.uniform() - 0.5) );
-    setEventRate(cterm * oldEventRate);
-    
-    //#ifdef USE_ANALYTICAL_POSTERIOR_EVENTRATE
-    
     double LogPriorRatio = 0.0;
- 
+
     double logProposalRatio = log(cterm);
-    
+
     // change to proposal ratio to reflect probability
     // of drawing new Poisson rate conditional on current value and number of events
-    
-    logProposalRatio += ((double)_numberEvents) * (std::log( getEventRate())  - std::log(oldEventRate));
-    logProposalRatio +=  (_poissonRatePrior + 1) * (oldEventRate - getEventRate() );
-
-//#else
-//    
-//    double LogPriorRatio =
-//        Stat::lnExponentialPDF(getEventRate(), _poissonRatePrior) -
-//        Stat::lnExponentialPDF(oldEventRate, _poissonRatePrior);
-//    
-//    double logProposalRatio = log(cterm);
-//    
-//#endif
 
+    logProposalRatio += ((double)simulation.numberEvents) *
+        (std::log(simulation.eventRate) - std::log(oldEventRate));
+    logProposalRatio += (_poissonRatePrior + 1) *
+        (oldEventRate - simulation.eventRate);
 
     double logHR = LogPriorRatio + logProposalRatio;
-    const bool acceptMove = acceptMetropolisHastings(logHR);
-
+    const bool acceptMove = acceptMetropolisHastings(simulation, logHR);
 
-    if (acceptMove == false){
-        setEventRate(oldEventRate);
+    if (acceptMove == false) {
+        simulation.eventRate = oldEventRate;
     }
-
 }
 
-void FastSimulatePrior::changeNumberOfEventsMH(int min, int max)
+
+void FastSimulatePrior::changeNumberOfEventsMH
+    (Simulation& simulation, int min, int max) const
 {
     bool acceptMove = false;
 
+    std::vector<EventCountLog>& tracking = simulation.trackingVector;
+    int& numberEvents = simulation.numberEvents;
+
     // Current number of events on the tree, not counting root state:
-    double K = (double)(_numberEvents);
+    double K = (double)(numberEvents);
 
-    bool gain = _random.trueWithProbability(0.5);
+    bool gain = simulation.random.trueWithProbability(0.5);
     if (K == min) {
         // set event to gain IF on boundary
         gain = true;
-    }else if (K == max) {
+    } else if (K == max) {
         gain = false;
     }
 
@@ -242,323 +283,224 @@ void FastSimulatePrior::changeNumberOfEventsMH(int min, int max)
             // event count at minimum but upper bound is greater.
             // can only propose gains.
             qratio = 0.5;
-        } else if (K == (max - 1) && K != min){
+        } else if (K == (max - 1) && K != min) {
             qratio = 2.0;
         }
 
         // Prior ratio is eventRate / (k + 1)
-        // but now, eventCollection.size() == k + 1
-        //  because event has already been added.
-        // Here HR is just the prior ratio
-
-        double logHR = log(_eventRate) - log(K + 1.0);
+        double logHR = log(simulation.eventRate) - log(K + 1.0);
 
         // Now add log qratio
-
         logHR += log(qratio);
-        acceptMove = acceptMetropolisHastings(logHR);
+        acceptMove = acceptMetropolisHastings(simulation, logHR);
 
-        _TrackingVector[_numberEvents]->incrementAddProposeCount();
-        if (_numberEvents == _maxEvents - 1){
-            std::cout << " Max number of events exceeded" << std::endl;
-            exit(1);
+        tracking[numberEvents].incrementAddProposeCount();
+        if (numberEvents == _maxEvents - 1) {
+            log(Error) << "Max number of events exceeded.\n";
+            std::exit(1);
         }
 
         if (acceptMove) {
-            _TrackingVector[_numberEvents]->incrementAddAcceptCount();
+            tracking[numberEvents].incrementAddAcceptCount();
 
-            _numberEvents++;
+            numberEvents++;
 
             // If ACCEPT GAIN or if REJECT LOSS
             //      you are still in state i, otherwise not.
-
-            _TrackingVector[_numberEvents]->incrementInStateCount();
+            tracking[numberEvents].incrementInStateCount();
         }
 
-
-
     } else {
 
         double qratio = 1.0; // if loss, can only be qratio of 1.0
-        if (K  == (min + 1) && K != max ){
+        if (K == (min + 1) && K != max) {
             qratio = 2.0;
-        }else if (K == max && (K - 1) != min) {
+        } else if (K == max && (K - 1) != min) {
             qratio = 0.5;
         }
 
-
         // This is probability of going from k to k-1
         // So, prior ratio is (k / eventRate)
-
-        // First get prior ratio:
-        double logHR = log(K) - log(_eventRate);
+        double logHR = log(K) - log(simulation.eventRate);
 
         // Now correct for proposal ratio:
         logHR += log(qratio);
 
-        acceptMove = acceptMetropolisHastings(logHR);
+        acceptMove = acceptMetropolisHastings(simulation, logHR);
 
-        _TrackingVector[_numberEvents]->incrementSubtractProposeCount();
+        tracking[numberEvents].incrementSubtractProposeCount();
         if (acceptMove) {
-
-            _TrackingVector[_numberEvents]->incrementSubtractAcceptCount();
-            _numberEvents--;
-
-        }else{
+            tracking[numberEvents].incrementSubtractAcceptCount();
+            numberEvents--;
+        } else {
             // If GAIN or if REJECT LOSS
             //      you are still in state i, otherwise not.
-            _TrackingVector[_numberEvents]->incrementInStateCount();
+            tracking[numberEvents].incrementInStateCount();
         }
-
     }
-
-
-
 }
 
 
-
-void FastSimulatePrior::changeNumberOfEventsMH()
+void FastSimulatePrior::changeNumberOfEventsMH(Simulation& simulation) const
 {
-
     bool acceptMove = false;
 
     // Propose gains & losses equally if not on boundary (n = 0) events:
 
     // Current number of events on the tree, not counting root state:
-    double K = (double)(_numberEvents);
+    double K = (double)(simulation.numberEvents);
 
-    bool gain = _random.trueWithProbability(0.5);
+    bool gain = simulation.random.trueWithProbability(0.5);
     if (K == 0) {
         // set event to gain IF on boundary
         gain = true;
     }
 
-    // now to adjust acceptance ratios:
-
     if (gain) {
 
-        double qratio = 1.0;
-        if (K == 0) {
-            // no events on tree
-            // can only propose gains.
-            qratio = 0.5;
-        } else {
-            // DO nothing.
-        }
+        // no events on tree: can only propose gains.
+        double qratio = (K == 0) ? 0.5 : 1.0;
 
         // Prior ratio is eventRate / (k + 1)
-        // but now, eventCollection.size() == k + 1
-        //  because event has already been added.
-        // Here HR is just the prior ratio
-
-        double logHR = log(_eventRate) - log(K + 1.0);
+        double logHR = log(simulation.eventRate) - log(K + 1.0);
 
         // Now add log qratio
-
         logHR += log(qratio);
-        acceptMove = acceptMetropolisHastings(logHR);
+        acceptMove = acceptMetropolisHastings(simulation, logHR);
 
-        if (_numberEvents == _maxEvents - 1){
-            std::cout << " Max number of events exceeded" << std::endl;
-            exit(1);
+        if (simulation.numberEvents == _maxEvents - 1) {
+            log(Error) << "Max number of events exceeded.\n";
+            std::exit(1);
         }
 
         if (acceptMove) {
-
-            _numberEvents++;
-
+            simulation.numberEvents++;
         }
 
     } else {
 
         double qratio = 1.0; // if loss, can only be qratio of 1.0
-        if (K  == 1)
+        if (K == 1) {
             qratio = 2.0;
+        }
 
         // This is probability of going from k to k-1
         // So, prior ratio is (k / eventRate)
-
-        // First get prior ratio:
-        double logHR = log(K) - log(_eventRate);
+        double logHR = log(K) - log(simulation.eventRate);
 
         // Now correct for proposal ratio:
         logHR += log(qratio);
 
-        acceptMove = acceptMetropolisHastings(logHR);
+        acceptMove = acceptMetropolisHastings(simulation, logHR);
 
         if (acceptMove) {
-
-            _numberEvents--;
-
+            simulation.numberEvents--;
         }
-
     }
-
 }
 
 
-void FastSimulatePrior::updateState(int min, int max)
+void FastSimulatePrior::updateState
+    (Simulation& simulation, int min, int max) const
 {
-    updateEventRateMH();
-    changeNumberOfEventsMH(min, max);
-    incrementGeneration();
+    updateEventRateMH(simulation);
+    changeNumberOfEventsMH(simulation, min, max);
 }
 
-void FastSimulatePrior::updateState()
-{
-
-    updateEventRateMH();
 
-    changeNumberOfEventsMH();
-
-    incrementGeneration();
+void FastSimulatePrior::updateState(Simulation& simulation) const
+{
+    updateEventRateMH(simulation);
+    changeNumberOfEventsMH(simulation);
 }
 
 
-bool FastSimulatePrior::acceptMetropolisHastings(const double lnR)
+bool FastSimulatePrior::acceptMetropolisHastings
+    (Simulation& simulation, const double lnR) const
 {
     const double r = exp(lnR);
-    return _random.trueWithProbability(r);
+    return simulation.random.trueWithProbability(r);
 }
 
 
-void FastSimulatePrior::writeHeaderToOutputFile()
+void FastSimulatePrior::writePriorProbsToFile
+    (const std::vector<double>& probs) const
 {
-    _fspOutStream << "generation,N_shifts,eventRate" << std::endl;
-}
-
-// writeTransitionProbsToFile writes raw data associated with
-// transitioning between models to allow calculation of prior.
-void FastSimulatePrior::writeTransitionProbsToFile()
-{
-    std::string outname = "prior_transitions.txt";
-    std::ofstream _priorfile;
-    _priorfile.open(outname.c_str());
-
-    _priorfile << "count,prop_loss,accept_loss,prop_gain,accept_gain" << std::endl;
-
-    for (int i = 0; i < (int)_TrackingVector.size(); i++){
-        _priorfile << _TrackingVector[i]->getEventCount() << ",";
-        _priorfile << _TrackingVector[i]->getSubtractProposeCount() << ",";
-        _priorfile << _TrackingVector[i]->getSubtractAcceptCount() << ",";
-        _priorfile << _TrackingVector[i]->getAddProposeCount() << ",";
-        _priorfile << _TrackingVector[i]->getAddAcceptCount() << std::endl;
+    std::ofstream priorFile(_outfileName.c_str());
+    priorFile << "N_shifts,prob" << std::endl;
 
+    for (int i = 0; i < (int)probs.size(); i++) {
+        priorFile << i << "," << probs[i] << std::endl;
     }
 
-    _priorfile.close();
+    priorFile.close();
 
+    log() << "Prior probabilities written to file <<"
+          << _outfileName << ">>.\n";
 }
 
 
-void FastSimulatePrior::writePriorProbsToFile_OldWay()
+void FastSimulatePrior::writePriorProbsToFile_OldWay
+    (const std::vector<EventCountLog>& trackingVector) const
 {
-
     double totalcount = 0;
-    for (int i = 0; i <= sttings->get<int>("maxNumberEvents"); i++){
-        totalcount += _TrackingVector[i]->getInStateCount();
+    for (int i = 0; i <= _maxEvents; i++) {
+        totalcount += trackingVector[i].getInStateCount();
     }
 
-
-
-    std::string outname = sttings->get("priorOutputFileName");
-    //std::string outname = "prior_probs.csv";
-    std::ofstream _priorfile;
-    _priorfile.open(outname.c_str());
-    _priorfile << "N_shifts,prob" << std::endl;
-
-
-
-    for (int i = 0; i <= sttings->get<int>("maxNumberEvents"); i++){
-        double prob = ((double)_TrackingVector[i]->getInStateCount()) / totalcount;
-        _priorfile << i << "," << prob << std::endl;
-
+    std::vector<double> probs;
+    for (int i = 0; i <= _maxEvents; i++) {
+        probs.push_back(trackingVector[i].getInStateCount() / totalcount);
     }
 
-    _priorfile.close();
-
-
+    writePriorProbsToFile(probs);
 }
 
 
-void FastSimulatePrior::writePriorProbsToFile_Experimental()
+void FastSimulatePrior::writePriorProbsToFile_Experimental
+    (const std::vector<EventCountLog>& trackingVector) const
 {
-
     // Must deal better with these for lower bounds.
     int threshold_prop = 1;
     int threshold_acc = 1;
     int maxx = 0;
 
-    for (int i = 1; i < (int)_TrackingVector.size(); i++){
+    for (int i = 1; i < (int)trackingVector.size(); i++) {
         // Here need to check if counts are sufficient large to get non-zeros.
-        bool c1 = _TrackingVector[i]->getAddProposeCount() < threshold_prop;
-        bool c2 = _TrackingVector[i]->getSubtractProposeCount() < threshold_prop;
-        bool c3 = _TrackingVector[i]->getAddAcceptCount() < threshold_acc;
-        bool c4 = _TrackingVector[i]->getSubtractAcceptCount() < threshold_acc;
-        if (c1 | c2 | c3 | c4){
+        bool c1 = trackingVector[i].getAddProposeCount() < threshold_prop;
+        bool c2 = trackingVector[i].getSubtractProposeCount() < threshold_prop;
+        bool c3 = trackingVector[i].getAddAcceptCount() < threshold_acc;
+        bool c4 = trackingVector[i].getSubtractAcceptCount() < threshold_acc;
+        if (c1 || c2 || c3 || c4) {
             maxx = i;
             break;
         }
     }
 
+    std::vector<double> cumsumlog(trackingVector.size(), 0.0);
 
-    std::vector<double> relprob;
-    std::vector<double> cumsumlog;
-    for (int i = 0; i < (int)_TrackingVector.size(); i++){
-        relprob.push_back(0.0);
-        cumsumlog.push_back(0.0);
-    }
-
-    for (int i = 1; i < maxx; i++){
-
-        double num = (double)_TrackingVector[i-1]->getAddAcceptCount() / (double)_TrackingVector[i-1]->getAddProposeCount();
-        double denom = (double)_TrackingVector[i]->getSubtractAcceptCount() / (double) _TrackingVector[i]->getSubtractProposeCount();
-
-
-        relprob[i] = num / denom;
-
-        //double prop_i = (double)_TrackingVector[i]->getInStateCount() / (double)sttings->get<double>("priorSim_IntervalGenerations");
-
-        //double relprob2 = prop_i / (1 - prop_i);
-
-        //relprob[i] = (double)_TrackingVector[i]->getInStateCount() / (double)sttings->get<double>("priorSim_IntervalGenerations");
-
-        //std::cout << "RP1: " << relprob[i] << "\tRP2: " << relprob2 << std::endl;
-
-        cumsumlog[i] = std::log(relprob[i]) + cumsumlog[i-1];
+    for (int i = 1; i < maxx; i++) {
+        double num = (double)trackingVector[i - 1].getAddAcceptCount() /
+            (double)trackingVector[i - 1].getAddProposeCount();
+        double denom = (double)trackingVector[i].getSubtractAcceptCount() /
+            (double)trackingVector[i].getSubtractProposeCount();
 
+        cumsumlog[i] = std::log(num / denom) + cumsumlog[i - 1];
     }
 
-    double tmpsum = 0.0;
-    for (int i = 1; i < maxx; i++){
+    // Includes the relative probability of no events, exp(cumsumlog[0])
+    double tmpsum = 1.0;
+    for (int i = 1; i < maxx; i++) {
         tmpsum += std::exp(cumsumlog[i]);
     }
 
     double P0 = 1 / tmpsum;
 
-    std::string outname = sttings->get("priorOutputFileName");
-    //std::string outname = "prior_probs.csv";
-    std::ofstream _priorfile;
-    _priorfile.open(outname.c_str());
-    _priorfile << "N_shifts,prob" << std::endl;
-    _priorfile << "0," << P0 << std::endl;
-
-    for (int i = 1; i < maxx; i++){
-        double prob = P0 * std::exp(cumsumlog[i]);
-        _priorfile << i << "," << prob << std::endl;
+    std::vector<double> probs;
+    probs.push_back(P0);
+    for (int i = 1; i < maxx; i++) {
+        probs.push_back(P0 * std::exp(cumsumlog[i]));
     }
 
-
-
-    _priorfile.close();
-
+    writePriorProbsToFile(probs);
 }
-
-
-#undef USE_ANALYTICAL_POSTERIOR_EVENTRATE
-
-
-
-
-
@@ -9,115 +9,103 @@
 #ifndef __bamm__FastSimulatePrior__
 #define __bamm__FastSimulatePrior__
 
+#include "Random.h"
+#include "EventCountLog.h"
+
 #include <string>
-#include <fstream>
-#include <iosfwd>
+#include <atomic>
 #include <vector>
 #include <cmath>
 
 //Forward declarations
-class Node;
-class Random;
 class Settings;
-class EventCountLog;
+
+
+// Writes the prior probability of each number of shifts
+// (0 to maxNumberEvents) to priorOutputFileName.
+//
+// With a Poisson number of shifts whose rate has an exponential prior
+// with rate p (poissonRatePrior), the number of shifts is geometric:
+//     P(k) = p / (1 + p)^(k + 1)
+// which is written by default (exactPriorShifts = 1). Otherwise the
+// probabilities are estimated by simulating the event number and event
+// rate updates by MCMC, in priorSimulationThreads threads, each with
+// its own pseudorandom stream seeded from the main one.
 
 class FastSimulatePrior
 {
 public:
-    
+
     FastSimulatePrior(Random& random, Settings* sp);
-    ~FastSimulatePrior();
-    
-    void updateState();
-    void updateState(int min, int max);
-    void changeNumberOfEventsMH();
-    void changeNumberOfEventsMH(int min, int max);
-    
-    void updateEventRateMH();
-    int getNumberOfEvents();
-    double getEventRate();
-    bool acceptMetropolisHastings(const double lnR);
-    
+
+private:
+
+    // State of one simulation (one per thread)
+    struct Simulation
+    {
+        Simulation(unsigned long int seed, double eventRate, int maxEvents);
+
+        Random random;
+
+        double eventRate;
+        int numberEvents;
+
+        // Track event proposals: additions and subtractions.
+        std::vector<EventCountLog> trackingVector;
+    };
+
+    void computeExactPrior();
 
     void fastSimulatePriorOldWay();
     void fastSimulatePriorExperimental();
-    
-// Output settings:
-//    void writeStateToFile();
-    void writeHeaderToOutputFile();
-    
-private:
 
-    int round(double x);
+    void runOldWay(Simulation* simulation, int burnIn, int generations) const;
+    void runIntervals(Simulation* simulation);
+    int nextInterval();
+
+    void updateState(Simulation& simulation) const;
+    void updateState(Simulation& simulation, int min, int max) const;
+    void changeNumberOfEventsMH(Simulation& simulation) const;
+    void changeNumberOfEventsMH(Simulation& simulation, int min, int max) const;
+    void updateEventRateMH(Simulation& simulation) const;
+    bool acceptMetropolisHastings(Simulation& simulation,
+        const double lnR) const;
+
+    std::vector<EventCountLog> sumTrackingVectors
+        (const std::vector<Simulation*>& simulations) const;
+
+    void writePriorProbsToFile(const std::vector<double>& probs) const;
+    void writePriorProbsToFile_OldWay
+        (const std::vector<EventCountLog>& trackingVector) const;
+    void writePriorProbsToFile_Experimental
+        (const std::vector<EventCountLog>& trackingVector) const;
+
+    int numberOfThreads() const;
+
+    int round(double x) const;
 
     Random& _random;
     Settings* sttings;
-    
-    double _eventRate;
-    int _numberEvents;
-    int _generations;
+
     double _updateEventRateScale;
     double _poissonRatePrior;
-    
-    std::string _outfileName;
-    
-    void incrementGeneration();
-    void setEventRate(double x);
-
-    std::ofstream _fspOutStream;
-    std::ofstream _eventDataOutStream;
-    
-    void writeStateTofile();
-    void writeStateToStream(std::ostream& outStream);
-    void exitWithErrorOutputFileExists();
-
-    
-    
-    /**** New params May 23 2014 ****/
-    
-    // Track event proposals: additions and subtractions.
-    std::vector<EventCountLog*> _TrackingVector;
-    
-    void writeTransitionProbsToFile();
-    void writePriorProbsToFile_Experimental();
-    void writePriorProbsToFile_OldWay();
 
     int _maxEvents;
     int _intervalGens;
-    
-    // End new params
-    
-    
-};
-
-
-inline int FastSimulatePrior::round(double x)
-{
-    return std::ceil(x - 0.5);
-}
-
 
-inline void FastSimulatePrior::setEventRate(double x)
-{
-    _eventRate = x;
-}
-
-inline void FastSimulatePrior::incrementGeneration()
-{
-    _generations++;
-}
+    std::string _outfileName;
 
-inline int FastSimulatePrior::getNumberOfEvents()
-{
-    return _numberEvents;
-}
+    // Intervals of the experimental simulation are handed out to threads
+    // in order, and each is seeded with its own seed from _intervalSeeds
+    std::vector<unsigned long int> _intervalSeeds;
+    std::atomic<int> _nextInterval;
+};
 
 
-inline double FastSimulatePrior::getEventRate()
+inline int FastSimulatePrior::round(double x) const
 {
-    return _eventRate;
+    return std::ceil(x - 0.5);
 }
 
 
-
 #endif /* defined(__bamm__FastSimulatePrior__) */
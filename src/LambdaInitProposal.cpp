@@ -11,8 +11,8 @@ LambdaInitProposal::LambdaInitProposal
     (Random& random, Settings& settings, Model& model, Prior& prior) :
         EventParameterProposal(random, settings, model, prior)
 {
-    _weight = _settings.get<double>("updateRateLambda0");
-    _updateLambdaInitScale = _settings.get<double>("updateLambdaInitScale");
+    _weight = _settings.spExSettings().updateRateLambda0;
+    _updateLambdaInitScale = _settings.spExSettings().updateLambdaInitScale;
 }
 
 
@@ -66,3 +66,21 @@ double LambdaInitProposal::computeLogQRatio()
 {
     return std::log(_cterm);
 }
+
+
+std::string LambdaInitProposal::scaleName() const
+{
+    return "updateLambdaInitScale";
+}
+
+
+double LambdaInitProposal::scale() const
+{
+    return _updateLambdaInitScale;
+}
+
+
+void LambdaInitProposal::setScale(double scale)
+{
+    _updateLambdaInitScale = scale;
+}
@@ -17,6 +17,10 @@ public:
     LambdaInitProposal(Random& random, Settings& settings, Model& model,
         Prior& prior);
 
+    virtual std::string scaleName() const;
+    virtual double scale() const;
+    virtual void setScale(double scale);
+
 private:
 
     virtual double getCurrentParameterValue();
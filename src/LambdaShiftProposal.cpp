@@ -11,18 +11,16 @@ LambdaShiftProposal::LambdaShiftProposal
     (Random& random, Settings& settings, Model& model, Prior& prior) :
         EventParameterProposal(random, settings, model, prior)
 {
-    _weight = _settings.get<double>("updateRateLambdaShift");
-    _updateLambdaShiftScale = _settings.get<double>("updateLambdaShiftScale");
+    _weight = _settings.spExSettings().updateRateLambdaShift;
+    _updateLambdaShiftScale = _settings.spExSettings().updateLambdaShiftScale;
 }
 
 
-double LambdaShiftProposal::acceptanceRatio()
+// Time-constant events have no shift to propose
+bool LambdaShiftProposal::canBeAccepted()
 {
-    if (static_cast<SpExBranchEvent*>(_event)->isTimeVariable()) {
-        return EventParameterProposal::acceptanceRatio();
-    } else {
-        return 0.0;
-    }
+    return static_cast<SpExBranchEvent*>(_event)->isTimeVariable() &&
+        EventParameterProposal::canBeAccepted();
 }
 
 
@@ -70,3 +68,21 @@ double LambdaShiftProposal::computeNonRootLogPriorRatio()
     return _prior.lambdaShiftPrior(_proposedParameterValue) -
            _prior.lambdaShiftPrior(_currentParameterValue);
 }
+
+
+std::string LambdaShiftProposal::scaleName() const
+{
+    return "updateLambdaShiftScale";
+}
+
+
+double LambdaShiftProposal::scale() const
+{
+    return _updateLambdaShiftScale;
+}
+
+
+void LambdaShiftProposal::setScale(double scale)
+{
+    _updateLambdaShiftScale = scale;
+}
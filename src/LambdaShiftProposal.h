@@ -17,10 +17,14 @@ public:
     LambdaShiftProposal(Random& random, Settings& settings, Model& model,
         Prior& prior);
 
-    virtual double acceptanceRatio();
+    virtual std::string scaleName() const;
+    virtual double scale() const;
+    virtual void setScale(double scale);
 
 private:
 
+    virtual bool canBeAccepted();
+
     virtual double getCurrentParameterValue();
     virtual double computeNewParameterValue();
 
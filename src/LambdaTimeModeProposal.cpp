@@ -12,7 +12,7 @@ LambdaTimeModeProposal::LambdaTimeModeProposal
     (Random& random, Settings& settings, Model& model)
     : TimeModeProposal(random, settings, model)
 {
-    _weight = settings.get<double>("updateRateLambdaTimeMode");
+    _weight = settings.spExSettings().updateRateLambdaTimeMode;
 }
 
 
@@ -5,6 +5,7 @@
 
 
 Log Log::_logger;
+thread_local std::ostream* Log::_threadMessageStream = NULL;
 
 
 Log& Log::instance()
@@ -27,6 +28,18 @@ std::ostream& Log::outputStream(LogType logType, std::ostream& out)
 }
 
 
+void Log::setThreadMessageStream(std::ostream* out)
+{
+    _threadMessageStream = out;
+}
+
+
+std::ostream* Log::threadMessageStream()
+{
+    return _threadMessageStream;
+}
+
+
 void Log::startWarning(std::ostream& out)
 {
     out << TEXT_COLOR_WARNING << "\nWARNING: " << TEXT_COLOR_DEFAULT;
@@ -45,6 +58,9 @@ std::ostream& log(LogType logType)
 
     if (logType == Message) {
         out = &std::cout;
+        if (Log::threadMessageStream() != NULL) {
+            out = Log::threadMessageStream();
+        }
     } else if (logType == Warning) {
         out = &std::cerr;
     } else if (logType == Error) {
@@ -28,6 +28,11 @@ public:
 
     std::ostream& outputStream(LogType logType, std::ostream& out);
 
+    // Sends the messages (not warnings or errors) logged to the screen
+    // by the calling thread to out instead; NULL restores the screen
+    static void setThreadMessageStream(std::ostream* out);
+    static std::ostream* threadMessageStream();
+
 private:
 
     Log() {};
@@ -37,6 +42,7 @@ private:
     void startError(std::ostream& out);
 
     static Log _logger;
+    static thread_local std::ostream* _threadMessageStream;
 
 };
 
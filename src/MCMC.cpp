@@ -1,24 +1,75 @@
 #include "MCMC.h"
 #include "Random.h"
+#include "RandomStreams.h"
 #include "Model.h"
 #include "ModelFactory.h"
+#include "Settings.h"
+#include "WorkerPool.h"
 
-#include <climits>
+#include <thread>
+#include <algorithm>
 
 
-// Choose a random number up to INT_MAX - 1, not INT_MAX,
-// because MbRandom adds 1 internally, causing an overflow
-MCMC::MCMC(Random& seeder, Settings& settings, ModelFactory& modelFactory) :
-    _random(seeder.uniformInteger(0, INT_MAX - 1))
+MCMC::MCMC(const RandomStreams& streams, int chainIndex, Settings& settings,
+    ModelFactory& modelFactory) :
+        _random(streams.seed(chainIndex, RandomStreams::ChainStream)),
+        _workerPool(NULL)
 {
-    _model = modelFactory.createModel(_random, settings);
- 
+    _model = modelFactory.createModel(_random, streams, settings);
+
+    int numberOfCandidates = settings.modelSettings().multipleTryCandidates;
+    if (numberOfCandidates > 1) {
+        for (int i = 0; i < numberOfCandidates; i++) {
+            Random* workerRandom = new Random(streams.seed
+                (chainIndex, RandomStreams::WorkerStream, i));
+            _workerRandoms.push_back(workerRandom);
+            _workers.push_back
+                (modelFactory.createModel(*workerRandom, streams, settings));
+        }
+
+        int threads = candidateThreads(settings);
+        if (threads > 1) {
+            _workerPool = new WorkerPool(threads);
+        }
+
+        _model->setMultipleTryWorkers(_workers, _workerPool);
+    }
 }
 
 
 MCMC::~MCMC()
 {
+    delete _workerPool;
     delete _model;
+
+    for (int i = 0; i < (int)_workers.size(); i++) {
+        delete _workers[i];
+        delete _workerRandoms[i];
+    }
+}
+
+
+// The cores left to each chain by the chain threads of MC3
+// (of every tree run concurrently), at most one per candidate
+int MCMC::candidateThreads(Settings& settings)
+{
+    const MCMCSettings& mcmcSettings = settings.mcmcSettings();
+
+    int chainLanes = std::max(mcmcSettings.numberOfChainLanes, 1);
+    int chainThreads =
+        (mcmcSettings.numberOfChains + chainLanes - 1) / chainLanes;
+    if (mcmcSettings.numberOfChainThreads > 0) {
+        chainThreads =
+            std::min(chainThreads, mcmcSettings.numberOfChainThreads);
+    }
+
+    int concurrentThreads = std::max(chainThreads, 1) *
+        std::max(settings.get<int>("numberOfConcurrentTrees"), 1);
+
+    int cores = std::max((int)std::thread::hardware_concurrency(), 1);
+
+    return std::min(settings.modelSettings().multipleTryCandidates,
+        std::max(cores / concurrentThreads, 1));
 }
 
 
@@ -32,12 +83,19 @@ void MCMC::run(int generations)
 
 void MCMC::step()
 {
-    //std::cout << _model->getCurrentLogLikelihood() << "\tActual: " << _model->computeLogLikelihood() << std::endl;
-    
-    //double logL = _model->computeLogLikelihood();
-  
-     _model->proposeNewState();
+    propose();
+    acceptOrReject();
+}
+
 
+void MCMC::propose()
+{
+    _model->proposeNewState();
+}
+
+
+void MCMC::acceptOrReject()
+{
     double acceptanceRatio = _model->acceptanceRatio();
     if (_random.trueWithProbability(acceptanceRatio)) {
         _model->acceptProposal();
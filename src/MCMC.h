@@ -4,29 +4,50 @@
 
 #include "Random.h"
 
+#include <vector>
+
+class RandomStreams;
 class Settings;
 class Model;
 class ModelFactory;
+class WorkerPool;
 
 
 class MCMC
 {
 public:
 
-    MCMC(Random& seeder, Settings& settings, ModelFactory& modelFactory);
+    MCMC(const RandomStreams& streams, int chainIndex, Settings& settings,
+        ModelFactory& modelFactory);
     ~MCMC();
 
     void run(int generations);
     void step();
 
+    // step() in two parts, between which the likelihoods of the proposed
+    // states of several chains can be computed together
+    void propose();
+    void acceptOrReject();
+
     Model& model();
 
 protected:
 
-    // MCMC has its own random generator, using the seeder
-    // (another random generator) to seed it
+    static int candidateThreads(Settings& settings);
+
+    // MCMC has its own random generator, seeded from the stream
+    // of its chain index
     Random _random;
     Model* _model;
+
+    // Copies of the model for evaluating multiple-try candidates,
+    // each with its own random generator
+    std::vector<Random*> _workerRandoms;
+    std::vector<Model*> _workers;
+
+    // Threads that evaluate the candidates; NULL if they are evaluated
+    // one after the other
+    WorkerPool* _workerPool;
 };
 
 
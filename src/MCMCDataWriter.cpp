@@ -9,6 +9,7 @@
 #include "SpExModel.h"
 
 #include <iostream>
+#include <sstream>
 
 
 MCMCDataWriter::MCMCDataWriter(Settings& settings) :
@@ -23,9 +24,10 @@ MCMCDataWriter::MCMCDataWriter(Settings& settings) :
     }
     
     
+    _headerWritten = false;
+
     if (_outputFreq > 0) {
         initializeStream();
-        writeHeader();
     }
     
 
@@ -38,16 +40,32 @@ void MCMCDataWriter::initializeStream()
 }
 
 
-void MCMCDataWriter::writeHeader()
+void MCMCDataWriter::writeHeader(Model& model)
 {
-    _outputStream << header() << std::endl;
+    _outputStream << header(model) << std::endl;
+    _headerWritten = true;
 }
 
 
-std::string MCMCDataWriter::header()
+// With time-binned preservation rates, there is a column
+// preservationRate_<bin> for each bin, from the oldest (1)
+std::string MCMCDataWriter::header(Model& model)
 {
     if (_hasPreservationRate){
-        return "generation,N_shifts,logPrior,logLik,eventRate,preservationRate,acceptRate";
+        int bins =
+            static_cast<SpExModel*>(&model)->numberOfPreservationBins();
+        if (bins == 1) {
+            return "generation,N_shifts,logPrior,logLik,eventRate,preservationRate,acceptRate";
+        }
+
+        std::ostringstream columns;
+        columns << "generation,N_shifts,logPrior,logLik,eventRate";
+        for (int i = 0; i < bins; i++) {
+            columns << ",preservationRate_" << i + 1;
+        }
+        columns << ",acceptRate";
+
+        return columns.str();
     }else{
         return "generation,N_shifts,logPrior,logLik,eventRate,acceptRate";    
     }
@@ -68,6 +86,10 @@ void MCMCDataWriter::writeData(int generation, Model& model)
         return;
     }
 
+    if (!_headerWritten) {
+        writeHeader(model);
+    }
+
     if (_hasPreservationRate == false){
         _outputStream << generation                        << ","
                   << model.getNumberOfEvents()             << ","
@@ -77,15 +99,17 @@ void MCMCDataWriter::writeData(int generation, Model& model)
                   << model.getMHAcceptanceRate()           << std::endl;
     }else{
        
-        double prate = static_cast<SpExModel*>(&model)->getPreservationRate();
+        SpExModel* spExModel = static_cast<SpExModel*>(&model);
         
         _outputStream << generation                        << ","
         << model.getNumberOfEvents()                       << ","
         << model.computeLogPrior()                         << ","
         << model.getCurrentLogLikelihood()                 << ","
-        << model.getEventRate()                            << ","
-        << prate    << ","
-        << model.getMHAcceptanceRate()                     << std::endl;
+        << model.getEventRate()                            << ",";
+        for (int i = 0; i < spExModel->numberOfPreservationBins(); i++) {
+            _outputStream << spExModel->getPreservationRate(i) << ",";
+        }
+        _outputStream << model.getMHAcceptanceRate()       << std::endl;
     
     }
     
@@ -21,8 +21,8 @@ public:
 private:
 
     void initializeStream();
-    void writeHeader();
-    std::string header();
+    void writeHeader(Model& model);
+    std::string header(Model& model);
 
     std::string _outputFileName;
     int _outputFreq;
@@ -31,6 +31,10 @@ private:
 
     bool _hasPreservationRate;
 
+    // Written with the first data, when the number of
+    // preservation rates (one per time bin) is known
+    bool _headerWritten;
+
 };
 
 
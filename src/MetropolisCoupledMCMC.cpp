@@ -7,6 +7,7 @@
 #include "Model.h"
 #include "ModelDataWriter.h"
 #include "ChainSwapDataWriter.h"
+#include "TimingDataWriter.h"
 
 #include <algorithm>
 #include <thread>
@@ -14,20 +15,26 @@
 
 MetropolisCoupledMCMC::MetropolisCoupledMCMC
     (Random& random, Settings& settings, ModelFactory* modelFactory) :
-        _random(random), _settings(settings), _modelFactory(modelFactory),
-        _chainSwapDataWriter(_settings)
+        _streams(random.getSeed()),
+        _swapRandom(_streams.seed(0, RandomStreams::ChainSwapStream)),
+        _settings(settings), _modelFactory(modelFactory),
+        _chainSwapDataWriter(_settings), _timingDataWriter(_settings)
 {
+    const MCMCSettings& mcmcSettings = _settings.mcmcSettings();
+
     // Total number of generations to run for each chain
-    _nGenerations = _settings.get<int>("numberOfGenerations");
+    _nGenerations = mcmcSettings.numberOfGenerations;
 
     // MC3 settings
-    _nChains = _settings.get<int>("numberOfChains");
-    _deltaT = _settings.get<double>("deltaT");
-    _swapPeriod = _settings.get<int>("swapPeriod");
+    _nChains = mcmcSettings.numberOfChains;
+    _nChainThreads = mcmcSettings.numberOfChainThreads;
+    _nChainLanes = mcmcSettings.numberOfChainLanes;
+    _deltaT = mcmcSettings.deltaT;
+    _swapPeriod = mcmcSettings.swapPeriod;
 
     _coldChainIndex = 0;
 
-    _acceptanceResetFreq = _settings.get<int>("acceptanceResetFreq");
+    _acceptanceResetFreq = mcmcSettings.acceptanceResetFreq;
 }
 
 
@@ -52,12 +59,44 @@ void MetropolisCoupledMCMC::run()
     log() << "\n";
 
     int generation = 0;
-    while (generation < _nGenerations) {
+    bool converged = false;
+    while (generation < _nGenerations && !converged) {
         int generationEnd = std::min(generation + _swapPeriod, _nGenerations);
         runChains(generation, generationEnd);
         generation = generationEnd;
         tryChainSwap(generation);
+
+        converged = _dataWriter->hasConverged();
+        _timingDataWriter.writeData
+            (generation, _chains, generation == _nGenerations || converged);
+    }
+
+    if (converged) {
+        log() << "\nStopping at generation " << generation
+              << ": the convergence targets were met.\n";
+    }
+
+    long long skipped = 0;
+    for (MCMC* chain : _chains) {
+        skipped +=
+            chain->model().proposalTimer().totalSkippedLikelihoodEvaluations();
     }
+    log() << "\nLikelihood evaluations skipped (proposals rejected "
+          << "whatever the likelihood): " << skipped << "\n";
+
+    _dataWriter->writeFinalData(_chains[_coldChainIndex]->model());
+}
+
+
+void MetropolisCoupledMCMC::writeProposalScales(std::ostream& out)
+{
+    _chains[_coldChainIndex]->model().writeProposalScales(out);
+}
+
+
+void MetropolisCoupledMCMC::writeProposalProbabilities(std::ostream& out)
+{
+    _chains[_coldChainIndex]->model().writeProposalProbabilities(out);
 }
 
 
@@ -71,7 +110,7 @@ void MetropolisCoupledMCMC::createChains()
 
 MCMC* MetropolisCoupledMCMC::createMCMC(int chainIndex) const
 {
-    MCMC* mcmc = new MCMC(_random, _settings, *_modelFactory);
+    MCMC* mcmc = new MCMC(_streams, chainIndex, _settings, *_modelFactory);
     mcmc->model().setTemperatureMH(calculateTemperature(chainIndex, _deltaT));
     return mcmc;
 }
@@ -96,14 +135,25 @@ void MetropolisCoupledMCMC::createDataWriter()
 }
 
 
+// Each chain has its own random generator and model, so which thread
+// runs a chain does not change its trajectory. The chains are divided
+// among the threads in groups of _nChainLanes.
 void MetropolisCoupledMCMC::runChains(int genStart, int genEnd)
 {
+    int nGroups = ((int)_chains.size() + _nChainLanes - 1) / _nChainLanes;
+
+    int nThreads = nGroups;
+    if (_nChainThreads > 0) {
+        nThreads = std::min(nThreads, _nChainThreads);
+    }
+
     std::vector<std::thread> chainThreads;
-    chainThreads.reserve(_chains.size());
+    chainThreads.reserve(nThreads);
 
-    for (int i = 0; i < (int)_chains.size(); i++) {
+    for (int t = 0; t < nThreads; t++) {
         chainThreads.push_back(std::thread
-            {&MetropolisCoupledMCMC::runChain, this, i, genStart, genEnd});
+            {&MetropolisCoupledMCMC::runChainsOfThread, this,
+                t, nThreads, genStart, genEnd});
     }
 
     for (std::thread& chainThread : chainThreads) {
@@ -112,18 +162,71 @@ void MetropolisCoupledMCMC::runChains(int genStart, int genEnd)
 }
 
 
+void MetropolisCoupledMCMC::runChainsOfThread
+    (int thread, int nThreads, int genStart, int genEnd)
+{
+    int nGroups = ((int)_chains.size() + _nChainLanes - 1) / _nChainLanes;
+
+    for (int group = thread; group < nGroups; group += nThreads) {
+        if (_nChainLanes == 1) {
+            runChain(group, genStart, genEnd);
+        } else {
+            int first = group * _nChainLanes;
+            int last = std::min(first + _nChainLanes, (int)_chains.size());
+            runChainGroup(first, last, genStart, genEnd);
+        }
+    }
+}
+
+
 void MetropolisCoupledMCMC::runChain(int i, int genStart, int genEnd)
 {
     for (int g = genStart; g < genEnd; g++) {
         _chains[i]->step();
+        endGeneration(i, g);
+    }
+}
 
-        if (i == _coldChainIndex) {
-            _dataWriter->writeData(g, _chains[i]->model());
 
-            if (g % _acceptanceResetFreq == 0) {
-                _chains[i]->model().resetMHAcceptanceParameters();
+// Every chain of the group proposes a new state, then the likelihoods
+// of the proposed states are computed together (for the chains whose
+// proposals need them), and every chain accepts or rejects its proposal
+void MetropolisCoupledMCMC::runChainGroup
+    (int first, int last, int genStart, int genEnd)
+{
+    std::vector<Model*> lanes;
+    lanes.reserve(last - first);
+
+    for (int g = genStart; g < genEnd; g++) {
+        lanes.clear();
+
+        for (int i = first; i < last; i++) {
+            _chains[i]->propose();
+            if (_chains[i]->model().proposalNeedsLikelihood()) {
+                lanes.push_back(&_chains[i]->model());
             }
         }
+
+        if (!lanes.empty()) {
+            lanes[0]->computeLogLikelihoodLanes(lanes);
+        }
+
+        for (int i = first; i < last; i++) {
+            _chains[i]->acceptOrReject();
+            endGeneration(i, g);
+        }
+    }
+}
+
+
+void MetropolisCoupledMCMC::endGeneration(int i, int generation)
+{
+    if (i == _coldChainIndex) {
+        _dataWriter->writeData(generation, _chains[i]->model());
+
+        if (generation % _acceptanceResetFreq == 0) {
+            _chains[i]->model().resetMHAcceptanceParameters();
+        }
     }
 }
 
@@ -151,17 +254,18 @@ void MetropolisCoupledMCMC::tryChainSwap(int generation)
 
 void MetropolisCoupledMCMC::chooseTwoNumbers(int* x, int* y, int from, int to)
 {
-    *x = _random.uniformInteger(from, to);
+    *x = _swapRandom.uniformInteger(from, to);
 
     do {
-        *y = _random.uniformInteger(from, to);
+        *y = _swapRandom.uniformInteger(from, to);
     } while (*y == *x);
 }
 
 
-bool MetropolisCoupledMCMC::acceptChainSwap(int chain_1, int chain_2) const
+bool MetropolisCoupledMCMC::acceptChainSwap(int chain_1, int chain_2)
 {
-    return _random.trueWithProbability(chainSwapProbability(chain_1, chain_2));
+    return _swapRandom.trueWithProbability
+        (chainSwapProbability(chain_1, chain_2));
 }
 
 
@@ -3,9 +3,12 @@
 
 
 #include "ChainSwapDataWriter.h"
+#include "TimingDataWriter.h"
+#include "RandomStreams.h"
+#include "Random.h"
 #include <vector>
+#include <iosfwd>
 
-class Random;
 class Settings;
 class ModelFactory;
 class MCMC;
@@ -23,6 +26,11 @@ public:
 
     void run();
 
+    // Write the proposal scales and probabilities
+    // of the cold chain (see Model)
+    void writeProposalScales(std::ostream& out);
+    void writeProposalProbabilities(std::ostream& out);
+
 private:
 
     void createChains();
@@ -32,11 +40,14 @@ private:
     void createDataWriter();
 
     void runChains(int genStart, int genEnd);
+    void runChainsOfThread(int thread, int nThreads, int genStart, int genEnd);
     void runChain(int i, int genStart, int genEnd);
+    void runChainGroup(int first, int last, int genStart, int genEnd);
+    void endGeneration(int i, int generation);
     void tryChainSwap(int generation);
 
     void chooseTwoNumbers(int* x, int* y, int from, int to);
-    bool acceptChainSwap(int chain_1, int chain_2) const;
+    bool acceptChainSwap(int chain_1, int chain_2);
     bool trueWithProbability(double p) const;
     double chainSwapProbability(int chain_1, int chain_2) const;
     double calculateLogPosterior(Model& model) const;
@@ -44,7 +55,12 @@ private:
         double log_post_1, double log_post_2) const;
     void swapTemperature(int chain_1, int chain_2);
 
-    Random& _random;
+    // Every pseudorandom stream of the run is derived from the seed of
+    // the random generator passed in, which is not otherwise used, so the
+    // run does not depend on the number of chains or threads
+    RandomStreams _streams;
+    Random _swapRandom;
+
     Settings& _settings;
     ModelFactory* _modelFactory;
 
@@ -54,6 +70,13 @@ private:
     std::vector<MCMC*> _chains;
     int _nChains;
 
+    // Number of threads the chains are divided among (0 = one per chain)
+    int _nChainThreads;
+
+    // Number of chains in each group of consecutive chains that step
+    // together and compute their likelihoods together (1 = no groups)
+    int _nChainLanes;
+
     // From Altekar, et al. 2004: delta T (> 1) is a temparature
     // increment parameter chosen such that swaps are accepted
     // between 20 and 60% of the time.
@@ -66,6 +89,7 @@ private:
     int _coldChainIndex;
 
     ChainSwapDataWriter _chainSwapDataWriter;
+    TimingDataWriter _timingDataWriter;
 
     ModelDataWriter* _dataWriter;
 
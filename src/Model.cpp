@@ -6,6 +6,7 @@
 #include "EventNumberProposal.h"
 #include "EventNumberForBranchProposal.h"
 #include "MoveEventProposal.h"
+#include "MultipleTryMoveEventProposal.h"
 #include "EventRateProposal.h"
  
 
@@ -16,25 +17,42 @@
 
 #include <string>
 #include <fstream>
+#include <cmath>
 #include <cstdlib>
 #include <vector>
+#include <algorithm>
 
 #define ENABLE_HASTINGS_RATIO_BUG
 
 
 Model::Model(Random& random, Settings& settings) :
     _random(random), _settings(settings), _prior(_random, &_settings),
-    _tree(new Tree(_random, _settings))
+    _tree(new Tree(_random, _settings)),
+    _proposalTuner(_settings.proposalSettings(), _proposalTimer)
 {
     // Initialize event rate to generate expected number of prior events
-    _eventRate = 1 / _settings.get<double>("poissonRatePrior");
+    _eventRate = 1 / _settings.priorSettings().poissonRatePrior;
 
     _acceptCount = 0;
     _rejectCount = 0;
     _acceptLast = -1;
 
+    // Enabled by derived models that provide a surrogate likelihood
+    _delayedAcceptance = false;
+    _surrogateLogLikelihood = 0.0;
+    _surrogateLogLikelihoodIsCurrent = false;
+    _firstStageRejectLast = 0;
+    _hasLaneLogLikelihood = false;
+    _laneLogLikelihood = 0.0;
+
     _lastDeletedEventMapTime = 0;
 
+    _multipleTryPool = NULL;
+    _stateVersion = 0;
+    _versionBeforeProposal = 0;
+    _copiedModel = NULL;
+    _copiedVersion = 0;
+
     _logQRatioJump = 0.0;
 
     // Initial setting for temperature = 1.0
@@ -42,13 +60,22 @@ Model::Model(Random& random, Settings& settings) :
     // function Model::setModelTemperature
     _temperatureMH = 1.0;
 
+    _tree->setStateLog(&_stateLog);
+
     // Add proposals
-    _proposals.push_back(new EventNumberProposal(random, settings, *this));
-    _proposals.push_back
-        (new EventNumberForBranchProposal(random, settings, *this));
-    _proposals.push_back(new MoveEventProposal(random, settings, *this));
-    _proposals.push_back
-        (new EventRateProposal(random, settings, *this, _prior));
+    addProposal(new EventNumberProposal(random, settings, *this),
+        "eventNumber");
+    addProposal(new EventNumberForBranchProposal(random, settings, *this),
+        "eventNumberForBranch");
+    if (_settings.modelSettings().multipleTryCandidates > 1) {
+        addProposal(new MultipleTryMoveEventProposal(random, settings, *this),
+            "eventPosition");
+    } else {
+        addProposal(new MoveEventProposal(random, settings, *this),
+            "eventPosition");
+    }
+    addProposal(new EventRateProposal(random, settings, *this, _prior),
+        "eventRate");
 
 }
 
@@ -57,7 +84,7 @@ Model::~Model()
 {
     EventSet::iterator it;
     for (it = _eventCollection.begin(); it != _eventCollection.end(); ++it) {
-        delete *it;
+        destroyBranchEvent(*it);
     }
 
     delete _tree;
@@ -67,7 +94,7 @@ Model::~Model()
         delete proposal;
     }
     
-    delete _rootEvent;
+    destroyBranchEvent(_rootEvent);
 }
 
 
@@ -99,6 +126,11 @@ void Model::initializeModelFromEventDataFile(const std::string& fileName)
     for (int i = lines.size() - 1; i != -1; --i) {
         const std::vector<std::string>& tokens = split_string(lines[i], ',');
 
+        // The header is reached if the file has a single generation
+        if (tokens[0] == "generation") {
+            break;
+        }
+
         // Get the generation, but if it differs from previous, stop
         int gen = convert_string<int>(tokens[0]);
         if (prevGeneration == 0) {
@@ -216,13 +248,51 @@ void Model::forwardSetHistoriesRecursive(Node* p)
 }
 
 
+void Model::addProposal(Proposal* proposal, const std::string& name)
+{
+    _proposals.push_back(proposal);
+    _proposalNames.push_back(name);
+    _proposalTimer.addProposal();
+    _proposalTuner.addProposal(proposal->weight());
+}
+
+
+void Model::writeProposalScales(std::ostream& out)
+{
+    for (Proposal* proposal : _proposals) {
+        if (!proposal->scaleName().empty() && proposal->weight() > 0.0) {
+            out << proposal->scaleName() << " = " << proposal->scale() << "\n";
+        }
+    }
+}
+
+
+void Model::writeProposalProbabilities(std::ostream& out)
+{
+    for (int i = 0; i < (int)_proposals.size(); i++) {
+        double previous = (i > 0) ? _updateWeights[i - 1] : 0.0;
+        out << _proposalNames[i] << " = " << _updateWeights[i] - previous
+            << "\n";
+    }
+}
+
+
 void Model::calculateUpdateWeights()
 {
-    // Add un-normalized weights of proposals
+    // Un-normalized weights of proposals
+    std::vector<double> weights;
     for (Proposal* proposal : _proposals) {
-        _updateWeights.push_back(proposal->weight());
+        weights.push_back(proposal->weight());
     }
 
+    setUpdateWeights(weights);
+}
+
+
+void Model::setUpdateWeights(const std::vector<double>& weights)
+{
+    _updateWeights = weights;
+
     // Sum all weights
     double sumWeights = 0.0;
     for (int i = 0; i < (int)_updateWeights.size(); i++) {
@@ -246,6 +316,14 @@ void Model::proposeNewState()
     int parameterToUpdate = chooseParameterToUpdate();
     _lastParameterUpdated = parameterToUpdate;
 
+    _firstStageRejectLast = 0;
+    _versionBeforeProposal = _stateVersion;
+
+    _proposalTimer.beginProposal(parameterToUpdate);
+    ScopedPhaseTimer timer(_proposalTimer, ProposalTimer::Propose);
+
+    _stateLog.begin();
+
     Proposal* proposal = _proposals[parameterToUpdate];
     proposal->propose();
 
@@ -320,6 +398,114 @@ BranchEvent* Model::addEventToTree(BranchEvent* newEvent)
 }
 
 
+// Events are compared by pointer, for the reason given in
+// removeEventFromTree()
+BranchEvent* Model::eventAtMapTime(double mapTime)
+{
+    EventSet::iterator it;
+    for (it = _eventCollection.begin(); it != _eventCollection.end(); ++it) {
+        if ((*it)->getMapTime() == mapTime) {
+            return *it;
+        }
+    }
+
+    log(Error) << "Could not find event at map time " << mapTime << ".\n";
+    std::exit(1);
+}
+
+
+void Model::moveEventToMapTime(BranchEvent* event, double mapTime)
+{
+    // Event preceding the moved event at its old position
+    BranchEvent* previousEvent =
+        event->getEventNode()->getBranchHistory()->getLastEvent(event);
+
+    event->getEventNode()->getBranchHistory()->popEventOffBranchHistory(event);
+    event->setEventByMapPosition(mapTime);
+    event->getEventNode()->getBranchHistory()->addEventToBranchHistory(event);
+
+    forwardSetBranchHistories(previousEvent);
+    forwardSetBranchHistories(event);
+    setMeanBranchParameters();
+
+    // Moves the state without a proposal being accepted (as when a
+    // multiple-try proposal draws its reference set)
+    _stateVersion++;
+}
+
+
+// Events are matched by map time: events of this model without a match
+// are removed, those of the other model are copied, and matched events
+// take the parameters of their match. Branch histories are reset only
+// if an event was added or removed, rootward events first (events are
+// in map order, in which ancestors precede descendants).
+void Model::copyStateFrom(Model& model)
+{
+    if (_copiedModel == &model && _copiedVersion == model.stateVersion()) {
+        return;
+    }
+
+    std::vector<BranchEvent*> ours
+        (_eventCollection.begin(), _eventCollection.end());
+    std::vector<BranchEvent*> theirs
+        (model.events().begin(), model.events().end());
+    std::sort(ours.begin(), ours.end(), Model::precedesOnMap);
+    std::sort(theirs.begin(), theirs.end(), Model::precedesOnMap);
+
+    bool eventsChanged = false;
+    int i = 0;
+    int j = 0;
+    while (i < (int)ours.size() || j < (int)theirs.size()) {
+        if (j == (int)theirs.size() || (i < (int)ours.size() &&
+                ours[i]->getMapTime() < theirs[j]->getMapTime())) {
+            BranchEvent* event = ours[i++];
+            event->getEventNode()->getBranchHistory()->
+                popEventOffBranchHistory(event);
+            _eventCollection.erase(event);
+            destroyBranchEvent(event);
+            eventsChanged = true;
+        } else if (i == (int)ours.size() ||
+                theirs[j]->getMapTime() < ours[i]->getMapTime()) {
+            BranchEvent* event = newBranchEventCopy(theirs[j++]);
+            event->getEventNode()->getBranchHistory()->
+                addEventToBranchHistory(event);
+            _eventCollection.insert(event);
+            eventsChanged = true;
+        } else {
+            copyEventParameters(ours[i++], theirs[j++]);
+        }
+    }
+
+    copyEventParameters(_rootEvent, model.getRootEvent());
+
+    if (eventsChanged) {
+        forwardSetBranchHistories(_rootEvent);
+
+        std::vector<BranchEvent*> events
+            (_eventCollection.begin(), _eventCollection.end());
+        std::sort(events.begin(), events.end(), Model::precedesOnMap);
+        for (BranchEvent* event : events) {
+            forwardSetBranchHistories(event);
+        }
+    }
+
+    copyModelParameters(model);
+    setMeanBranchParameters();
+
+    _copiedModel = &model;
+    _copiedVersion = model.stateVersion();
+
+    _eventRate = model.getEventRate();
+    setCurrentLogLikelihood(model.getCurrentLogLikelihood());
+}
+
+
+bool Model::precedesOnMap(BranchEvent* a, BranchEvent* b)
+{
+    return a->getMapTime() < b->getMapTime();
+}
+
+
 BranchEvent* Model::chooseEventAtRandom(bool includeRoot)
 {
     EventSet& events = _eventCollection;
@@ -361,7 +547,18 @@ BranchEvent* Model::removeEventFromTree(BranchEvent* be)
     _logQRatioJump = calculateLogQRatioJump();
 
     currNode->getBranchHistory()->popEventOffBranchHistory(be);
+    eraseEvent(be);
+
+    forwardSetBranchHistories(newLastEvent);
+
+    setMeanBranchParameters();
+
+    return be;
+}
 
+
+void Model::eraseEvent(BranchEvent* be)
+{
     // Cannot remove "be" with _eventCollection.erase(be) because
     // it is not always found in the collection, even though it is there.
     // It seems that, because event pointers are compared by comparing
@@ -380,12 +577,22 @@ BranchEvent* Model::removeEventFromTree(BranchEvent* be)
         log(Error) << "Could not find event to delete.\n";
         std::exit(1);
     }
+}
 
-    forwardSetBranchHistories(newLastEvent);
 
-    setMeanBranchParameters();
+void Model::detachEvent(BranchEvent* event)
+{
+    event->getEventNode()->getBranchHistory()->
+        popEventOffBranchHistory(event);
+    eraseEvent(event);
+}
 
-    return be;
+
+void Model::reattachEvent(BranchEvent* event)
+{
+    event->getEventNode()->getBranchHistory()->
+        addEventToBranchHistory(event);
+    _eventCollection.insert(event);
 }
 
 
@@ -541,24 +748,53 @@ bool Model::isEventConfigurationValid(BranchEvent* be)
 void Model::acceptProposal()
 {
     if (_lastProposal != NULL) {
+        ScopedPhaseTimer timer(_proposalTimer, ProposalTimer::AcceptReject);
         _lastProposal->accept();
         _acceptCount++;
+        _stateVersion++;
         _acceptLast = 1;
+        _proposalTuner.recordOutcome
+            (_lastParameterUpdated, *_lastProposal, true);
+        if (_proposalTuner.weightsChanged()) {
+            setUpdateWeights(_proposalTuner.weights());
+        }
     } else {
         _acceptLast = -1;
     }
+
+    _hasLaneLogLikelihood = false;
+    _stateLog.commit();
+
+    _proposalTimer.endProposal();
 }
 
 
 void Model::rejectProposal()
 {
     if (_lastProposal != NULL) {
+        ScopedPhaseTimer timer(_proposalTimer, ProposalTimer::AcceptReject);
         _lastProposal->reject();
         _rejectCount++;
+
+        // The state is restored, but copies may have been made of
+        // the proposed state
+        if (_stateVersion != _versionBeforeProposal) {
+            _stateVersion++;
+        }
         _acceptLast = 0;
+        _proposalTuner.recordOutcome
+            (_lastParameterUpdated, *_lastProposal, false);
+        if (_proposalTuner.weightsChanged()) {
+            setUpdateWeights(_proposalTuner.weights());
+        }
     } else {
         _acceptLast = -1;
     }
+
+    _hasLaneLogLikelihood = false;
+    _stateLog.commit();
+
+    _proposalTimer.endProposal();
 }
 
 
@@ -568,10 +804,61 @@ double Model::acceptanceRatio()
         return 0.0;
     }
 
+    ScopedPhaseTimer timer(_proposalTimer, ProposalTimer::Propose);
     return _lastProposal->acceptanceRatio();
 }
 
 
+void Model::computeLogLikelihoodLanes(const std::vector<Model*>&)
+{
+}
+
+
+bool Model::proposalNeedsLikelihood()
+{
+    return _lastProposal != NULL && _lastProposal->needsLikelihood();
+}
+
+
+// Without a cheaper approximation, the surrogate is the exact likelihood
+double Model::computeSurrogateLogLikelihood()
+{
+    return computeLogLikelihood();
+}
+
+
+// Computed lazily, because proposals that are not screened update
+// the current likelihood without computing the surrogate
+double Model::getCurrentSurrogateLogLikelihood()
+{
+    if (!_surrogateLogLikelihoodIsCurrent) {
+        _surrogateLogLikelihood = computeSurrogateLogLikelihood();
+        _surrogateLogLikelihoodIsCurrent = true;
+    }
+
+    return _surrogateLogLikelihood;
+}
+
+
+bool Model::passesFirstStage(double logRatio)
+{
+    bool passes;
+    if (std::isnan(logRatio)) {
+        passes = false;
+    } else if (logRatio >= 0.0) {
+        passes = true;
+    } else {
+        passes = _random.trueWithProbability(std::exp(logRatio));
+    }
+
+    if (!passes) {
+        _firstStageRejectLast = 1;
+    }
+
+    return passes;
+}
+
+
 double Model::getMHAcceptanceRate()
 {
     return (double)_acceptCount / (_acceptCount + _rejectCount);
@@ -4,9 +4,14 @@
 
 #include "Prior.h"
 #include "BranchEvent.h"
+#include "ProposalTimer.h"
+#include "ProposalTuner.h"
+#include "BranchEventPool.h"
+#include "StateLog.h"
 
 #include <vector>
 #include <set>
+#include <string>
 #include <iosfwd>
 
 class Random;
@@ -14,6 +19,7 @@ class Settings;
 class Tree;
 class Node;
 class Proposal;
+class WorkerPool;
 
 
 typedef std::set<BranchEvent*, BranchEvent::PtrCompare> EventSet;
@@ -47,6 +53,28 @@ public:
     virtual double computeLogLikelihood() = 0;
     virtual double computeLogPrior() = 0;
 
+    // Counts a likelihood evaluation that the current proposal skipped,
+    // because it is rejected whatever the likelihood
+    void skipLikelihoodEvaluation();
+
+    // Delayed acceptance: proposals are first screened with a cheap
+    // surrogate likelihood, and only those that pass are evaluated
+    // with the exact likelihood (Christen and Fox 2005)
+    bool delayedAcceptance();
+    virtual double computeSurrogateLogLikelihood();
+    double getCurrentSurrogateLogLikelihood();
+    void setCurrentSurrogateLogLikelihood(double x);
+    bool passesFirstStage(double logRatio);
+    int getFirstStageRejectLastUpdate();
+
+    // The likelihoods of the proposed states of several chains may be
+    // computed together (see MetropolisCoupledMCMC). Models that support
+    // it give each model the value its proposal's next
+    // computeLogLikelihood() returns; by default nothing is computed.
+    virtual void computeLogLikelihoodLanes(const std::vector<Model*>& models);
+    bool proposalNeedsLikelihood();
+    void setLaneLogLikelihood(double logLikelihood);
+
     void setLogLikelihoodRatio(double logLikelihoodRatio);
     void setLogPriorRatio(double logPriorRatio);
     void setLogQRatio(double logQRatio);
@@ -66,6 +94,17 @@ public:
     void acceptProposal();
     void rejectProposal();
 
+    int numberOfProposals();
+    const std::string& proposalName(int proposal);
+    const ProposalTimer& proposalTimer();
+
+    // Writes the scale of each proposal in use that has one
+    // as a control file line ("name = value")
+    void writeProposalScales(std::ostream& out);
+
+    // Writes the probability of choosing each proposal ("name = value")
+    void writeProposalProbabilities(std::ostream& out);
+
     BranchEvent* chooseEventAtRandom(bool includeRoot = false);
 
     // These functions take a branch event and recursively update
@@ -81,6 +120,37 @@ public:
     BranchEvent* removeEventFromTree(BranchEvent* be);
     BranchEvent* removeRandomEventFromTree();
 
+    // Changes made by the current proposal to the branch histories and
+    // rates are recorded, and undone by rollbackState() on rejection.
+    // To undo addEventToTree() or removeEventFromTree(), the event must
+    // first be detached from or reattached to its branch.
+    void rollbackState();
+    void detachEvent(BranchEvent* event);
+    void reattachEvent(BranchEvent* event);
+
+    // Events are created from (and must be returned to) the model's pool
+    void destroyBranchEvent(BranchEvent* event);
+    const BranchEventPool& eventPool();
+
+    BranchEvent* eventAtMapTime(double mapTime);
+    void moveEventToMapTime(BranchEvent* event, double mapTime);
+
+    // Multiple-try proposals evaluate candidate states on worker copies
+    // of the model, kept in sync with copyStateFrom(), on the threads of
+    // the pool (or one after the other if the pool is NULL)
+    void setMultipleTryWorkers(const std::vector<Model*>& workers,
+        WorkerPool* pool);
+    const std::vector<Model*>& multipleTryWorkers();
+    WorkerPool* multipleTryPool();
+
+    // Does nothing if the model has accepted no proposal since the last
+    // copy; otherwise only the events that differ are created or removed
+    void copyStateFrom(Model& model);
+
+    // Changes whenever a proposal is accepted, an event is moved by
+    // moveEventToMapTime(), or a proposal that moved one is rejected
+    unsigned long stateVersion();
+
     virtual void setMeanBranchParameters() = 0;
 
     double getTemperatureMH();
@@ -95,7 +165,9 @@ public:
     
 protected:
 
+    void addProposal(Proposal* proposal, const std::string& name);
     void calculateUpdateWeights();
+    void setUpdateWeights(const std::vector<double>& weights);
 
     int chooseParameterToUpdate();
 
@@ -104,8 +176,13 @@ protected:
 
     bool acceptMetropolisHastings(double lnR);
 
+    void eraseEvent(BranchEvent* be);
+
     double safeExponentiation(double x);
 
+    // Returns the value given to setLaneLogLikelihood(), only once
+    bool takeLaneLogLikelihood(double& logLikelihood);
+
     // Pure virtual methods to be implemented by derived classes
 
     virtual void setRootEventWithReadParameters
@@ -122,6 +199,11 @@ protected:
 
     virtual BranchEvent* newBranchEventFromLastDeletedEvent() = 0;
 
+    // Used by copyStateFrom() to copy a model of the same type
+    virtual BranchEvent* newBranchEventCopy(BranchEvent* event) = 0;
+    virtual void copyEventParameters(BranchEvent* to, BranchEvent* from) = 0;
+    virtual void copyModelParameters(Model& model) = 0;
+
     Random& _random;
     Settings& _settings;
 
@@ -130,6 +212,18 @@ protected:
     Tree* _tree;
 
     std::vector<Proposal*> _proposals;
+    std::vector<std::string> _proposalNames;
+
+    // Time spent in each proposal type (propose, likelihood, prior,
+    // accept/reject) and number of likelihood evaluations
+    ProposalTimer _proposalTimer;
+
+    // Adapts the proposal scales and weights during burn-in
+    ProposalTuner _proposalTuner;
+
+    BranchEventPool _eventPool;
+
+    StateLog _stateLog;
 
     std::vector<double> _updateWeights;
     int _lastParameterUpdated;
@@ -146,6 +240,14 @@ protected:
 
     double _proposedLogLikelihood;
 
+    bool _delayedAcceptance;
+    double _surrogateLogLikelihood;
+    bool _surrogateLogLikelihoodIsCurrent;
+    int _firstStageRejectLast;    // 1 if last proposal failed first stage
+
+    bool _hasLaneLogLikelihood;
+    double _laneLogLikelihood;
+
     int _acceptCount;
     int _rejectCount;
     int _acceptLast;    // true if last generation was accept; false otherwise
@@ -166,6 +268,18 @@ protected:
 
     // Temperature parameter for Metropolis coupling:
     double _temperatureMH;
+
+    static bool precedesOnMap(BranchEvent* a, BranchEvent* b);
+
+    std::vector<Model*> _multipleTryWorkers;
+    WorkerPool* _multipleTryPool;
+
+    unsigned long _stateVersion;
+    unsigned long _versionBeforeProposal;
+
+    // Model and version of the state last copied by copyStateFrom()
+    Model* _copiedModel;
+    unsigned long _copiedVersion;
 };
 
 
@@ -211,6 +325,42 @@ inline void Model::setAcceptLastUpdate(int x)
 }
 
 
+inline int Model::numberOfProposals()
+{
+    return (int)_proposals.size();
+}
+
+
+inline const std::string& Model::proposalName(int proposal)
+{
+    return _proposalNames[proposal];
+}
+
+
+inline const ProposalTimer& Model::proposalTimer()
+{
+    return _proposalTimer;
+}
+
+
+inline void Model::destroyBranchEvent(BranchEvent* event)
+{
+    _eventPool.destroy(event);
+}
+
+
+inline void Model::rollbackState()
+{
+    _stateLog.rollback();
+}
+
+
+inline const BranchEventPool& Model::eventPool()
+{
+    return _eventPool;
+}
+
+
 inline int Model::getNumberOfEvents()
 {
     return (int)_eventCollection.size();
@@ -226,6 +376,7 @@ inline BranchEvent* Model::getRootEvent()
 inline void Model::setCurrentLogLikelihood(double x)
 {
     _logLikelihood = x;
+    _surrogateLogLikelihoodIsCurrent = false;
 }
 
 
@@ -235,6 +386,50 @@ inline double Model::getCurrentLogLikelihood()
 }
 
 
+inline void Model::skipLikelihoodEvaluation()
+{
+    _proposalTimer.skipLikelihoodEvaluation();
+}
+
+
+inline bool Model::delayedAcceptance()
+{
+    return _delayedAcceptance;
+}
+
+
+inline void Model::setCurrentSurrogateLogLikelihood(double x)
+{
+    _surrogateLogLikelihood = x;
+    _surrogateLogLikelihoodIsCurrent = true;
+}
+
+
+inline int Model::getFirstStageRejectLastUpdate()
+{
+    return _firstStageRejectLast;
+}
+
+
+inline void Model::setLaneLogLikelihood(double logLikelihood)
+{
+    _laneLogLikelihood = logLikelihood;
+    _hasLaneLogLikelihood = true;
+}
+
+
+inline bool Model::takeLaneLogLikelihood(double& logLikelihood)
+{
+    if (!_hasLaneLogLikelihood) {
+        return false;
+    }
+
+    logLikelihood = _laneLogLikelihood;
+    _hasLaneLogLikelihood = false;
+    return true;
+}
+
+
 inline void Model::setLogLikelihoodRatio(double logLikelihoodRatio)
 {
     _logLikelihoodRatio = logLikelihoodRatio;
@@ -265,6 +460,32 @@ inline double Model::getTemperatureMH()
 }
 
 
+inline void Model::setMultipleTryWorkers(const std::vector<Model*>& workers,
+    WorkerPool* pool)
+{
+    _multipleTryWorkers = workers;
+    _multipleTryPool = pool;
+}
+
+
+inline const std::vector<Model*>& Model::multipleTryWorkers()
+{
+    return _multipleTryWorkers;
+}
+
+
+inline WorkerPool* Model::multipleTryPool()
+{
+    return _multipleTryPool;
+}
+
+
+inline unsigned long Model::stateVersion()
+{
+    return _stateVersion;
+}
+
+
 inline double Model::logQRatioJump()
 {
     return _logQRatioJump;
@@ -10,7 +10,8 @@ class Model;
 
 ModelDataWriter::ModelDataWriter(Settings &settings) :
     _settings(settings), _stdOutDataWriter(_settings),
-    _mcmcDataWriter(_settings), _acceptanceDataWriter(_settings)
+    _mcmcDataWriter(_settings), _acceptanceDataWriter(_settings),
+    _convergenceDiagnostics(_settings)
 {
 }
 
@@ -22,7 +23,14 @@ ModelDataWriter::~ModelDataWriter()
 
 void ModelDataWriter::writeData(int generation, Model& model)
 {
-    _stdOutDataWriter.writeData(generation, model);
+    _convergenceDiagnostics.addSample(generation, model);
+
+    _stdOutDataWriter.writeData(generation, model, _convergenceDiagnostics);
     _mcmcDataWriter.writeData(generation, model);
     _acceptanceDataWriter.writeData(model);
 }
+
+
+void ModelDataWriter::writeFinalData(Model&)
+{
+}
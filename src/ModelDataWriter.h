@@ -5,6 +5,7 @@
 #include "StdOutDataWriter.h"
 #include "MCMCDataWriter.h"
 #include "AcceptanceDataWriter.h"
+#include "ConvergenceDiagnostics.h"
 
 class Settings;
 class Model;
@@ -19,6 +20,11 @@ public:
 
     virtual void writeData(int generation, Model& model);
 
+    // Called once, at the end of the run
+    virtual void writeFinalData(Model& model);
+
+    bool hasConverged() const;
+
 protected:
 
     Settings &_settings;
@@ -26,7 +32,15 @@ protected:
     StdOutDataWriter _stdOutDataWriter;
     MCMCDataWriter _mcmcDataWriter;
     AcceptanceDataWriter _acceptanceDataWriter;
+
+    ConvergenceDiagnostics _convergenceDiagnostics;
 };
 
 
+inline bool ModelDataWriter::hasConverged() const
+{
+    return _convergenceDiagnostics.hasConverged();
+}
+
+
 #endif
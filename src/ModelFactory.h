@@ -7,6 +7,7 @@ class EventDataWriter;
 class ModelDataWriter;
 
 class Random;
+class RandomStreams;
 class Settings;
 class Prior;
 
@@ -17,7 +18,9 @@ public:
 
     virtual ~ModelFactory() {}
 
-    virtual Model* createModel(Random& random, Settings& settings) const = 0;
+    // The streams give the random settings shared by all models of a run
+    virtual Model* createModel(Random& random, const RandomStreams& streams,
+        Settings& settings) const = 0;
     virtual ModelDataWriter* createModelDataWriter
         (Settings& settings) const = 0;
 };
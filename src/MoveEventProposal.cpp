@@ -7,25 +7,31 @@
 #include "Tree.h"
 
 #include <algorithm>
+#include <cmath>
 
 
 MoveEventProposal::MoveEventProposal
     (Random& random, Settings& settings, Model& model) :
         _random(random), _settings(settings), _model(model)
 {
-    _weight = _settings.get<double>("updateRateEventPosition");
+    const ProposalSettings& proposalSettings = _settings.proposalSettings();
+    _weight = proposalSettings.updateRateEventPosition;
 
-    _localToGlobalMoveRatio = _settings.get<double>("localGlobalMoveRatio");
-    _scale = _settings.get<double>("updateEventLocationScale") *
+    _localToGlobalMoveRatio = proposalSettings.localGlobalMoveRatio;
+    _scale = proposalSettings.updateEventLocationScale *
         _model.getTreePtr()->maxRootToTipLength();
 
     _validateEventConfiguration =
-        _settings.get<bool>("validateEventConfiguration");
+        _settings.modelSettings().validateEventConfiguration;
+
+    _movedLocally = false;
 }
 
 
 void MoveEventProposal::propose()
 {
+    _movedLocally = false;
+
     _currentEventCount = _model.getNumberOfEvents();
     if (_currentEventCount == 0) {
         return;
@@ -34,6 +40,11 @@ void MoveEventProposal::propose()
     _event = _model.chooseEventAtRandom();
     _currentLogLikelihood = _model.getCurrentLogLikelihood();
 
+    if (_model.delayedAcceptance()) {
+        _currentSurrogateLogLikelihood =
+            _model.getCurrentSurrogateLogLikelihood();
+    }
+
     // This is the event preceding the chosen event;
     // histories should be set forward from here
     BranchEvent* previousEvent = _event->getEventNode()->getBranchHistory()->
@@ -46,7 +57,8 @@ void MoveEventProposal::propose()
         (1 + _localToGlobalMoveRatio);
 
     // Choose to move locally or globally
-    if (_random.trueWithProbability(localMoveProb)) {
+    _movedLocally = _random.trueWithProbability(localMoveProb);
+    if (_movedLocally) {
         double step = _random.uniform(0, _scale) - 0.5 * _scale;
         _event->moveEventLocal(step);
     } else {
@@ -59,7 +71,15 @@ void MoveEventProposal::propose()
     _model.forwardSetBranchHistories(_event);
     _model.setMeanBranchParameters();
 
-    _proposedLogLikelihood = _model.computeLogLikelihood();
+    _canBeAccepted = canBeAccepted();
+
+    // The exact likelihood is computed in acceptanceRatio(), only if the
+    // new configuration is valid (with delayed acceptance, only if the
+    // proposal also passes the first stage)
+    if (_model.delayedAcceptance()) {
+        _proposedSurrogateLogLikelihood =
+            _model.computeSurrogateLogLikelihood();
+    }
 }
 
 
@@ -70,6 +90,11 @@ void MoveEventProposal::accept()
     }
 
     _model.setCurrentLogLikelihood(_proposedLogLikelihood);
+
+    if (_model.delayedAcceptance()) {
+        _model.setCurrentSurrogateLogLikelihood
+            (_proposedSurrogateLogLikelihood);
+    }
 }
 
 
@@ -79,10 +104,6 @@ void MoveEventProposal::reject()
         return;
     }
 
-    // Get last event from position of event to be removed
-    BranchEvent* lastEvent = _event->getEventNode()->getBranchHistory()->
-        getLastEvent(_event);
-
     // Pop event off its new location
     _event->getEventNode()->getBranchHistory()->
         popEventOffBranchHistory(_event);
@@ -90,14 +111,11 @@ void MoveEventProposal::reject()
     // Reset nodeptr, reset mapTime
     _event->revertOldMapPosition();
 
-    // Now reset forward from _lastEventChanged (new position)
-    // and from newLastEvent, which holds 'last' event before old position
     _event->getEventNode()->getBranchHistory()->
         addEventToBranchHistory(_event);
 
-    _model.forwardSetBranchHistories(lastEvent);
-    _model.forwardSetBranchHistories(_event);
-    _model.setMeanBranchParameters();
+    // Branch histories and rates are restored from the state log
+    _model.rollbackState();
 }
 
 
@@ -107,15 +125,29 @@ double MoveEventProposal::acceptanceRatio()
         return 0.0;
     }
 
-    if (_validateEventConfiguration &&
-            !_model.isEventConfigurationValid(_event)) {
+    if (!_canBeAccepted) {
+        _model.skipLikelihoodEvaluation();
         return 0.0;
     }
 
-    double logLikelihoodRatio = computeLogLikelihoodRatio();
-
     double t = _model.getTemperatureMH();
-    double logRatio = t * logLikelihoodRatio;
+    double logRatio;
+
+    if (_model.delayedAcceptance()) {
+        double logSurrogateRatio =
+            _proposedSurrogateLogLikelihood - _currentSurrogateLogLikelihood;
+        if (!_model.passesFirstStage(t * logSurrogateRatio)) {
+            return 0.0;
+        }
+
+        // Second stage corrects for the error of the surrogate
+        _proposedLogLikelihood = _model.computeLogLikelihood();
+        logRatio = t * (computeLogLikelihoodRatio() - logSurrogateRatio);
+    } else {
+        _proposedLogLikelihood = _model.computeLogLikelihood();
+        double logLikelihoodRatio = computeLogLikelihoodRatio();
+        logRatio = t * logLikelihoodRatio;
+    }
 
     if (std::isfinite(logRatio)) {
         return std::min(1.0, std::exp(logRatio));
@@ -125,7 +157,46 @@ double MoveEventProposal::acceptanceRatio()
 }
 
 
+bool MoveEventProposal::needsLikelihood() const
+{
+    return _currentEventCount > 0 && _canBeAccepted &&
+        !_model.delayedAcceptance();
+}
+
+
+bool MoveEventProposal::canBeAccepted()
+{
+    return !_validateEventConfiguration ||
+        _model.isEventConfigurationValid(_event);
+}
+
+
 double MoveEventProposal::computeLogLikelihoodRatio()
 {
     return _proposedLogLikelihood - _currentLogLikelihood;
 }
+
+
+std::string MoveEventProposal::scaleName() const
+{
+    return "updateEventLocationScale";
+}
+
+
+// The scale setting is relative to the maximum root-to-tip length
+double MoveEventProposal::scale() const
+{
+    return _scale / _model.getTreePtr()->maxRootToTipLength();
+}
+
+
+void MoveEventProposal::setScale(double scale)
+{
+    _scale = scale * _model.getTreePtr()->maxRootToTipLength();
+}
+
+
+bool MoveEventProposal::lastProposalUsedScale() const
+{
+    return _movedLocally;
+}
@@ -21,9 +21,18 @@ public:
     virtual void reject();
 
     virtual double acceptanceRatio();
+    virtual bool needsLikelihood() const;
+
+    virtual std::string scaleName() const;
+    virtual double scale() const;
+    virtual void setScale(double scale);
+    virtual bool lastProposalUsedScale() const;
 
 private:
 
+    // Whether the proposal can be accepted whatever its likelihood
+    bool canBeAccepted();
+
     virtual double computeLogLikelihoodRatio();
 
     Random& _random;
@@ -32,14 +41,19 @@ private:
 
     double _localToGlobalMoveRatio;
     double _scale;
+    bool _movedLocally;
 
     bool _validateEventConfiguration;
+    bool _canBeAccepted;
 
     BranchEvent* _event;
 
     int _currentEventCount;
     double _currentLogLikelihood;
     double _proposedLogLikelihood;
+
+    double _currentSurrogateLogLikelihood;
+    double _proposedSurrogateLogLikelihood;
 };
 
 
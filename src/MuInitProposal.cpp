@@ -11,8 +11,8 @@ MuInitProposal::MuInitProposal
     (Random& random, Settings& settings, Model& model, Prior& prior) :
         EventParameterProposal(random, settings, model, prior)
 {
-    _weight = _settings.get<double>("updateRateMu0");
-    _updateMuInitScale = _settings.get<double>("updateMuInitScale");
+    _weight = _settings.spExSettings().updateRateMu0;
+    _updateMuInitScale = _settings.spExSettings().updateMuInitScale;
 }
 
 
@@ -66,3 +66,21 @@ double MuInitProposal::computeLogQRatio()
 {
     return std::log(_cterm);
 }
+
+
+std::string MuInitProposal::scaleName() const
+{
+    return "updateMuInitScale";
+}
+
+
+double MuInitProposal::scale() const
+{
+    return _updateMuInitScale;
+}
+
+
+void MuInitProposal::setScale(double scale)
+{
+    _updateMuInitScale = scale;
+}
@@ -11,8 +11,8 @@ MuShiftProposal::MuShiftProposal
     (Random& random, Settings& settings, Model& model, Prior& prior) :
         EventParameterProposal(random, settings, model, prior)
 {
-    _weight = _settings.get<double>("updateRateMuShift");
-    _updateMuShiftScale = _settings.get<double>("updateMuShiftScale");
+    _weight = _settings.spExSettings().updateRateMuShift;
+    _updateMuShiftScale = _settings.spExSettings().updateMuShiftScale;
 }
 
 
@@ -59,3 +59,21 @@ double MuShiftProposal::computeNonRootLogPriorRatio()
     return _prior.muShiftPrior(_proposedParameterValue) -
            _prior.muShiftPrior(_currentParameterValue);
 }
+
+
+std::string MuShiftProposal::scaleName() const
+{
+    return "updateMuShiftScale";
+}
+
+
+double MuShiftProposal::scale() const
+{
+    return _updateMuShiftScale;
+}
+
+
+void MuShiftProposal::setScale(double scale)
+{
+    _updateMuShiftScale = scale;
+}
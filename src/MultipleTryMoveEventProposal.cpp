@@ -0,0 +1,273 @@
+#include "MultipleTryMoveEventProposal.h"
+#include "Random.h"
+#include "Settings.h"
+#include "Model.h"
+#include "Tree.h"
+#include "BranchEvent.h"
+#include "BranchHistory.h"
+#include "Node.h"
+#include "Log.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+
+MultipleTryMoveEventProposal::MultipleTryMoveEventProposal
+    (Random& random, Settings& settings, Model& model) :
+        _random(random), _model(model)
+{
+    const ProposalSettings& proposalSettings = settings.proposalSettings();
+    _weight = proposalSettings.updateRateEventPosition;
+
+    _localToGlobalMoveRatio = proposalSettings.localGlobalMoveRatio;
+    _scale = proposalSettings.updateEventLocationScale *
+        _model.getTreePtr()->maxRootToTipLength();
+
+    _validateEventConfiguration =
+        settings.modelSettings().validateEventConfiguration;
+
+    _event = NULL;
+}
+
+
+void MultipleTryMoveEventProposal::propose()
+{
+    _event = NULL;
+
+    _currentEventCount = _model.getNumberOfEvents();
+    if (_currentEventCount == 0) {
+        return;
+    }
+
+    const std::vector<Model*>& workers = _model.multipleTryWorkers();
+    int numberOfCandidates = (int)workers.size();
+    if (numberOfCandidates == 0) {
+        log(Error) << "Multiple-try proposal has no worker models.\n";
+        std::exit(1);
+    }
+
+    _currentLogLikelihood = _model.getCurrentLogLikelihood();
+    double t = _model.getTemperatureMH();
+
+    // Candidates drawn from the current state
+    _candidates.resize(numberOfCandidates);
+    for (int i = 0; i < numberOfCandidates; i++) {
+        generateCandidate(_candidates[i]);
+    }
+    evaluateCandidates(_candidates, numberOfCandidates);
+
+    _logCandidateWeights = logSumOfWeights(_candidates, t);
+    if (!std::isfinite(_logCandidateWeights)) {
+        return;
+    }
+
+    // Move to the selected candidate
+    const Candidate& selected = _candidates[selectCandidate(t)];
+
+    _fromMapTime = selected.fromMapTime;
+    _event = _model.eventAtMapTime(_fromMapTime);
+    _model.moveEventToMapTime(_event, selected.toMapTime);
+    _proposedLogLikelihood = selected.logLikelihood;
+
+    // Reference set drawn from the selected state,
+    // completed by the current state
+    _referenceCandidates.resize(numberOfCandidates);
+    for (int i = 0; i < numberOfCandidates - 1; i++) {
+        generateCandidate(_referenceCandidates[i]);
+    }
+    evaluateCandidates(_referenceCandidates, numberOfCandidates - 1);
+
+    _referenceCandidates[numberOfCandidates - 1].logLikelihood =
+        _currentLogLikelihood;
+
+    _logReferenceWeights = logSumOfWeights(_referenceCandidates, t);
+}
+
+
+// Draws a move of a random event as in MoveEventProposal, recording the
+// event (by its map time) and its new map time, but leaves it in place.
+// The model is unchanged, so all candidates are drawn from the same state.
+void MultipleTryMoveEventProposal::generateCandidate(Candidate& candidate)
+{
+    BranchEvent* event = _model.chooseEventAtRandom();
+    candidate.fromMapTime = event->getMapTime();
+
+    double localMoveProb = _localToGlobalMoveRatio /
+        (1 + _localToGlobalMoveRatio);
+
+    if (_random.trueWithProbability(localMoveProb)) {
+        double step = _random.uniform(0, _scale) - 0.5 * _scale;
+        event->moveEventLocal(step);
+    } else {
+        event->moveEventGlobal();
+    }
+
+    candidate.toMapTime = event->getMapTime();
+    event->revertOldMapPosition();
+}
+
+
+// On the threads of the model's worker pool, if it has one
+void MultipleTryMoveEventProposal::evaluateCandidates
+    (std::vector<Candidate>& candidates, int count)
+{
+    const std::vector<Model*>& workers = _model.multipleTryWorkers();
+    WorkerPool* pool = _model.multipleTryPool();
+
+    if (pool == NULL) {
+        for (int i = 0; i < count; i++) {
+            evaluateCandidate(workers[i], &_model, &candidates[i],
+                _validateEventConfiguration);
+        }
+        return;
+    }
+
+    pool->run(count, [&](int i) {
+        evaluateCandidate(workers[i], &_model, &candidates[i],
+            _validateEventConfiguration);
+    });
+}
+
+
+// Each worker brings itself up to date with the (unchanging) state of
+// the model, applies and evaluates its candidate move, then moves the
+// event back, so it is still up to date for the next candidate
+void MultipleTryMoveEventProposal::evaluateCandidate(Model* worker,
+    Model* model, Candidate* candidate, bool validateEventConfiguration)
+{
+    worker->copyStateFrom(*model);
+
+    BranchEvent* event = worker->eventAtMapTime(candidate->fromMapTime);
+    worker->moveEventToMapTime(event, candidate->toMapTime);
+
+    if (validateEventConfiguration &&
+            !worker->isEventConfigurationValid(event)) {
+        candidate->logLikelihood = -INFINITY;
+    } else {
+        candidate->logLikelihood = worker->computeLogLikelihood();
+    }
+
+    worker->moveEventToMapTime(event, candidate->fromMapTime);
+}
+
+
+int MultipleTryMoveEventProposal::selectCandidate(double temperature)
+{
+    double maxLogWeight = -INFINITY;
+    for (const Candidate& candidate : _candidates) {
+        maxLogWeight = std::max(maxLogWeight,
+            temperature * candidate.logLikelihood);
+    }
+
+    std::vector<double> cumulativeWeights;
+    double sumWeights = 0.0;
+    for (const Candidate& candidate : _candidates) {
+        sumWeights += std::exp
+            (temperature * candidate.logLikelihood - maxLogWeight);
+        cumulativeWeights.push_back(sumWeights);
+    }
+
+    double r = _random.uniform(0.0, sumWeights);
+    for (int i = 0; i < (int)cumulativeWeights.size(); i++) {
+        if (r < cumulativeWeights[i]) {
+            return i;
+        }
+    }
+
+    return (int)cumulativeWeights.size() - 1;
+}
+
+
+double MultipleTryMoveEventProposal::logSumOfWeights
+    (const std::vector<Candidate>& candidates, double temperature)
+{
+    double maxLogWeight = -INFINITY;
+    for (const Candidate& candidate : candidates) {
+        maxLogWeight = std::max(maxLogWeight,
+            temperature * candidate.logLikelihood);
+    }
+
+    if (!std::isfinite(maxLogWeight)) {
+        return maxLogWeight;
+    }
+
+    double sumWeights = 0.0;
+    for (const Candidate& candidate : candidates) {
+        sumWeights += std::exp
+            (temperature * candidate.logLikelihood - maxLogWeight);
+    }
+
+    return maxLogWeight + std::log(sumWeights);
+}
+
+
+void MultipleTryMoveEventProposal::accept()
+{
+    if (_event == NULL) {
+        return;
+    }
+
+    _model.setCurrentLogLikelihood(_proposedLogLikelihood);
+}
+
+
+void MultipleTryMoveEventProposal::reject()
+{
+    if (_event == NULL) {
+        return;
+    }
+
+    _event->getEventNode()->getBranchHistory()->
+        popEventOffBranchHistory(_event);
+    _event->setEventByMapPosition(_fromMapTime);
+    _event->getEventNode()->getBranchHistory()->
+        addEventToBranchHistory(_event);
+
+    // Branch histories and rates are restored from the state log
+    _model.rollbackState();
+}
+
+
+double MultipleTryMoveEventProposal::acceptanceRatio()
+{
+    if (_event == NULL) {
+        return 0.0;
+    }
+
+    double logRatio = _logCandidateWeights - _logReferenceWeights;
+
+    if (std::isfinite(logRatio)) {
+        return std::min(1.0, std::exp(logRatio));
+    } else {
+        return 0.0;
+    }
+}
+
+
+std::string MultipleTryMoveEventProposal::scaleName() const
+{
+    return "updateEventLocationScale";
+}
+
+
+// The scale setting is relative to the maximum root-to-tip length
+double MultipleTryMoveEventProposal::scale() const
+{
+    return _scale / _model.getTreePtr()->maxRootToTipLength();
+}
+
+
+void MultipleTryMoveEventProposal::setScale(double scale)
+{
+    _scale = scale * _model.getTreePtr()->maxRootToTipLength();
+}
+
+
+// Candidates mix local and global moves, so every proposal
+// that moved an event counts
+bool MultipleTryMoveEventProposal::lastProposalUsedScale() const
+{
+    return _event != NULL;
+}
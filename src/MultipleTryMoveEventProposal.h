@@ -0,0 +1,82 @@
+#ifndef MULTIPLE_TRY_MOVE_EVENT_PROPOSAL_H
+#define MULTIPLE_TRY_MOVE_EVENT_PROPOSAL_H
+
+
+#include "Proposal.h"
+
+#include <vector>
+
+class Random;
+class Settings;
+class Model;
+class BranchEvent;
+
+
+// Multiple-try Metropolis version of MoveEventProposal
+// (Liu, Liang and Wong 2000). Several candidate moves are drawn,
+// their likelihoods are evaluated on worker copies of the model (on the
+// chain's worker pool, when it has one), and one is selected in
+// proportion to its (tempered) likelihood.
+// The acceptance ratio compares the summed weights of the candidates
+// with those of a reference set drawn from the selected state.
+
+class MultipleTryMoveEventProposal : public Proposal
+{
+    struct Candidate
+    {
+        double fromMapTime;
+        double toMapTime;
+        double logLikelihood;
+    };
+
+public:
+
+    MultipleTryMoveEventProposal
+        (Random& random, Settings& settings, Model& model);
+
+    virtual void propose();
+    virtual void accept();
+    virtual void reject();
+
+    virtual double acceptanceRatio();
+
+    virtual std::string scaleName() const;
+    virtual double scale() const;
+    virtual void setScale(double scale);
+    virtual bool lastProposalUsedScale() const;
+
+private:
+
+    void generateCandidate(Candidate& candidate);
+    void evaluateCandidates(std::vector<Candidate>& candidates, int count);
+    static void evaluateCandidate(Model* worker, Model* model,
+        Candidate* candidate, bool validateEventConfiguration);
+
+    int selectCandidate(double temperature);
+    double logSumOfWeights(const std::vector<Candidate>& candidates,
+        double temperature);
+
+    Random& _random;
+    Model& _model;
+
+    double _localToGlobalMoveRatio;
+    double _scale;
+
+    bool _validateEventConfiguration;
+
+    std::vector<Candidate> _candidates;
+    std::vector<Candidate> _referenceCandidates;
+
+    BranchEvent* _event;
+    double _fromMapTime;
+
+    int _currentEventCount;
+    double _currentLogLikelihood;
+    double _proposedLogLikelihood;
+
+    double _logCandidateWeights;
+    double _logReferenceWeights;
+};
+
+
+#endif
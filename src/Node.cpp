@@ -29,6 +29,7 @@ void Node::init(int x)
     _anc = NULL;
     _name = "";
     _index = x;
+    _preOrderIndex = -1;
     _time = 0.0;
     _brlen = 0.0;
     _isTip = false;
@@ -43,6 +44,7 @@ void Node::init(int x)
     _cladeName = "";
 
     _history = new BranchHistory();
+    _stateLog = NULL;
 
     // Compound Poisson stuff
     _meanSpeciationRate = 0.0;
@@ -176,6 +178,13 @@ Node* Node::getRandomRightTipNode()
 }
 
 
+void Node::setStateLog(StateLog* stateLog)
+{
+    _stateLog = stateLog;
+    _history->setStateLog(stateLog);
+}
+
+
 double Node::pathLengthToRoot()
 {
     double length = getBrlen();
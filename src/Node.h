@@ -9,6 +9,8 @@
 #ifndef NODE_H
 #define NODE_H
 
+#include "StateLog.h"
+
 #include <string>
 
 class branchEvent;
@@ -33,6 +35,7 @@ private:
     std::string _cladeName;
 
     int    _index;
+    int    _preOrderIndex;  // Index in the tree's pre-order node list
     double _time;
     double _brlen;
     double _branchTime;
@@ -84,6 +87,9 @@ private:
     bool _hasDownstreamRateShift;
     
     bool _inheritFromLeft;
+
+    // Saves the rates overwritten by a proposal (may be NULL)
+    StateLog* _stateLog;
     
 
 public:
@@ -110,6 +116,9 @@ public:
     void setIndex(int x);
     int  getIndex();
 
+    void setPreOrderIndex(int x);
+    int  getPreOrderIndex();
+
     void   setTime(double x);
     double getTime();
 
@@ -153,6 +162,9 @@ public:
     //Need to includet this
     BranchHistory* getBranchHistory();
 
+    // Also sets the state log of the branch history
+    void setStateLog(StateLog* stateLog);
+
     void   setMeanSpeciationRate(double x);
     double getMeanSpeciationRate();
 
@@ -286,6 +298,12 @@ inline void Node::setIndex(int x)
 }
 
 
+inline void Node::setPreOrderIndex(int x)
+{
+    _preOrderIndex = x;
+}
+
+
 inline void Node::setTime(double x)
 {
     _time = x;
@@ -334,6 +352,12 @@ inline int Node::getIndex()
 }
 
 
+inline int Node::getPreOrderIndex()
+{
+    return _preOrderIndex;
+}
+
+
 inline double Node::getTime()
 {
     return _time;
@@ -432,6 +456,10 @@ inline BranchHistory* Node::getBranchHistory()
 
 inline void Node::setMeanSpeciationRate(double x)
 {
+    if (_stateLog != NULL) {
+        _stateLog->record(_meanSpeciationRate, x);
+    }
+
     _meanSpeciationRate = x;
 }
 
@@ -444,6 +472,10 @@ inline double Node::getMeanSpeciationRate()
 
 inline void Node::setMeanExtinctionRate(double x)
 {
+    if (_stateLog != NULL) {
+        _stateLog->record(_meanExtinctionRate, x);
+    }
+
     _meanExtinctionRate = x;
 }
 
@@ -456,6 +488,10 @@ inline double Node::getMeanExtinctionRate()
 
 inline void Node::setNodeLambda(double x)
 {
+    if (_stateLog != NULL) {
+        _stateLog->record(_nodeLambda, x);
+    }
+
     _nodeLambda = x;
 }
 
@@ -468,6 +504,10 @@ inline double Node::getNodeLambda()
 
 inline void Node::setNodeMu(double x)
 {
+    if (_stateLog != NULL) {
+        _stateLog->record(_nodeMu, x);
+    }
+
     _nodeMu = x;
 }
 
@@ -480,6 +520,10 @@ inline double Node::getNodeMu()
 
 inline void Node::setNodeBeta(double x)
 {
+    if (_stateLog != NULL) {
+        _stateLog->record(_nodeBeta, x);
+    }
+
     _nodeBeta = x;
 }
 
@@ -504,6 +548,10 @@ inline double Node::getTraitValue()
 
 inline void Node::setMeanBeta(double x)
 {
+    if (_stateLog != NULL) {
+        _stateLog->record(_meanBeta, x);
+    }
+
     _meanBeta = x;
 }
 
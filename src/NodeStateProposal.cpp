@@ -16,16 +16,16 @@ NodeStateProposal::NodeStateProposal
         _random(random), _settings(settings),
         _model(static_cast<TraitModel&>(model)), _tree(model.getTreePtr())
 {
-    _weight = _settings.get<double>("updateRateNodeState");
+    _weight = _settings.traitSettings().updateRateNodeState;
 
     // Node state scale is relative to the standard deviation
     // of the trait values (located in the tree terminal nodes)
-    double sd_traits = Stat::standard_deviation(_tree->traitValues());
+    _sdTraits = Stat::standard_deviation(_tree->traitValues());
     _updateNodeStateScale =
-        _settings.get<double>("updateNodeStateScale") * sd_traits;
+        _settings.traitSettings().updateNodeStateScale * _sdTraits;
 
-    _priorMin = _settings.get<double>("traitPriorMin");
-    _priorMax = _settings.get<double>("traitPriorMax");
+    _priorMin = _settings.traitSettings().traitPriorMin;
+    _priorMax = _settings.traitSettings().traitPriorMax;
 
     // Min and max trait priors must be updated later,
     // after tree is initialized during model construction
@@ -64,13 +64,21 @@ void NodeStateProposal::propose()
 
     _node = _tree->chooseInternalNodeAtRandom();
 
-    double currentTriadLogLikelihood =
-        _model.computeTriadLikelihoodTraits(_node);
     _currentLogLikelihood = _model.getCurrentLogLikelihood();
     _currentNodeState = _node->getTraitValue();
 
     _proposedNodeState = _currentNodeState + _random.uniform
         (-_updateNodeStateScale, _updateNodeStateScale);
+
+    // A state out of the prior's range is rejected (in acceptanceRatio())
+    // without computing the likelihood
+    if (_proposedNodeState < _priorMin || _proposedNodeState > _priorMax) {
+        _model.skipLikelihoodEvaluation();
+        return;
+    }
+
+    double currentTriadLogLikelihood =
+        _model.computeTriadLikelihoodTraits(_node);
     _node->setTraitValue(_proposedNodeState);
 
     double proposedTriadLogLikelihood =
@@ -115,3 +123,22 @@ double NodeStateProposal::computeLogLikelihoodRatio()
 {
     return _proposedLogLikelihood - _currentLogLikelihood;
 }
+
+
+std::string NodeStateProposal::scaleName() const
+{
+    return "updateNodeStateScale";
+}
+
+
+// The scale setting is relative to the standard deviation of the traits
+double NodeStateProposal::scale() const
+{
+    return _updateNodeStateScale / _sdTraits;
+}
+
+
+void NodeStateProposal::setScale(double scale)
+{
+    _updateNodeStateScale = scale * _sdTraits;
+}
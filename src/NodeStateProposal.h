@@ -24,6 +24,10 @@ public:
 
     virtual double acceptanceRatio();
 
+    virtual std::string scaleName() const;
+    virtual double scale() const;
+    virtual void setScale(double scale);
+
 private:
 
     void updateMinMaxTraitPriorSettings();
@@ -36,6 +40,7 @@ private:
     Tree* _tree;
     Node* _node;
 
+    double _sdTraits;
     double _updateNodeStateScale;
     double _priorMin;
     double _priorMax;
@@ -0,0 +1,239 @@
+#include "PosteriorSummaryDataWriter.h"
+#include "Settings.h"
+#include "Model.h"
+#include "Tree.h"
+#include "Node.h"
+#include "BranchHistory.h"
+#include "BranchEvent.h"
+#include "Log.h"
+
+#include <fstream>
+#include <cmath>
+#include <cstdlib>
+
+
+PosteriorSummaryDataWriter::RunningMoments::RunningMoments() :
+    count(0), mean(0.0), sumSquaredDeviations(0.0)
+{
+}
+
+
+void PosteriorSummaryDataWriter::RunningMoments::add(double x)
+{
+    count++;
+    double delta = x - mean;
+    mean += delta / count;
+    sumSquaredDeviations += delta * (x - mean);
+}
+
+
+double PosteriorSummaryDataWriter::RunningMoments::variance() const
+{
+    if (count < 2) {
+        return 0.0;
+    }
+
+    return sumSquaredDeviations / (count - 1);
+}
+
+
+PosteriorSummaryDataWriter::PosteriorSummaryDataWriter(Settings& settings) :
+    _sampleFreq(settings.get<int>("summarySampleFreq")),
+    _writeFreq(settings.get<int>("summaryWriteFreq")),
+    _numberOfTimeBins(settings.get<int>("summaryNumberOfTimeBins")),
+    _timeBinWidth(0.0),
+    _branchSummaryFileName(settings.get("branchSummaryOutfile")),
+    _rateThroughTimeFileName(settings.get("rateThroughTimeOutfile")),
+    _initialized(false),
+    _numberOfSamples(0)
+{
+    double burnIn = settings.get<double>("summaryBurnIn");
+    if (burnIn < 0.0 || burnIn >= 1.0) {
+        log(Error) << "summaryBurnIn must be at least 0 and less than 1.\n";
+        std::exit(1);
+    }
+
+    if (_sampleFreq > 0 && _numberOfTimeBins < 1) {
+        log(Error) << "summaryNumberOfTimeBins must be at least 1.\n";
+        std::exit(1);
+    }
+
+    int numberOfGenerations = settings.mcmcSettings().numberOfGenerations;
+    _burnInGenerations = (int)(burnIn * numberOfGenerations);
+}
+
+
+PosteriorSummaryDataWriter::~PosteriorSummaryDataWriter()
+{
+}
+
+
+void PosteriorSummaryDataWriter::writeData(int generation, Model& model)
+{
+    if (_sampleFreq == 0) {
+        return;
+    }
+
+    Tree& tree = *model.getTreePtr();
+
+    if (generation >= _burnInGenerations && generation % _sampleFreq == 0) {
+        initialize(tree);
+        addSample(model);
+    }
+
+    if (_writeFreq > 0 && generation % _writeFreq == 0 && _initialized) {
+        writeSummaries(tree);
+    }
+}
+
+
+void PosteriorSummaryDataWriter::writeFinalData(Model& model)
+{
+    if (_sampleFreq == 0 || !_initialized) {
+        return;
+    }
+
+    writeSummaries(*model.getTreePtr());
+}
+
+
+// All chains use the same tree, so the branch order and the time bins
+// stay valid when the cold chain changes
+void PosteriorSummaryDataWriter::initialize(Tree& tree)
+{
+    if (_initialized) {
+        return;
+    }
+
+    int numberOfBranches = (int)tree.postOrderNodes().size();
+
+    _branchRates.assign(numberOfRates(),
+        std::vector<RunningMoments>(numberOfBranches));
+    _shiftCounts.assign(numberOfBranches, 0);
+
+    _ratesThroughTime.assign(numberOfRates(),
+        std::vector<RunningMoments>(_numberOfTimeBins));
+    _timeBinWidth = tree.getAge() / _numberOfTimeBins;
+
+    _initialized = true;
+}
+
+
+// Not all proposals keep the mean branch rates up to date,
+// so they are computed before they are read
+void PosteriorSummaryDataWriter::addSample(Model& model)
+{
+    Tree& tree = *model.getTreePtr();
+    model.setMeanBranchParameters();
+
+    const std::vector<Node*>& nodes = tree.postOrderNodes();
+
+    for (int i = 0; i < (int)nodes.size(); i++) {
+        for (int rate = 0; rate < numberOfRates(); rate++) {
+            _branchRates[rate][i].add(branchRate(nodes[i], rate));
+        }
+
+        if (nodes[i]->getBranchHistory()->getNumberOfBranchEvents() > 0) {
+            _shiftCounts[i]++;
+        }
+    }
+
+    addRatesThroughTime(tree);
+
+    _numberOfSamples++;
+}
+
+
+void PosteriorSummaryDataWriter::addRatesThroughTime(Tree& tree)
+{
+    const std::vector<Node*>& nodes = tree.postOrderNodes();
+
+    std::vector<double> rateSums(numberOfRates());
+
+    for (int bin = 0; bin < _numberOfTimeBins; bin++) {
+        double time = (bin + 0.5) * _timeBinWidth;
+
+        rateSums.assign(numberOfRates(), 0.0);
+        int numberOfLineages = 0;
+
+        for (Node* node : nodes) {
+            if (node->getAnc() == NULL || node->getAnc()->getTime() >= time ||
+                    node->getTime() < time) {
+                continue;
+            }
+
+            BranchEvent* event = node->getBranchHistory()->getLastEvent(time);
+            for (int rate = 0; rate < numberOfRates(); rate++) {
+                rateSums[rate] += rateAtTime(event, time, rate);
+            }
+            numberOfLineages++;
+        }
+
+        if (numberOfLineages == 0) {
+            continue;
+        }
+
+        for (int rate = 0; rate < numberOfRates(); rate++) {
+            _ratesThroughTime[rate][bin].add
+                (rateSums[rate] / numberOfLineages);
+        }
+    }
+}
+
+
+void PosteriorSummaryDataWriter::writeSummaries(Tree& tree)
+{
+    writeBranchSummary(tree);
+    writeRatesThroughTime();
+}
+
+
+void PosteriorSummaryDataWriter::writeBranchSummary(Tree& tree)
+{
+    std::ofstream outputStream(_branchSummaryFileName.c_str());
+
+    tree.writeBranchLengthTree(tree.getRoot(), outputStream);
+    outputStream << ";\n";
+
+    outputStream << "branch,samples,shiftProbability";
+    for (int rate = 0; rate < numberOfRates(); rate++) {
+        outputStream << "," << rateName(rate) << "_mean"
+                     << "," << rateName(rate) << "_sd";
+    }
+    outputStream << "\n";
+
+    for (int i = 0; i < (int)_shiftCounts.size(); i++) {
+        outputStream << i << "," << _numberOfSamples << ","
+            << (double)_shiftCounts[i] / _numberOfSamples;
+        for (int rate = 0; rate < numberOfRates(); rate++) {
+            const RunningMoments& moments = _branchRates[rate][i];
+            outputStream << "," << moments.mean
+                         << "," << std::sqrt(moments.variance());
+        }
+        outputStream << "\n";
+    }
+}
+
+
+void PosteriorSummaryDataWriter::writeRatesThroughTime()
+{
+    std::ofstream outputStream(_rateThroughTimeFileName.c_str());
+
+    outputStream << "time";
+    for (int rate = 0; rate < numberOfRates(); rate++) {
+        outputStream << "," << rateName(rate) << "_mean"
+                     << "," << rateName(rate) << "_sd";
+    }
+    outputStream << "\n";
+
+    for (int bin = 0; bin < _numberOfTimeBins; bin++) {
+        outputStream << (bin + 0.5) * _timeBinWidth;
+        for (int rate = 0; rate < numberOfRates(); rate++) {
+            const RunningMoments& moments = _ratesThroughTime[rate][bin];
+            outputStream << "," << moments.mean
+                         << "," << std::sqrt(moments.variance());
+        }
+        outputStream << "\n";
+    }
+}
+
@@ -0,0 +1,88 @@
+#ifndef POSTERIOR_SUMMARY_DATA_WRITER_H
+#define POSTERIOR_SUMMARY_DATA_WRITER_H
+
+
+#include <string>
+#include <vector>
+
+class Settings;
+class Model;
+class Tree;
+class Node;
+class BranchEvent;
+
+
+// Summarizes the posterior while the chain runs, so that mean branch
+// rates, marginal shift probabilities and rates through time do not
+// have to be reconstructed from the event data file. After the burn-in,
+// the state is sampled every summarySampleFreq generations, updating:
+//   - the mean and variance of the mean rate(s) of each branch,
+//   - the number of samples with at least one shift on each branch,
+//   - the mean and variance, in equal time bins from the root to the
+//     present, of the rate(s) averaged over the lineages alive at the
+//     middle of each bin.
+// The summaries are written every summaryWriteFreq generations and at
+// the end of the run, replacing the previous summaries. Branches are
+// numbered as in BranchRatesDataWriter (post-order, the root last).
+
+class PosteriorSummaryDataWriter
+{
+public:
+
+    PosteriorSummaryDataWriter(Settings& settings);
+    virtual ~PosteriorSummaryDataWriter();
+
+    void writeData(int generation, Model& model);
+    void writeFinalData(Model& model);
+
+protected:
+
+    // Running mean and variance (Welford's algorithm)
+    struct RunningMoments
+    {
+        RunningMoments();
+
+        void add(double x);
+        double variance() const;
+
+        long long count;
+        double mean;
+        double sumSquaredDeviations;
+    };
+
+    void initialize(Tree& tree);
+    void addSample(Model& model);
+    void addRatesThroughTime(Tree& tree);
+
+    void writeSummaries(Tree& tree);
+    void writeBranchSummary(Tree& tree);
+    void writeRatesThroughTime();
+
+    virtual int numberOfRates() = 0;
+    virtual std::string rateName(int rate) = 0;
+    virtual double branchRate(Node* node, int rate) = 0;
+    virtual double rateAtTime(BranchEvent* event, double time, int rate) = 0;
+
+    int _sampleFreq;
+    int _writeFreq;
+    int _burnInGenerations;
+
+    int _numberOfTimeBins;
+    double _timeBinWidth;
+
+    std::string _branchSummaryFileName;
+    std::string _rateThroughTimeFileName;
+
+    bool _initialized;
+    long long _numberOfSamples;
+
+    // Indexed by rate, then by branch (in post-order)
+    std::vector<std::vector<RunningMoments> > _branchRates;
+    std::vector<long long> _shiftCounts;
+
+    // Indexed by rate, then by time bin
+    std::vector<std::vector<RunningMoments> > _ratesThroughTime;
+};
+
+
+#endif
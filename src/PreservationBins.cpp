@@ -0,0 +1,122 @@
+#include "PreservationBins.h"
+#include "Log.h"
+
+#include <cstdlib>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+
+PreservationBins::PreservationBins(const std::string& fileName)
+{
+    read(fileName);
+
+    // Oldest first
+    std::sort(_bins.begin(), _bins.end());
+
+    assertBinsAreContiguous();
+}
+
+
+bool PreservationBins::Bin::operator<(const Bin& other) const
+{
+    return startAge > other.startAge;
+}
+
+
+void PreservationBins::read(const std::string& fileName)
+{
+    std::ifstream inputFile(fileName.c_str());
+
+    if (!inputFile) {
+        log(Error) << "Could not read preservation bins from file "
+            << "<<" << fileName << ">>.\n";
+        std::exit(1);
+    }
+
+    log() << "Reading preservation bins from file <<" << fileName << ">>.\n";
+
+    std::string line;
+    while (std::getline(inputFile, line)) {
+        std::istringstream lineStream(line);
+
+        Bin bin;
+        if (!(lineStream >> bin.startAge)) {
+            // Blank lines are ignored
+            continue;
+        }
+
+        if (!(lineStream >> bin.endAge >> bin.occurrences)) {
+            log(Error) << "Preservation bin file is not formatted properly;\n"
+                << "each line must be <start age> <end age> "
+                << "<number of occurrences>.\n";
+            std::exit(1);
+        }
+
+        if (bin.startAge <= bin.endAge || bin.endAge < 0.0 ||
+                bin.occurrences < 0) {
+            log(Error) << "Invalid preservation bin <<" << line << ">>.\n"
+                << "The start age must be greater than the end age, "
+                << "which must not be\nnegative, and the number of "
+                << "occurrences must not be negative.\n";
+            std::exit(1);
+        }
+
+        _bins.push_back(bin);
+    }
+
+    if (_bins.empty()) {
+        log(Error) << "There are no bins in the preservation bin file.\n";
+        std::exit(1);
+    }
+
+    log() << "Read " << _bins.size() << " preservation bins with "
+        << totalOccurrences() << " occurrences.\n";
+}
+
+
+void PreservationBins::assertBinsAreContiguous() const
+{
+    for (int i = 1; i < (int)_bins.size(); i++) {
+        if (std::fabs(_bins[i].startAge - _bins[i - 1].endAge) >
+                PRESERVATION_BIN_TOLERANCE) {
+            log(Error) << "Preservation bins must be contiguous, but the "
+                << "bin ending at age " << _bins[i - 1].endAge << "\n"
+                << "is followed by one starting at age "
+                << _bins[i].startAge << ".\n";
+            std::exit(1);
+        }
+    }
+}
+
+
+int PreservationBins::totalOccurrences() const
+{
+    int total = 0;
+    for (int i = 0; i < (int)_bins.size(); i++) {
+        total += _bins[i].occurrences;
+    }
+
+    return total;
+}
+
+
+std::vector<double> PreservationBins::binStartTimes
+    (double observationTime) const
+{
+    if (_bins.front().startAge < observationTime - PRESERVATION_BIN_TOLERANCE ||
+            _bins.back().endAge > PRESERVATION_BIN_TOLERANCE) {
+        log(Error) << "Preservation bins must cover the tree, from the "
+            << "age of the root\n(" << observationTime << ") to the "
+            << "present (0).\n";
+        std::exit(1);
+    }
+
+    std::vector<double> startTimes;
+    for (int i = 1; i < (int)_bins.size(); i++) {
+        startTimes.push_back(observationTime - _bins[i].startAge);
+    }
+
+    return startTimes;
+}
@@ -0,0 +1,66 @@
+#ifndef PRESERVATION_BINS_H
+#define PRESERVATION_BINS_H
+
+
+#include <string>
+#include <vector>
+
+
+// Bins must meet (and cover the tree) within this many time units
+#define PRESERVATION_BIN_TOLERANCE 1e-6
+
+
+// Stratigraphic time bins for fossil preservation rates, read from the
+// file given by preservationBinsFilename, with one line per bin:
+//     <start age> <end age> <number of occurrences>
+// Ages are times before the observation time (the present), so a bin
+// starts at its older age. The bins may be listed in any order, but
+// they must be contiguous and cover the tree, from the root to the
+// observation time. Bins are numbered from the oldest.
+
+class PreservationBins
+{
+public:
+
+    PreservationBins(const std::string& fileName);
+
+    int numberOfBins() const;
+    int occurrences(int bin) const;
+    int totalOccurrences() const;
+
+    // Times (from the root) at which bins 1, 2, ... start;
+    // exits if the bins do not cover the time from the root
+    // (observationTime before the present) to the present
+    std::vector<double> binStartTimes(double observationTime) const;
+
+private:
+
+    struct Bin
+    {
+        double startAge;
+        double endAge;
+        int occurrences;
+
+        bool operator<(const Bin& other) const;
+    };
+
+    void read(const std::string& fileName);
+    void assertBinsAreContiguous() const;
+
+    std::vector<Bin> _bins;
+};
+
+
+inline int PreservationBins::numberOfBins() const
+{
+    return (int)_bins.size();
+}
+
+
+inline int PreservationBins::occurrences(int bin) const
+{
+    return _bins[bin].occurrences;
+}
+
+
+#endif
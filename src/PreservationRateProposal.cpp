@@ -5,18 +5,24 @@
 #include "Prior.h"
 #include "SpExModel.h"
 #include <algorithm>
+#include <cmath>
 
 PreservationRateProposal::PreservationRateProposal
     (Random& random, Settings& settings, Model& model, Prior& prior) :
         _random(random), _settings(settings), _model(model), _prior(prior)
 {
-    _weight = settings.get<double>("updateRatePreservationRate");
-    _updatePreservationRateScale = settings.get<double>("updatePreservationRateScale");
+    _weight = settings.spExSettings().updateRatePreservationRate;
+    _updatePreservationRateScale = settings.spExSettings().updatePreservationRateScale;
     
 }
 
+// With time-binned preservation rates, the rate of one bin, chosen at
+// random, is updated
 void PreservationRateProposal::propose()
 {
+    int bins = static_cast<SpExModel*>(&_model)->numberOfPreservationBins();
+    _bin = (bins > 1) ? _random.uniformInteger(0, bins - 1) : 0;
+
     _currentParameterValue = getCurrentParameterValue();
     
     _currentLogLikelihood = _model.getCurrentLogLikelihood();
@@ -25,24 +31,25 @@ void PreservationRateProposal::propose()
     _proposedParameterValue = _cterm * _currentParameterValue;
     
     setProposedParameterValue();
- 
-    _proposedLogLikelihood = _model.computeLogLikelihood();
-    
+
+    _canBeAccepted = canBeAccepted();
 }
 
 double PreservationRateProposal::getCurrentParameterValue()
 {
-    return static_cast<SpExModel*>(&_model)->getPreservationRate();
+    return static_cast<SpExModel*>(&_model)->getPreservationRate(_bin);
 }
 
 void PreservationRateProposal::setProposedParameterValue()
 {
-    static_cast<SpExModel*>(&_model)->setPreservationRate(_proposedParameterValue);
+    static_cast<SpExModel*>(&_model)->setPreservationRate
+        (_bin, _proposedParameterValue);
 }
 
 void PreservationRateProposal::revertToOldParameterValue()
 {
-     static_cast<SpExModel*>(&_model)->setPreservationRate(_currentParameterValue);
+     static_cast<SpExModel*>(&_model)->setPreservationRate
+        (_bin, _currentParameterValue);
 }
 
 
@@ -58,14 +65,20 @@ void PreservationRateProposal::reject()
 }
 
 
+// The likelihood is not computed at all if the proposal is rejected
+// whatever its value
 double PreservationRateProposal::acceptanceRatio()
 {
+    if (!_canBeAccepted) {
+        _model.skipLikelihoodEvaluation();
+        return 0.0;
+    }
+
+    _proposedLogLikelihood = _model.computeLogLikelihood();
     double logLikelihoodRatio = _proposedLogLikelihood - _currentLogLikelihood;
-    double logPriorRatio = computeLogPriorRatio();
-    double logQratio = computeLogQRatio();
     
     double t = _model.getTemperatureMH();
-    double logRatio = t * (logLikelihoodRatio + logPriorRatio) + logQratio;
+    double logRatio = t * (logLikelihoodRatio + _logPriorRatio) + _logQRatio;
     
     if (std::isfinite(logRatio)) {
         return std::min(1.0, std::exp(logRatio));
@@ -75,6 +88,22 @@ double PreservationRateProposal::acceptanceRatio()
 
 }
 
+
+bool PreservationRateProposal::needsLikelihood() const
+{
+    return _canBeAccepted;
+}
+
+
+// Computes the ratios that do not depend on the likelihood
+bool PreservationRateProposal::canBeAccepted()
+{
+    _logPriorRatio = computeLogPriorRatio();
+    _logQRatio = computeLogQRatio();
+
+    return std::isfinite(_logPriorRatio) && std::isfinite(_logQRatio);
+}
+
 double PreservationRateProposal::computeLogPriorRatio()
 {
 
@@ -90,5 +119,19 @@ double PreservationRateProposal::computeLogQRatio()
 }
 
 
+std::string PreservationRateProposal::scaleName() const
+{
+    return "updatePreservationRateScale";
+}
+
+
+double PreservationRateProposal::scale() const
+{
+    return _updatePreservationRateScale;
+}
 
 
+void PreservationRateProposal::setScale(double scale)
+{
+    _updatePreservationRateScale = scale;
+}
@@ -26,6 +26,11 @@ public:
     virtual void reject();
     
     virtual double acceptanceRatio();
+    virtual bool needsLikelihood() const;
+
+    virtual std::string scaleName() const;
+    virtual double scale() const;
+    virtual void setScale(double scale);
     
     
 private:
@@ -34,6 +39,9 @@ private:
     void setProposedParameterValue();
     void revertToOldParameterValue();
     
+    // Whether the proposal can be accepted whatever its likelihood
+    bool canBeAccepted();
+
     double computeLogPriorRatio();
     double computeLogQRatio();
     
@@ -43,6 +51,10 @@ private:
     Prior& _prior;
     
     
+    int _bin;
+    bool _canBeAccepted;
+    double _logPriorRatio;
+    double _logQRatio;
     double _currentParameterValue;
     double _proposedParameterValue;
     double _currentLogLikelihood;
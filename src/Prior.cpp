@@ -9,46 +9,47 @@
 Prior::Prior(Random& random, Settings* settings) : _random(random)
 {
     std::string modelType = settings->get("modeltype");
+    const PriorSettings& priors = settings->priorSettings();
 
     if (modelType == "speciationextinction") {
-        _lambdaInit0 = settings->get<double>("lambdaInit0");
-        _muInit0 = settings->get<double>("muInit0");
-        _lambdaShift0 = settings->get<double>("lambdaShift0");
-        _muShift0 = settings->get<double>("muShift0");
-        _lambdaInitPrior = settings->get<double>("lambdaInitPrior");
-        _muInitPrior = settings->get<double>("muInitPrior");
-        _lambdaShiftPrior = settings->get<double>("lambdaShiftPrior");
-        _muShiftPrior = settings->get<double>("muShiftPrior");
-        _lambdaInitRootPrior = settings->get<double>("lambdaInitRootPrior");
-        _muInitRootPrior = settings->get<double>("muInitRootPrior");
-        _lambdaShiftRootPrior = settings->get<double>("lambdaShiftRootPrior");
-        _muShiftRootPrior = settings->get<double>("muShiftRootPrior");
-        _lambdaIsTimeVariablePrior =
-            settings->get<double>("lambdaIsTimeVariablePrior");
-        _updateRateLambda0 = settings->get<double>("updateRateLambda0");
-        _updateRateMu0 = settings->get<double>("updateRateMu0");
-        _updateRateLambdaShift = settings->get<double>("updateRateLambdaShift");
-        _updateRateMuShift = settings->get<double>("updateRateMuShift");
+        const SpExSettings& spEx = settings->spExSettings();
+        _lambdaInit0 = spEx.lambdaInit0;
+        _muInit0 = spEx.muInit0;
+        _lambdaShift0 = spEx.lambdaShift0;
+        _muShift0 = spEx.muShift0;
+        _lambdaInitPrior = priors.lambdaInitPrior;
+        _muInitPrior = priors.muInitPrior;
+        _lambdaShiftPrior = priors.lambdaShiftPrior;
+        _muShiftPrior = priors.muShiftPrior;
+        _lambdaInitRootPrior = priors.lambdaInitRootPrior;
+        _muInitRootPrior = priors.muInitRootPrior;
+        _lambdaShiftRootPrior = priors.lambdaShiftRootPrior;
+        _muShiftRootPrior = priors.muShiftRootPrior;
+        _lambdaIsTimeVariablePrior = priors.lambdaIsTimeVariablePrior;
+        _updateRateLambda0 = spEx.updateRateLambda0;
+        _updateRateMu0 = spEx.updateRateMu0;
+        _updateRateLambdaShift = spEx.updateRateLambdaShift;
+        _updateRateMuShift = spEx.updateRateMuShift;
         
         /***************************/
-        _preservationRatePrior = settings->get<double>("preservationRatePrior");
+        _preservationRatePrior = priors.preservationRatePrior;
         
         
         
     } else if (modelType == "trait") {
-        _betaInit = settings->get<double>("betaInit");
-        _betaShiftInit = settings->get<double>("betaShiftInit");
-        _betaInitPrior = settings->get<double>("betaInitPrior");
-        _betaShiftPrior = settings->get<double>("betaShiftPrior");
-        _betaInitRootPrior = settings->get<double>("betaInitRootPrior");
-        _betaShiftRootPrior = settings->get<double>("betaShiftRootPrior");
-        _betaIsTimeVariablePrior =
-            settings->get<double>("betaIsTimeVariablePrior");
-        _updateRateBeta0 = settings->get<double>("updateRateBeta0");
-        _updateRateBetaShift = settings->get<double>("updateRateBetaShift");
+        const TraitSettings& trait = settings->traitSettings();
+        _betaInit = trait.betaInit;
+        _betaShiftInit = trait.betaShiftInit;
+        _betaInitPrior = priors.betaInitPrior;
+        _betaShiftPrior = priors.betaShiftPrior;
+        _betaInitRootPrior = priors.betaInitRootPrior;
+        _betaShiftRootPrior = priors.betaShiftRootPrior;
+        _betaIsTimeVariablePrior = priors.betaIsTimeVariablePrior;
+        _updateRateBeta0 = trait.updateRateBeta0;
+        _updateRateBetaShift = trait.updateRateBetaShift;
     }
 
-    _poissonRatePrior = settings->get<double>("poissonRatePrior");
+    _poissonRatePrior = priors.poissonRatePrior;
 }
 
 
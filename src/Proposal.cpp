@@ -10,3 +10,32 @@ double Proposal::weight() const
 {
     return _weight;
 }
+
+
+std::string Proposal::scaleName() const
+{
+    return "";
+}
+
+
+double Proposal::scale() const
+{
+    return 0.0;
+}
+
+
+void Proposal::setScale(double)
+{
+}
+
+
+bool Proposal::lastProposalUsedScale() const
+{
+    return true;
+}
+
+
+bool Proposal::needsLikelihood() const
+{
+    return false;
+}
@@ -2,6 +2,9 @@
 #define PROPOSAL_H
 
 
+#include <string>
+
+
 class Proposal
 {
 public:
@@ -16,6 +19,23 @@ public:
 
     double weight() const;
 
+    // Step size of the proposals that autotune adjusts. scaleName() is
+    // the setting the scale is read from (empty if the proposal has no
+    // scale), and scale() is in the units of that setting.
+    virtual std::string scaleName() const;
+    virtual double scale() const;
+    virtual void setScale(double scale);
+
+    // Whether the last proposal depended on the scale
+    // (e.g., a global event move does not)
+    virtual bool lastProposalUsedScale() const;
+
+    // Whether acceptanceRatio() computes the likelihood of the proposed
+    // state with Model::computeLogLikelihood(), so it can be computed
+    // beforehand together with other chains'. False for a proposal that
+    // is rejected whatever its likelihood.
+    virtual bool needsLikelihood() const;
+
 protected:
 
     double _weight;
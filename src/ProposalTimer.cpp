@@ -0,0 +1,36 @@
+#include "ProposalTimer.h"
+
+
+ProposalTimer::ProposalTimer() :
+    _totalLikelihoodEvaluations(0), _currentProposal(-1),
+    _timedTotal(Clock::duration::zero())
+{
+}
+
+
+void ProposalTimer::addProposal()
+{
+    _proposalCounts.push_back(0);
+    _likelihoodEvaluations.push_back(0);
+    _skippedLikelihoodEvaluations.push_back(0);
+    _phaseTimes.push_back(std::vector<Clock::duration>
+        (NumberOfPhases, Clock::duration::zero()));
+}
+
+
+double ProposalTimer::seconds(int proposal, Phase phase) const
+{
+    return std::chrono::duration_cast<std::chrono::duration<double> >
+        (_phaseTimes[proposal][phase]).count();
+}
+
+
+long long ProposalTimer::totalSkippedLikelihoodEvaluations() const
+{
+    long long total = 0;
+    for (long long skipped : _skippedLikelihoodEvaluations) {
+        total += skipped;
+    }
+
+    return total;
+}
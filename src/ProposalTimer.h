@@ -0,0 +1,200 @@
+#ifndef PROPOSAL_TIMER_H
+#define PROPOSAL_TIMER_H
+
+
+#include <vector>
+#include <chrono>
+
+
+// Accumulates the wall time spent in each phase of each proposal type,
+// and the number of likelihood evaluations. Time is only recorded while
+// a proposal is active (between beginProposal() and endProposal()), so
+// likelihoods and priors computed by the data writers are not counted.
+// Nested phases are exclusive: the likelihood time of a proposal is not
+// also counted as propose time. Likelihood evaluations that proposals
+// skip, because the proposal is rejected whatever the likelihood, are
+// also counted.
+
+class ProposalTimer
+{
+public:
+
+    typedef std::chrono::steady_clock Clock;
+
+    enum Phase
+    {
+        Propose,
+        Likelihood,
+        Prior,
+        AcceptReject,
+        NumberOfPhases
+    };
+
+    ProposalTimer();
+
+    void addProposal();
+
+    void beginProposal(int proposal);
+    void endProposal();
+    bool isActive() const;
+
+    int numberOfProposals() const;
+    long long proposalCount(int proposal) const;
+    double seconds(int proposal, Phase phase) const;
+    long long likelihoodEvaluations(int proposal) const;
+
+    // Adds time spent for the current proposal outside of its phases
+    // (e.g., its share of a likelihood computed with other chains')
+    void addTime(Phase phase, Clock::duration duration);
+
+    void skipLikelihoodEvaluation();
+    long long skippedLikelihoodEvaluations(int proposal) const;
+    long long totalSkippedLikelihoodEvaluations() const;
+
+    // Counted whether or not a proposal is active
+    long long totalLikelihoodEvaluations() const;
+
+private:
+
+    friend class ScopedPhaseTimer;
+
+    std::vector<long long> _proposalCounts;
+    std::vector<long long> _likelihoodEvaluations;
+    std::vector<long long> _skippedLikelihoodEvaluations;
+    std::vector<std::vector<Clock::duration> > _phaseTimes;
+
+    long long _totalLikelihoodEvaluations;
+
+    int _currentProposal;
+
+    // Total time of all timed phases so far, used to subtract
+    // the time of nested phases from the enclosing phase
+    Clock::duration _timedTotal;
+};
+
+
+// Times one phase for as long as it is in scope
+
+class ScopedPhaseTimer
+{
+public:
+
+    ScopedPhaseTimer(ProposalTimer& timer, ProposalTimer::Phase phase);
+    ~ScopedPhaseTimer();
+
+private:
+
+    ProposalTimer& _timer;
+    ProposalTimer::Phase _phase;
+
+    // Whether a proposal was active when this phase started
+    bool _active;
+
+    ProposalTimer::Clock::time_point _start;
+    ProposalTimer::Clock::duration _timedTotalAtStart;
+};
+
+
+inline void ProposalTimer::beginProposal(int proposal)
+{
+    _currentProposal = proposal;
+    _proposalCounts[proposal]++;
+}
+
+
+inline void ProposalTimer::endProposal()
+{
+    _currentProposal = -1;
+}
+
+
+inline bool ProposalTimer::isActive() const
+{
+    return _currentProposal >= 0;
+}
+
+
+inline int ProposalTimer::numberOfProposals() const
+{
+    return (int)_proposalCounts.size();
+}
+
+
+inline long long ProposalTimer::proposalCount(int proposal) const
+{
+    return _proposalCounts[proposal];
+}
+
+
+inline long long ProposalTimer::likelihoodEvaluations(int proposal) const
+{
+    return _likelihoodEvaluations[proposal];
+}
+
+
+inline void ProposalTimer::addTime(Phase phase, Clock::duration duration)
+{
+    if (isActive()) {
+        _phaseTimes[_currentProposal][phase] += duration;
+    }
+}
+
+
+inline void ProposalTimer::skipLikelihoodEvaluation()
+{
+    if (isActive()) {
+        _skippedLikelihoodEvaluations[_currentProposal]++;
+    }
+}
+
+
+inline long long ProposalTimer::skippedLikelihoodEvaluations
+    (int proposal) const
+{
+    return _skippedLikelihoodEvaluations[proposal];
+}
+
+
+inline long long ProposalTimer::totalLikelihoodEvaluations() const
+{
+    return _totalLikelihoodEvaluations;
+}
+
+
+inline ScopedPhaseTimer::ScopedPhaseTimer
+    (ProposalTimer& timer, ProposalTimer::Phase phase) :
+        _timer(timer), _phase(phase), _active(timer.isActive())
+{
+    if (_phase == ProposalTimer::Likelihood) {
+        _timer._totalLikelihoodEvaluations++;
+    }
+
+    if (_active) {
+        _start = ProposalTimer::Clock::now();
+        _timedTotalAtStart = _timer._timedTotal;
+    }
+}
+
+
+inline ScopedPhaseTimer::~ScopedPhaseTimer()
+{
+    if (!_active) {
+        return;
+    }
+
+    ProposalTimer::Clock::duration elapsed =
+        ProposalTimer::Clock::now() - _start;
+    ProposalTimer::Clock::duration nested =
+        _timer._timedTotal - _timedTotalAtStart;
+
+    int proposal = _timer._currentProposal;
+    _timer._phaseTimes[proposal][_phase] += elapsed - nested;
+    _timer._timedTotal = _timedTotalAtStart + elapsed;
+
+    if (_phase == ProposalTimer::Likelihood) {
+        _timer._likelihoodEvaluations[proposal]++;
+    }
+}
+
+
+#endif
@@ -0,0 +1,130 @@
+#include "ProposalTuner.h"
+#include "Proposal.h"
+#include "ProposalTimer.h"
+#include "TypedSettings.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define AUTOTUNE_BATCH_SIZE 50
+
+#define ADAPTIVE_WEIGHTS_PERIOD 1000
+#define ADAPTIVE_WEIGHTS_MAX_FACTOR 4.0
+
+
+ProposalTuner::ProposalTuner(const ProposalSettings& settings,
+    const ProposalTimer& timer) : _timer(timer),
+    _autotune(settings.autotune),
+    _adaptWeights(settings.adaptProposalWeights),
+    _generations(settings.autotuneGenerations),
+    _targetAcceptance(settings.autotuneTargetAcceptance), _generation(0),
+    _weightsChanged(false)
+{
+}
+
+
+void ProposalTuner::addProposal(double weight)
+{
+    _batchProposals.push_back(0);
+    _batchAccepts.push_back(0);
+    _batches.push_back(0);
+
+    _initialWeights.push_back(weight);
+    _weights.push_back(weight);
+    _acceptCounts.push_back(0);
+}
+
+
+void ProposalTuner::recordOutcome(int index, Proposal& proposal,
+    bool accepted)
+{
+    _weightsChanged = false;
+
+    if (!isTuning()) {
+        return;
+    }
+
+    _generation++;
+
+    if (_autotune) {
+        tuneScale(index, proposal, accepted);
+    }
+
+    if (_adaptWeights) {
+        if (accepted) {
+            _acceptCounts[index]++;
+        }
+
+        if (_generation % ADAPTIVE_WEIGHTS_PERIOD == 0) {
+            adaptWeights();
+        }
+    }
+}
+
+
+void ProposalTuner::tuneScale(int index, Proposal& proposal, bool accepted)
+{
+    if (proposal.scaleName().empty() || !proposal.lastProposalUsedScale()) {
+        return;
+    }
+
+    _batchProposals[index]++;
+    if (accepted) {
+        _batchAccepts[index]++;
+    }
+
+    if (_batchProposals[index] < AUTOTUNE_BATCH_SIZE) {
+        return;
+    }
+
+    _batches[index]++;
+
+    double acceptance = (double)_batchAccepts[index] / _batchProposals[index];
+    double step = (acceptance - _targetAcceptance) /
+        std::sqrt((double)_batches[index]);
+    proposal.setScale(proposal.scale() * std::exp(step));
+
+    _batchProposals[index] = 0;
+    _batchAccepts[index] = 0;
+}
+
+
+void ProposalTuner::adaptWeights()
+{
+    int n = (int)_weights.size();
+
+    // Accepted proposals per second of each type that has been timed
+    std::vector<double> acceptsPerSecond(n, -1.0);
+    double sumWeightedRates = 0.0;
+    double sumWeights = 0.0;
+
+    for (int i = 0; i < n; i++) {
+        double seconds = 0.0;
+        for (int phase = 0; phase < ProposalTimer::NumberOfPhases; phase++) {
+            seconds += _timer.seconds(i, (ProposalTimer::Phase)phase);
+        }
+
+        if (_initialWeights[i] > 0.0 && seconds > 0.0) {
+            acceptsPerSecond[i] = _acceptCounts[i] / seconds;
+            sumWeightedRates += _initialWeights[i] * acceptsPerSecond[i];
+            sumWeights += _initialWeights[i];
+        }
+    }
+
+    if (sumWeightedRates <= 0.0) {
+        return;
+    }
+
+    double meanRate = sumWeightedRates / sumWeights;
+    for (int i = 0; i < n; i++) {
+        if (acceptsPerSecond[i] < 0.0) {
+            continue;
+        }
+
+        double factor = std::min(std::max(acceptsPerSecond[i] / meanRate,
+            1.0 / ADAPTIVE_WEIGHTS_MAX_FACTOR), ADAPTIVE_WEIGHTS_MAX_FACTOR);
+        _weights[i] = _initialWeights[i] * factor;
+    }
+
+    _weightsChanged = true;
+}
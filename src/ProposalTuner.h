@@ -0,0 +1,94 @@
+#ifndef PROPOSAL_TUNER_H
+#define PROPOSAL_TUNER_H
+
+
+#include <vector>
+
+class Proposal;
+class ProposalTimer;
+struct ProposalSettings;
+
+
+// Adapts the proposals during the first autotuneGenerations generations,
+// after which they are left fixed, so the samples of those generations
+// are to be discarded as burn-in.
+//
+// With autotune = 1, the scale of each proposal is adapted toward an
+// acceptance rate of autotuneTargetAcceptance. After every
+// AUTOTUNE_BATCH_SIZE proposals of a type that depended on its scale,
+// the log of the scale is moved by the difference between the batch
+// acceptance rate and the target, divided by the square root of the
+// number of batches of that type so far, so the changes shrink as tuning
+// proceeds.
+//
+// With adaptProposalWeights = 1, the weight (selection probability) of
+// each proposal type is adapted toward more accepted proposals per second
+// of computation. Every ADAPTIVE_WEIGHTS_PERIOD generations, the weight
+// from the settings is multiplied by the number of accepted proposals of
+// the type per second spent in them (measured by the model's
+// ProposalTimer), relative to the weighted mean over all types, within
+// a factor of ADAPTIVE_WEIGHTS_MAX_FACTOR so every type is still used.
+
+class ProposalTuner
+{
+public:
+
+    ProposalTuner(const ProposalSettings& settings,
+        const ProposalTimer& timer);
+
+    void addProposal(double weight);
+
+    // Records whether the last proposal (the model's proposal index)
+    // was accepted
+    void recordOutcome(int index, Proposal& proposal, bool accepted);
+
+    bool isTuning() const;
+
+    // Whether the last recordOutcome() changed the weights
+    bool weightsChanged() const;
+    const std::vector<double>& weights() const;
+
+private:
+
+    void tuneScale(int index, Proposal& proposal, bool accepted);
+    void adaptWeights();
+
+    const ProposalTimer& _timer;
+
+    bool _autotune;
+    bool _adaptWeights;
+    long long _generations;
+    double _targetAcceptance;
+
+    long long _generation;
+
+    std::vector<int> _batchProposals;
+    std::vector<int> _batchAccepts;
+    std::vector<int> _batches;
+
+    std::vector<double> _initialWeights;
+    std::vector<double> _weights;
+    std::vector<long long> _acceptCounts;
+    bool _weightsChanged;
+};
+
+
+inline bool ProposalTuner::isTuning() const
+{
+    return (_autotune || _adaptWeights) && _generation < _generations;
+}
+
+
+inline bool ProposalTuner::weightsChanged() const
+{
+    return _weightsChanged;
+}
+
+
+inline const std::vector<double>& ProposalTuner::weights() const
+{
+    return _weights;
+}
+
+
+#endif
@@ -0,0 +1,34 @@
+#include "RandomStreams.h"
+
+#include <climits>
+
+
+RandomStreams::RandomStreams(unsigned long int masterSeed) :
+    _masterSeed(masterSeed)
+{
+}
+
+
+// Each component of the stream's identity is mixed in turn, so streams
+// that differ in any one component have unrelated seeds. The seed is in
+// [1, INT_MAX - 1], the range accepted by MbRandom.
+unsigned long int RandomStreams::seed
+    (int chainIndex, Purpose purpose, int threadIndex) const
+{
+    unsigned long long x = mix(_masterSeed);
+    x = mix(x ^ (unsigned long long)chainIndex);
+    x = mix(x ^ (unsigned long long)purpose);
+    x = mix(x ^ (unsigned long long)threadIndex);
+
+    return (unsigned long int)(x % (INT_MAX - 1)) + 1;
+}
+
+
+// SplitMix64 finalizer (Steele, Lea & Flood 2014)
+unsigned long long RandomStreams::mix(unsigned long long x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
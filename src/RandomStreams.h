@@ -0,0 +1,37 @@
+#ifndef RANDOM_STREAMS_H
+#define RANDOM_STREAMS_H
+
+
+// Derives the seed of each pseudorandom stream of a run from the run's
+// master seed and the stream's identity (chain index, purpose, and thread
+// index), instead of drawing seeds in turn from a master generator.
+// A stream therefore does not depend on how many other streams exist,
+// on the order in which they are created, or on the threads that run them.
+
+class RandomStreams
+{
+public:
+
+    enum Purpose
+    {
+        ChainStream,        // Proposals of a chain
+        ChainSwapStream,    // Chain swap proposals (one per run)
+        WorkerStream,       // Multiple-try workers of a chain
+        InheritanceStream   // Random descendant inheritance at nodes,
+                            // shared by every model of a run
+    };
+
+    RandomStreams(unsigned long int masterSeed);
+
+    unsigned long int seed(int chainIndex, Purpose purpose,
+        int threadIndex = 0) const;
+
+private:
+
+    static unsigned long long mix(unsigned long long x);
+
+    unsigned long long _masterSeed;
+};
+
+
+#endif
@@ -0,0 +1,153 @@
+#include "SamplingFractions.h"
+#include "Log.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+
+// Files already read, kept for the lifetime of the process
+std::mutex SamplingFractions::_loadedMutex;
+std::map<std::string, std::unique_ptr<SamplingFractions> >
+    SamplingFractions::_loaded;
+
+
+const SamplingFractions& SamplingFractions::load(const std::string& fileName)
+{
+    std::lock_guard<std::mutex> lock(_loadedMutex);
+
+    std::unique_ptr<SamplingFractions>& fractions = _loaded[fileName];
+    if (!fractions) {
+        fractions.reset(new SamplingFractions(fileName));
+    }
+
+    return *fractions;
+}
+
+
+void SamplingFractions::unloadAll()
+{
+    std::lock_guard<std::mutex> lock(_loadedMutex);
+    _loaded.clear();
+}
+
+
+SamplingFractions::SamplingFractions(const std::string& fileName)
+{
+    read(fileName);
+}
+
+
+void SamplingFractions::read(const std::string& fileName)
+{
+    std::ifstream infile(fileName.c_str());
+
+    if (!infile.good()) {
+        log(Error) << "Bad sampling fraction file.\n";
+        std::exit(1);
+    }
+
+    log() << "Reading sampling fractions from file <<" << fileName << ">>...\n";
+
+    std::string line;
+
+    // First number in file is sampling probability for "backbone" of the tree
+    std::getline(infile, line);
+    _backboneFraction = std::atof(line.c_str());
+
+    // std::atof returns 0.0 if the conversion fails
+    if (_backboneFraction == 0.0) {
+        log(Error) << "The first line of the sampling probability file\n"
+                   << "must be the global sampling probability (> 0.0).\n";
+        std::exit(1);
+    }
+
+    while (std::getline(infile, line)) {
+        std::vector<std::string> tokens = tokenize(line);
+
+        // Blank lines (such as at the end of the file) are ignored
+        if (tokens.empty()) {
+            continue;
+        }
+
+        if (tokens.size() < 3) {
+            log(Error) << "Sampling probability file is not formatted "
+                       << "properly.\nPlease see the documentation.\n";
+            std::exit(1);
+        }
+
+        const std::string& name = tokens[0];
+        const std::string& clade = tokens[1];
+        double fraction = std::atof(tokens[2].c_str());
+
+        if (fraction <= 0.0 || fraction > 1.0) {
+            log(Error) << "In line with species <<" << name << ">> and "
+                       << "family name\n<<" << clade << ">>, "
+                       << "sampling fraction must be greater than 0 and less\n"
+                       << "than or equal to 1. This error may also occur if\n"
+                       << "the input line is not formatted properly.\n";
+            std::exit(1);
+        }
+
+        addSpecies(name, clade, fraction);
+    }
+
+    std::cout << "Read a total of " << _speciesNames.size()
+              << " initial values.\n";
+}
+
+
+// A species listed more than once keeps its last line
+void SamplingFractions::addSpecies(const std::string& name,
+    const std::string& clade, double fraction)
+{
+    std::unordered_map<std::string, int>::const_iterator cladeIt =
+        _cladeIndices.find(clade);
+    if (cladeIt == _cladeIndices.end()) {
+        cladeIt = _cladeIndices.insert
+            (std::make_pair(clade, (int)_cladeNames.size())).first;
+        _cladeNames.push_back(clade);
+    }
+
+    Species species;
+    species.clade = cladeIt->second;
+    species.fraction = fraction;
+
+    std::pair<std::unordered_map<std::string, Species>::iterator, bool>
+        inserted = _species.insert(std::make_pair(name, species));
+    if (!inserted.second) {
+        log(Warning) << "The species <<" << name << ">> is listed more "
+                     << "than once in the sampling file;\nits last line "
+                     << "is used.\n";
+        inserted.first->second = species;
+        return;
+    }
+
+    _speciesNames.push_back(name);
+}
+
+
+const SamplingFractions::Species* SamplingFractions::findSpecies
+    (const std::string& name) const
+{
+    std::unordered_map<std::string, Species>::const_iterator it =
+        _species.find(name);
+    return (it != _species.end()) ? &it->second : NULL;
+}
+
+
+// Returns the whitespace-separated tokens of the line
+std::vector<std::string> SamplingFractions::tokenize(const std::string& line)
+{
+    const char* whitespace = " \t\r";
+    std::vector<std::string> tokens;
+
+    std::string::size_type start = line.find_first_not_of(whitespace);
+    while (start != std::string::npos) {
+        std::string::size_type end = line.find_first_of(whitespace, start);
+        tokens.push_back(line.substr(start, end - start));
+        start = line.find_first_not_of(whitespace, end);
+    }
+
+    return tokens;
+}
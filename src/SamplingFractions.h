@@ -0,0 +1,90 @@
+#ifndef SAMPLING_FRACTIONS_H
+#define SAMPLING_FRACTIONS_H
+
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <memory>
+#include <mutex>
+
+
+// The contents of a sampling fraction file (sampleProbsFilename): the
+// sampling probability of the backbone of the tree on the first line,
+// then one line per species with its name, the name of its clade and the
+// sampling fraction of the clade. The file is read and checked once per
+// process by load(); every chain's tree then looks up its tips by name.
+
+class SamplingFractions
+{
+public:
+
+    struct Species
+    {
+        int clade;              // Index into cladeNames()
+        double fraction;
+    };
+
+    // Reads the file the first time it is asked for (exits on a bad
+    // file) and returns the same object on later calls; safe to call
+    // from several threads
+    static const SamplingFractions& load(const std::string& fileName);
+
+    // Forgets the files read so far, so that load() reads them again
+    // (objects returned earlier must no longer be used)
+    static void unloadAll();
+
+    double backboneFraction() const;
+
+    // Returns NULL if the species is not in the file
+    const Species* findSpecies(const std::string& name) const;
+
+    const std::vector<std::string>& speciesNames() const;
+    const std::vector<std::string>& cladeNames() const;
+
+private:
+
+    SamplingFractions(const std::string& fileName);
+
+    void read(const std::string& fileName);
+    void addSpecies(const std::string& name,
+        const std::string& clade, double fraction);
+
+    static std::vector<std::string> tokenize(const std::string& line);
+
+    static std::mutex _loadedMutex;
+    static std::map<std::string, std::unique_ptr<SamplingFractions> >
+        _loaded;
+
+    double _backboneFraction;
+
+    std::unordered_map<std::string, Species> _species;
+    std::vector<std::string> _speciesNames;     // In file order
+
+    std::unordered_map<std::string, int> _cladeIndices;
+    std::vector<std::string> _cladeNames;
+};
+
+
+inline double SamplingFractions::backboneFraction() const
+{
+    return _backboneFraction;
+}
+
+
+inline const std::vector<std::string>&
+    SamplingFractions::speciesNames() const
+{
+    return _speciesNames;
+}
+
+
+inline const std::vector<std::string>&
+    SamplingFractions::cladeNames() const
+{
+    return _cladeNames;
+}
+
+
+#endif
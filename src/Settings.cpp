@@ -46,7 +46,8 @@ Settings::Settings(const std::string& controlFilename,
     checkAllOutputFilesAreWriteable();
     
     validateSettings();
-    
+
+    initializeTypedSettings(modelType);
 }
 
 
@@ -100,6 +101,9 @@ void Settings::initializeGlobalSettings()
     // General
     addParameter("modeltype", "speciationextinction");
     addParameter("treefile", "tree.txt");
+    addParameter("treeNumber", "1", NotRequired);
+    addParameter("multipleTrees", "0", NotRequired);
+    addParameter("numberOfConcurrentTrees", "1", NotRequired);
     addParameter("sampleFromPriorOnly", "0", NotRequired);
     addParameter("runMCMC", "0");
     addParameter("loadEventData", "0", NotRequired);
@@ -120,6 +124,8 @@ void Settings::initializeGlobalSettings()
     addParameter("numberOfChains", "1", NotRequired);
     addParameter("deltaT", "0.1", NotRequired);
     addParameter("swapPeriod", "1000", NotRequired);
+    addParameter("numberOfChainThreads", "0", NotRequired);
+    addParameter("numberOfChainLanes", "1", NotRequired);
     addParameter("chainSwapFileName", "chain_swap.txt", NotRequired);
 
     // Priors
@@ -133,7 +139,17 @@ void Settings::initializeGlobalSettings()
     addParameter("eventDataOutfile", "event_data.txt", NotRequired);
     addParameter("priorOutputFileName", "prior_probs.txt", NotRequired);
 
+    addParameter("branchRatesOutfile", "branch_rates.txt", NotRequired);
     addParameter("branchRatesWriteFreq", "0", NotRequired);
+
+    // Posterior summaries computed during the run
+    addParameter("summarySampleFreq", "0", NotRequired);
+    addParameter("summaryWriteFreq", "0", NotRequired);
+    addParameter("summaryBurnIn", "0.1", NotRequired);
+    addParameter("summaryNumberOfTimeBins", "100", NotRequired);
+    addParameter("branchSummaryOutfile", "branch_summary.txt", NotRequired);
+    addParameter("rateThroughTimeOutfile", "rate_through_time.txt",
+        NotRequired);
     addParameter("mcmcWriteFreq", "0");
     addParameter("eventDataWriteFreq", "0");
 
@@ -143,17 +159,32 @@ void Settings::initializeGlobalSettings()
 
     addParameter("acceptanceResetFreq", "1000", NotRequired);
 
+    // Convergence diagnostics and stopping rule
+    addParameter("convergenceBurnIn", "0.1", NotRequired);
+    addParameter("convergenceBufferSize", "2000", NotRequired);
+    addParameter("convergenceTargetESS", "0", NotRequired);
+    addParameter("convergenceMaxRhat", "1.01", NotRequired);
+
     // Parameter update rates
     addParameter("updateRateEventNumber", "0.0");
     addParameter("updateRateEventNumberForBranch", "0.0", NotRequired);
     addParameter("updateRateEventPosition", "0.0");
     addParameter("updateRateEventRate", "0.0");
     addParameter("initialNumberEvents", "0");
+    addParameter("multipleTryCandidates", "1", NotRequired);
 
-    // Other (TODO: Need to add documentation for these)
+    // Adaptive proposal scales and weights
     addParameter("autotune", "0", NotRequired);
+    addParameter("adaptProposalWeights", "0", NotRequired);
+    addParameter("autotuneGenerations", "100000", NotRequired);
+    addParameter("autotuneTargetAcceptance", "0.44", NotRequired);
+
+    // Other (TODO: Need to add documentation for these)
     addParameter("outputAcceptanceInfo", "0", NotRequired);
     addParameter("acceptanceInfoFileName", "acceptance_info.txt", NotRequired);
+    addParameter("outputTimingInfo", "0", NotRequired);
+    addParameter("timingInfoFileName", "timing_info.txt", NotRequired);
+    addParameter("timingInfoWriteFreq", "100000", NotRequired);
 
     // TODO: New params May 30 2014, need documented
     addParameter("maxNumberEvents", "5000", NotRequired);
@@ -162,6 +193,8 @@ void Settings::initializeGlobalSettings()
     addParameter("fastSimulatePrior_SampleFreq", "50", NotRequired);
     addParameter("fastSimulatePriorExperimental", "0", NotRequired);
     addParameter("fastSimulatePrior_BurnIn", "0.05", NotRequired);
+    addParameter("exactPriorShifts", "1", NotRequired);
+    addParameter("priorSimulationThreads", "0", NotRequired);
 
     // maxNumberEvents = for fastSimulatePriorExperimental, maximum number of events...
     // priorSims_intervalGenerations = number of generations per model pair
@@ -178,6 +211,7 @@ void Settings::initializeGlobalSettings()
     addParameter("preservationRateInit", "0", NotRequired);
     addParameter("observationTime", "-1", NotRequired);
     addParameter("numberOccurrences", "0", NotRequired);
+    addParameter("preservationBinsFilename", "", NotRequired);
     addParameter("updateRatePreservationRate", "-1", NotRequired);
     addParameter("updatePreservationRateScale", "1.0", NotRequired);
     addParameter("preservationRatePrior", "1.0", NotRequired);
@@ -239,6 +273,11 @@ void Settings::initializeSpeciationExtinctionSettings()
     addParameter("alwaysRecomputeE0", "0", NotRequired);
     
     addParameter("combineExtinctionAtNodes", "if_different", NotRequired);
+
+    // Delayed acceptance: screen event proposals with a likelihood
+    // computed on coarser segments before computing the exact one
+    addParameter("delayedAcceptance", "0", NotRequired);
+    addParameter("delayedAcceptanceSegLength", "0.1", NotRequired);
     
     
     /********************************************************/
@@ -368,6 +407,19 @@ void Settings::attachPrefixToOutputFiles()
         prefix = (it->second).value<std::string>();
     }
 
+    attachPrefixToOutputFiles(prefix);
+}
+
+
+void Settings::attachRunPrefix(const std::string& prefix)
+{
+    attachPrefixToOutputFiles(prefix);
+    checkAllOutputFilesAreWriteable();
+}
+
+
+void Settings::attachPrefixToOutputFiles(const std::string& prefix)
+{
     // Create an array of the parameters that need to be prefixed
     std::string paramsToPrefix[NumberOfParamsToPrefix] =
         { "runInfoFilename",
@@ -377,6 +429,10 @@ void Settings::attachPrefixToOutputFiles()
           "priorOutputFileName",
           "acceptanceInfoFileName",
           "chainSwapFileName",
+          "timingInfoFileName",
+          "branchRatesOutfile",
+          "branchSummaryOutfile",
+          "rateThroughTimeOutfile",
           "lambdaOutfile",
           "muOutfile",
           "betaOutfile" };
@@ -456,6 +512,17 @@ bool Settings::anyOutputFileExists() const
         return true;
     }
 
+    if (get<int>("branchRatesWriteFreq") > 0 &&
+            fileExists(get("branchRatesOutfile"))) {
+        return true;
+    }
+
+    if (get<int>("summarySampleFreq") > 0 &&
+            (fileExists(get("branchSummaryOutfile")) ||
+             fileExists(get("rateThroughTimeOutfile")))) {
+        return true;
+    }
+
     if (get<bool>("writeMeanBranchLengthTrees")) {
         // Speciation/extinction output files
         if (get("modeltype") == "speciationextinction") {
@@ -565,6 +632,14 @@ void Settings::exitWithErrorDuplicateParameter(const std::string& param) const
 }
 
 
+void Settings::exitWithErrorInvalidValue(const std::string& name) const
+{
+    log(Error) << "Invalid value for parameter " << name << ".\n"
+               << "Fix by correcting its value in the control file.\n";
+    std::exit(1);
+}
+
+
 void Settings::exitWithErrorOutputFileExists() const
 {
     log(Error) << "Analysis is set to not overwrite files.\n"
@@ -579,9 +654,10 @@ void Settings::set(const std::string& name, const std::string& value)
 {
     ParameterMap::iterator it = _parameters.find(name);
     if (it != _parameters.end()) {
-        
         (it->second).setStringValue(value);
-        
+
+        // Keep the typed settings in step with the parameter
+        initializeTypedSettings(get("modeltype"));
     }
 }
 
@@ -616,10 +692,170 @@ void Settings::validateSettings(void)
 }
 
 
+void Settings::initializeTypedSettings(const std::string& modelType)
+{
+    _mcmcSettings.numberOfGenerations = get<int>("numberOfGenerations");
+    _mcmcSettings.numberOfChains = get<int>("numberOfChains");
+    _mcmcSettings.deltaT = get<double>("deltaT");
+    _mcmcSettings.swapPeriod = get<int>("swapPeriod");
+    _mcmcSettings.numberOfChainThreads = get<int>("numberOfChainThreads");
+    if (_mcmcSettings.numberOfChainThreads < 0) {
+        exitWithErrorInvalidValue("numberOfChainThreads");
+    }
+    _mcmcSettings.numberOfChainLanes = get<int>("numberOfChainLanes");
+    if (_mcmcSettings.numberOfChainLanes < 1) {
+        exitWithErrorInvalidValue("numberOfChainLanes");
+    }
+    _mcmcSettings.acceptanceResetFreq = get<int>("acceptanceResetFreq");
+
+    _modelSettings.sampleFromPriorOnly = get<bool>("sampleFromPriorOnly");
+    _modelSettings.validateEventConfiguration =
+        get<bool>("validateEventConfiguration");
+    _modelSettings.loadEventData = get<bool>("loadEventData");
+    _modelSettings.eventDataInfile = get("eventDataInfile");
+    _modelSettings.initialNumberEvents = get<int>("initialNumberEvents");
+    _modelSettings.multipleTryCandidates = get<int>("multipleTryCandidates");
+    if (_modelSettings.multipleTryCandidates < 1) {
+        exitWithErrorInvalidValue("multipleTryCandidates");
+    }
 
+    _proposalSettings.updateRateEventNumber =
+        get<double>("updateRateEventNumber");
+    _proposalSettings.updateRateEventNumberForBranch =
+        get<double>("updateRateEventNumberForBranch");
+    _proposalSettings.updateRateEventPosition =
+        get<double>("updateRateEventPosition");
+    _proposalSettings.updateRateEventRate = get<double>("updateRateEventRate");
+    _proposalSettings.updateEventLocationScale =
+        get<double>("updateEventLocationScale");
+    _proposalSettings.updateEventRateScale =
+        get<double>("updateEventRateScale");
+    _proposalSettings.localGlobalMoveRatio =
+        get<double>("localGlobalMoveRatio");
+    _proposalSettings.autotune = get<bool>("autotune");
+    _proposalSettings.adaptProposalWeights =
+        get<bool>("adaptProposalWeights");
+    _proposalSettings.autotuneGenerations = get<int>("autotuneGenerations");
+    if (_proposalSettings.autotuneGenerations < 0) {
+        exitWithErrorInvalidValue("autotuneGenerations");
+    }
+    _proposalSettings.autotuneTargetAcceptance =
+        get<double>("autotuneTargetAcceptance");
+    if (_proposalSettings.autotuneTargetAcceptance <= 0.0 ||
+        _proposalSettings.autotuneTargetAcceptance >= 1.0) {
+        exitWithErrorInvalidValue("autotuneTargetAcceptance");
+    }
 
+    _priorSettings = PriorSettings();
+    _priorSettings.poissonRatePrior = get<double>("poissonRatePrior");
+    _priorSettings.preservationRatePrior = get<double>("preservationRatePrior");
 
+    _spExSettings = SpExSettings();
+    _traitSettings = TraitSettings();
 
+    if (modelType == "speciationextinction") {
+        initializeSpeciationExtinctionTypedSettings();
+    } else if (modelType == "trait") {
+        initializeTraitTypedSettings();
+    }
+}
 
 
+void Settings::initializeSpeciationExtinctionTypedSettings()
+{
+    _priorSettings.lambdaInitPrior = get<double>("lambdaInitPrior");
+    _priorSettings.lambdaShiftPrior = get<double>("lambdaShiftPrior");
+    _priorSettings.muInitPrior = get<double>("muInitPrior");
+    _priorSettings.muShiftPrior = get<double>("muShiftPrior");
+    _priorSettings.lambdaInitRootPrior = get<double>("lambdaInitRootPrior");
+    _priorSettings.lambdaShiftRootPrior = get<double>("lambdaShiftRootPrior");
+    _priorSettings.muInitRootPrior = get<double>("muInitRootPrior");
+    _priorSettings.muShiftRootPrior = get<double>("muShiftRootPrior");
+    _priorSettings.lambdaIsTimeVariablePrior =
+        get<double>("lambdaIsTimeVariablePrior");
+
+    SpExSettings& s = _spExSettings;
+
+    s.lambdaInit0 = get<double>("lambdaInit0");
+    s.lambdaShift0 = get<double>("lambdaShift0");
+    s.muInit0 = get<double>("muInit0");
+    s.muShift0 = get<double>("muShift0");
+
+    s.updateRateLambda0 = get<double>("updateRateLambda0");
+    s.updateRateLambdaShift = get<double>("updateRateLambdaShift");
+    s.updateRateMu0 = get<double>("updateRateMu0");
+    s.updateRateMuShift = get<double>("updateRateMuShift");
+    s.updateRateLambdaTimeMode = get<double>("updateRateLambdaTimeMode");
+
+    s.updateLambdaInitScale = get<double>("updateLambdaInitScale");
+    s.updateLambdaShiftScale = get<double>("updateLambdaShiftScale");
+    s.updateMuInitScale = get<double>("updateMuInitScale");
+    s.updateMuShiftScale = get<double>("updateMuShiftScale");
+
+    s.segLength = get<double>("segLength");
+    s.extinctionProbMax = get<double>("extinctionProbMax");
+
+    s.conditionOnSurvival = get<int>("conditionOnSurvival");
+    if (s.conditionOnSurvival < -1 || s.conditionOnSurvival > 1) {
+        exitWithErrorInvalidValue("conditionOnSurvival");
+    }
 
+    s.alwaysRecomputeE0 = get<bool>("alwaysRecomputeE0");
+
+    const std::string& combine = get("combineExtinctionAtNodes");
+    if (combine == "random") {
+        s.combineExtinctionAtNodes = RandomDescendant;
+    } else if (combine == "if_different") {
+        s.combineExtinctionAtNodes = IfDifferent;
+    } else if (combine == "favor_shift") {
+        s.combineExtinctionAtNodes = FavorShift;
+    } else if (combine == "left") {
+        s.combineExtinctionAtNodes = LeftDescendant;
+    } else if (combine == "right") {
+        s.combineExtinctionAtNodes = RightDescendant;
+    } else {
+        exitWithErrorInvalidValue("combineExtinctionAtNodes");
+    }
+
+    s.delayedAcceptance = get<bool>("delayedAcceptance");
+    s.delayedAcceptanceSegLength = get<double>("delayedAcceptanceSegLength");
+    if (s.delayedAcceptance && s.delayedAcceptanceSegLength <= 0.0) {
+        exitWithErrorInvalidValue("delayedAcceptanceSegLength");
+    }
+
+    s.preservationRateInit = get<double>("preservationRateInit");
+    s.observationTime = get<double>("observationTime");
+    s.numberOccurrences = get<int>("numberOccurrences");
+    s.preservationBinsFilename = get("preservationBinsFilename");
+    s.updateRatePreservationRate = get<double>("updateRatePreservationRate");
+    s.updatePreservationRateScale =
+        get<double>("updatePreservationRateScale");
+}
+
+
+void Settings::initializeTraitTypedSettings()
+{
+    _priorSettings.betaInitPrior = get<double>("betaInitPrior");
+    _priorSettings.betaShiftPrior = get<double>("betaShiftPrior");
+    _priorSettings.betaInitRootPrior = get<double>("betaInitRootPrior");
+    _priorSettings.betaShiftRootPrior = get<double>("betaShiftRootPrior");
+    _priorSettings.betaIsTimeVariablePrior =
+        get<double>("betaIsTimeVariablePrior");
+
+    TraitSettings& s = _traitSettings;
+
+    s.betaInit = get<double>("betaInit");
+    s.betaShiftInit = get<double>("betaShiftInit");
+
+    s.updateRateBeta0 = get<double>("updateRateBeta0");
+    s.updateRateBetaShift = get<double>("updateRateBetaShift");
+    s.updateRateNodeState = get<double>("updateRateNodeState");
+    s.updateRateBetaTimeMode = get<double>("updateRateBetaTimeMode");
+
+    s.updateBetaInitScale = get<double>("updateBetaInitScale");
+    s.updateBetaShiftScale = get<double>("updateBetaShiftScale");
+    s.updateNodeStateScale = get<double>("updateNodeStateScale");
+
+    s.traitPriorMin = get<double>("traitPriorMin");
+    s.traitPriorMax = get<double>("traitPriorMax");
+}
@@ -2,6 +2,7 @@
 #define SETTINGS_H
 
 #include "SettingsParameter.h"
+#include "TypedSettings.h"
 #include "Log.h"
 
 #include <string>
@@ -27,10 +28,24 @@ public:
     std::string get(const std::string& name) const;
     template<typename T> T get(const std::string& name) const;
 
+    // Also updates mcmcSettings() and the other typed settings
     void set(const std::string& name, const std::string& value);
   
     void printCurrentSettings(std::ostream& out = std::cout) const;
 
+    // Gives one run of a batch its own output files, by prefixing them
+    // (after the outName prefix), and checks that they can be written
+    void attachRunPrefix(const std::string& prefix);
+
+    // Typed parameter groups, filled in once the settings are validated.
+    // Only the group matching the model type (SpEx or trait) is valid.
+    const MCMCSettings& mcmcSettings() const;
+    const ModelSettings& modelSettings() const;
+    const ProposalSettings& proposalSettings() const;
+    const PriorSettings& priorSettings() const;
+    const SpExSettings& spExSettings() const;
+    const TraitSettings& traitSettings() const;
+
 private:
 
     void readControlFile(const std::string& controlFilename);
@@ -49,6 +64,7 @@ private:
         DeprecationStatus deprecated = NotDeprecated);
 
     void attachPrefixToOutputFiles();
+    void attachPrefixToOutputFiles(const std::string& prefix);
     std::string attachPrefix
         (const std::string& prefix, const std::string& str) const;
     std::string extractDir(const std::string& path) const;
@@ -66,8 +82,9 @@ private:
     void exitWithErrorParameterIsDeprecated(const std::string& param) const;
     void exitWithErrorDuplicateParameter(const std::string& param) const;
     void exitWithErrorOutputFileExists() const;
+    void exitWithErrorInvalidValue(const std::string& name) const;
 
-    static const size_t NumberOfParamsToPrefix = 10;
+    static const size_t NumberOfParamsToPrefix = 14;
  
     // Parameters that settings knows about
     ParameterMap _parameters;
@@ -81,8 +98,17 @@ private:
     // function to handle the validation of settings for
     //   expanded oct 2015 options
     void validateSettings(void);
-    
-    
+
+    void initializeTypedSettings(const std::string& modelType);
+    void initializeSpeciationExtinctionTypedSettings();
+    void initializeTraitTypedSettings();
+
+    MCMCSettings _mcmcSettings;
+    ModelSettings _modelSettings;
+    ProposalSettings _proposalSettings;
+    PriorSettings _priorSettings;
+    SpExSettings _spExSettings;
+    TraitSettings _traitSettings;
 };
 
 
@@ -92,6 +118,42 @@ inline std::string Settings::get(const std::string& name) const
 }
 
 
+inline const MCMCSettings& Settings::mcmcSettings() const
+{
+    return _mcmcSettings;
+}
+
+
+inline const ModelSettings& Settings::modelSettings() const
+{
+    return _modelSettings;
+}
+
+
+inline const ProposalSettings& Settings::proposalSettings() const
+{
+    return _proposalSettings;
+}
+
+
+inline const PriorSettings& Settings::priorSettings() const
+{
+    return _priorSettings;
+}
+
+
+inline const SpExSettings& Settings::spExSettings() const
+{
+    return _spExSettings;
+}
+
+
+inline const TraitSettings& Settings::traitSettings() const
+{
+    return _traitSettings;
+}
+
+
 template<typename T>
 inline T Settings::get(const std::string& name) const
 {
@@ -0,0 +1,26 @@
+#include "SpExBranchRatesDataWriter.h"
+#include "BranchRatesDataWriter.h"
+#include "Node.h"
+
+class Settings;
+
+
+SpExBranchRatesDataWriter::SpExBranchRatesDataWriter(Settings& settings) :
+    BranchRatesDataWriter(settings)
+{
+}
+
+
+SpExBranchRatesDataWriter::~SpExBranchRatesDataWriter()
+{
+}
+
+
+double SpExBranchRatesDataWriter::branchRate(Node* node, int rate)
+{
+    if (rate == 0) {
+        return node->getMeanSpeciationRate();
+    } else {
+        return node->getMeanExtinctionRate();
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef SP_EX_BRANCH_RATES_DATA_WRITER_H
+#define SP_EX_BRANCH_RATES_DATA_WRITER_H
+
+
+#include "BranchRatesDataWriter.h"
+#include <string>
+
+class Settings;
+class Node;
+
+
+class SpExBranchRatesDataWriter : public BranchRatesDataWriter
+{
+public:
+
+    SpExBranchRatesDataWriter(Settings& settings);
+    virtual ~SpExBranchRatesDataWriter();
+
+private:
+
+    virtual int numberOfRates();
+    virtual std::string rateName(int rate);
+    virtual double branchRate(Node* node, int rate);
+};
+
+
+inline int SpExBranchRatesDataWriter::numberOfRates()
+{
+    return 2;
+}
+
+
+inline std::string SpExBranchRatesDataWriter::rateName(int rate)
+{
+    return rate == 0 ? "lambda" : "mu";
+}
+
+
+#endif
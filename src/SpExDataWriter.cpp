@@ -6,7 +6,8 @@ class Model;
 
 
 SpExDataWriter::SpExDataWriter(Settings &settings) :
-    ModelDataWriter(settings), _eventDataWriter(settings)
+    ModelDataWriter(settings), _eventDataWriter(settings),
+    _branchRatesDataWriter(settings), _posteriorSummaryDataWriter(settings)
 {
 }
 
@@ -15,4 +16,12 @@ void SpExDataWriter::writeData(int generation, Model& model)
 {
     ModelDataWriter::writeData(generation, model);
     _eventDataWriter.writeData(generation, model);
+    _branchRatesDataWriter.writeData(generation, model);
+    _posteriorSummaryDataWriter.writeData(generation, model);
+}
+
+
+void SpExDataWriter::writeFinalData(Model& model)
+{
+    _posteriorSummaryDataWriter.writeFinalData(model);
 }
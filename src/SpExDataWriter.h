@@ -4,6 +4,8 @@
 
 #include "ModelDataWriter.h"
 #include "SpExEventDataWriter.h"
+#include "SpExBranchRatesDataWriter.h"
+#include "SpExPosteriorSummaryDataWriter.h"
 
 class Settings;
 class Model;
@@ -16,10 +18,13 @@ public:
     SpExDataWriter(Settings &settings);
 
     virtual void writeData(int generation, Model& model);
+    virtual void writeFinalData(Model& model);
 
 protected:
 
     SpExEventDataWriter _eventDataWriter;
+    SpExBranchRatesDataWriter _branchRatesDataWriter;
+    SpExPosteriorSummaryDataWriter _posteriorSummaryDataWriter;
 };
 
 
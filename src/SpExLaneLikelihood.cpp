@@ -0,0 +1,325 @@
+#include "SpExLaneLikelihood.h"
+#include "SpExModel.h"
+#include "SpExBranchEvent.h"
+#include "Tree.h"
+#include "Node.h"
+#include "BranchHistory.h"
+#include "LaneMath.h"
+
+#include <cmath>
+
+
+SpExLaneLikelihood::SpExLaneLikelihood
+    (const std::vector<SpExModel*>& models) :
+        _models(models), _lanes((int)models.size())
+{
+    _paddedLanes = (_lanes + LIKELIHOOD_LANE_BLOCK - 1) /
+        LIKELIHOOD_LANE_BLOCK * LIKELIHOOD_LANE_BLOCK;
+}
+
+
+// Follows SpExModel::computeLogLikelihood() (without recomputing E0),
+// node by node in post order, which is the same in all the trees
+void SpExLaneLikelihood::compute(std::vector<double>& logLikelihoods)
+{
+    const std::vector<Node*>* postOrderNodes[MAX_LIKELIHOOD_LANES];
+    double logLikelihood[MAX_LIKELIHOOD_LANES];
+    double leftLogLikelihood[MAX_LIKELIHOOD_LANES];
+    double nodeLambda[MAX_LIKELIHOOD_LANES];
+
+    for (int l = 0; l < _lanes; l++) {
+        postOrderNodes[l] = &_models[l]->_tree->postOrderNodes();
+        for (Node* node : *postOrderNodes[l]) {
+            node->setHasDownstreamRateShift(false);
+        }
+
+        logLikelihood[l] = 0.0;
+    }
+
+    Node* root = _models[0]->_tree->getRoot();
+    int numNodes = (int)postOrderNodes[0]->size();
+
+    for (int i = 0; i < numNodes; i++) {
+        if (!(*postOrderNodes[0])[i]->isInternal()) {
+            continue;
+        }
+
+        for (int l = 0; l < _lanes; l++) {
+            _nodes[l] = (*postOrderNodes[l])[i];
+            _branches[l] = _nodes[l]->getLfDesc();
+        }
+
+        computeBranches();
+
+        for (int l = 0; l < _lanes; l++) {
+            leftLogLikelihood[l] = _branchLogLikelihood[l];
+            _branches[l] = _nodes[l]->getRtDesc();
+        }
+
+        computeBranches();
+
+        for (int l = 0; l < _lanes; l++) {
+            _models[l]->combineExtinctionAtNode(_nodes[l]);
+            logLikelihood[l] += leftLogLikelihood[l] + _branchLogLikelihood[l];
+        }
+
+        // Does not include root node, so it is conditioned
+        // on basal speciation event occurring
+        if (_nodes[0] != root) {
+            for (int l = 0; l < _lanes; l++) {
+                nodeLambda[l] = _nodes[l]->getNodeLambda();
+                _nodes[l]->setDinit(1.0);
+            }
+
+            for (int l = _lanes; l < _paddedLanes; l++) {
+                nodeLambda[l] = 1.0;
+            }
+
+            laneLog(nodeLambda, _y, _paddedLanes);
+
+            for (int l = 0; l < _lanes; l++) {
+                logLikelihood[l] += _y[l];
+            }
+        }
+    }
+
+    logLikelihoods.assign(logLikelihood, logLikelihood + _lanes);
+}
+
+
+// Follows SpExModel::computeSpExProbBranch() for the branches of all
+// lanes. Lanes that are done with their branch get segment parameters
+// that keep the lane arithmetic finite, and their results are ignored.
+void SpExLaneLikelihood::computeBranches()
+{
+    bool anyActive = false;
+
+    for (int l = 0; l < _lanes; l++) {
+        Node* node = _branches[l];
+
+        if (node->getBranchHistory()->getNumberOfBranchEvents() > 0) {
+            node->setHasDownstreamRateShift(true);
+        }
+
+        if (node->getHasDownstreamRateShift()) {
+            node->getAnc()->setHasDownstreamRateShift(true);
+        }
+
+        _D0[l] = node->getDinit();
+        _E0[l] = node->getEinit();
+        _psi[l] = _models[l]->_preservationRates[0];
+
+        _startTime[l] = node->getBrlen();
+        _endTime[l] = node->getBrlen();
+        _events[l] = static_cast<SpExBranchEvent*>
+            (node->getBranchHistory()->getLastEvent(node->getTime()));
+
+        _branchLogLikelihood[l] = 0.0;
+        _failed[l] = false;
+        _active[l] = _startTime[l] > 0;
+        anyActive = anyActive || _active[l];
+    }
+
+    for (int l = _lanes; l < _paddedLanes; l++) {
+        _D0[l] = 1.0;
+        _E0[l] = 0.0;
+        _psi[l] = 0.0;
+        _active[l] = false;
+        setIdleSegment(l);
+    }
+
+    while (anyActive) {
+        for (int l = 0; l < _lanes; l++) {
+            if (_active[l]) {
+                setSegment(l);
+            } else {
+                setIdleSegment(l);
+            }
+        }
+
+        computeMeanRates(Lambda);
+        computeMeanRates(Mu);
+        computeSpExProbs();
+
+        laneLog(_spProb, _y, _paddedLanes);
+
+        anyActive = false;
+        for (int l = 0; l < _lanes; l++) {
+            if (!_active[l]) {
+                continue;
+            }
+
+            if (_exProb[l] > _models[l]->_extinctionProbMax) {
+                _failed[l] = true;
+                _active[l] = false;
+                continue;
+            }
+
+            _branchLogLikelihood[l] += _y[l];
+            _D0[l] = 1.0;
+            _E0[l] = _exProb[l];
+
+            _endTime[l] = _startTime[l];
+            _active[l] = _startTime[l] > 0;
+            anyActive = anyActive || _active[l];
+        }
+    }
+
+    for (int l = 0; l < _lanes; l++) {
+        if (_failed[l]) {
+            _branchLogLikelihood[l] = -INFINITY;
+            continue;
+        }
+
+        SpExModel* model = _models[l];
+        Node* node = _branches[l];
+
+        node->setExtinctionEnd(_E0[l]);
+
+        if (node->getAnc() == model->_tree->getRoot() &&
+                model->_conditionOnSurvival) {
+            _branchLogLikelihood[l] -= std::log(1.0 - _E0[l]);
+        }
+    }
+}
+
+
+// Moves the lane to its next segment (toward the root), ending it at the
+// event that governs the current segment if the event is on it
+void SpExLaneLikelihood::setSegment(int l)
+{
+    SpExModel* model = _models[l];
+    Node* node = _branches[l];
+    SpExBranchEvent* be = _events[l];
+    double ancestorTime = node->getAnc()->getTime();
+
+    _startTime[l] -= model->_segLength;
+    if (_startTime[l] < 0) {
+        _startTime[l] = 0.0;
+    }
+
+    double absStartTime = ancestorTime + _startTime[l];
+    double absEndTime = ancestorTime + _endTime[l];
+
+    _rateInit[Lambda][l] = be->getLamInit();
+    _rateShift[Lambda][l] = be->getLamShift();
+    _rateInit[Mu][l] = be->getMuInit();
+    _rateShift[Mu][l] = be->getMuShift();
+
+    double eventTime = be->getAbsoluteTime();
+
+    if (eventTime >= absStartTime && eventTime < absEndTime &&
+            be != model->_rootEvent) {
+        _startTime[l] = eventTime - ancestorTime;
+        absStartTime = ancestorTime + _startTime[l];
+        _events[l] = static_cast<SpExBranchEvent*>
+            (node->getBranchHistory()->getLastEvent(be));
+    }
+
+    _eventTimeStart[l] = absStartTime - eventTime;
+    _eventTimeEnd[l] = absEndTime - eventTime;
+    _deltaT[l] = _endTime[l] - _startTime[l];
+}
+
+
+void SpExLaneLikelihood::setIdleSegment(int l)
+{
+    _rateInit[Lambda][l] = 1.0;
+    _rateShift[Lambda][l] = 0.0;
+    _rateInit[Mu][l] = 0.0;
+    _rateShift[Mu][l] = 0.0;
+    _eventTimeStart[l] = 0.0;
+    _eventTimeEnd[l] = 1.0;
+    _deltaT[l] = 1.0;
+}
+
+
+// SpExModel::computeMeanExponentialRateForInterval() for all lanes,
+// computing every case and selecting the one for the sign of the shift
+void SpExLaneLikelihood::computeMeanRates(Rate rate)
+{
+    const double* rateInit = _rateInit[rate];
+    const double* rateShift = _rateShift[rate];
+
+    bool anyShift = false;
+    for (int l = 0; l < _paddedLanes; l++) {
+        anyShift = anyShift || (rateShift[l] != 0.0);
+    }
+
+    // Without shifts, only the constant case is needed
+    if (!anyShift) {
+        for (int l = 0; l < _paddedLanes; l++) {
+            double deltaT = _eventTimeEnd[l] - _eventTimeStart[l];
+            _meanRate[rate][l] = (rateInit[l] * deltaT) / deltaT;
+        }
+
+        return;
+    }
+
+    // Both ends of the interval in one call, so there are more
+    // independent exponentials to overlap
+    double* xEnd = _x;
+    double* xStart = _x + _paddedLanes;
+    double* yEnd = _y;
+    double* yStart = _y + _paddedLanes;
+
+    for (int l = 0; l < _paddedLanes; l++) {
+        double shift = rateShift[l];
+        double exponent = (shift < 0) ? shift : -shift;
+        xEnd[l] = exponent * _eventTimeEnd[l];
+        xStart[l] = exponent * _eventTimeStart[l];
+    }
+
+    laneExp(_x, _y, 2 * _paddedLanes);
+
+    for (int l = 0; l < _paddedLanes; l++) {
+        double init = rateInit[l];
+        double shift = rateShift[l];
+        double deltaT = _eventTimeEnd[l] - _eventTimeStart[l];
+        double difference = yEnd[l] - yStart[l];
+
+        double decreasing = (init / shift) * difference;
+        double increasing =
+            init * (2 * deltaT + (1.0 / shift) * difference);
+        double constant = init * deltaT;
+
+        double integrated = (shift < 0) ? decreasing :
+            ((shift > 0) ? increasing : constant);
+        _meanRate[rate][l] = integrated / deltaT;
+    }
+}
+
+
+// SpExModel::computeSpExProb() for all lanes, with exp(c1 * deltaT)
+// as the inverse of exp(-c1 * deltaT)
+void SpExLaneLikelihood::computeSpExProbs()
+{
+    const double* lambda = _meanRate[Lambda];
+    const double* mu = _meanRate[Mu];
+
+    double c1[MAX_LIKELIHOOD_LANES];
+    double c2[MAX_LIKELIHOOD_LANES];
+
+    for (int l = 0; l < _paddedLanes; l++) {
+        double FF = lambda[l] - mu[l] - _psi[l];
+        c1[l] = std::fabs(std::sqrt(FF * FF + (4.0 * lambda[l] * _psi[l])));
+        c2[l] = (-1.0) * (FF - 2.0 * lambda[l] * (1.0 - _E0[l])) / c1[l];
+
+        _x[l] = (-1.0) * c1[l] * _deltaT[l];
+    }
+
+    laneExp(_x, _y, _paddedLanes);
+
+    for (int l = 0; l < _paddedLanes; l++) {
+        double A = _y[l] * (1.0 - c2[l]);
+        double B = c1[l] * (A - (1 + c2[l])) / (A + (1.0 + c2[l]));
+
+        _exProb[l] = (lambda[l] + mu[l] + _psi[l] + B) / (2.0 * lambda[l]);
+
+        double X = (1.0 / _y[l]) * (1.0 + c2[l]) * (1.0 + c2[l]);
+        double Y = _y[l] * (1.0 - c2[l]) * (1.0 - c2[l]);
+
+        _spProb[l] =
+            (4.0 * _D0[l]) / ((2.0 * (1 - (c2[l] * c2[l]))) + X + Y);
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef SP_EX_LANE_LIKELIHOOD_H
+#define SP_EX_LANE_LIKELIHOOD_H
+
+
+#include <vector>
+
+class SpExModel;
+class Node;
+class SpExBranchEvent;
+
+
+// Largest number of models whose likelihoods are computed in one pass
+#define MAX_LIKELIHOOD_LANES 16
+
+// The lane loops run over a multiple of this number of lanes (the extra
+// lanes are idle), so they are not slowed down by odd trip counts
+#define LIKELIHOOD_LANE_BLOCK 2
+
+
+// Computes the log-likelihoods of several SpExModels of the same tree
+// (e.g., the chains of a Metropolis-coupled run) in one traversal of the
+// tree, as SpExModel::computeLogLikelihood() does for each. Each model
+// has a lane in the arrays of segment rates and probabilities, and the
+// exp, log and other arithmetic for all lanes is done in loops that the
+// compiler vectorizes. The models walk the segments of each branch in
+// lockstep; a model with fewer segments on a branch idles until the
+// others are done. Results differ from computeLogLikelihood() only by
+// rounding. Models with paleo data are not supported.
+
+class SpExLaneLikelihood
+{
+public:
+
+    SpExLaneLikelihood(const std::vector<SpExModel*>& models);
+
+    // Computes the log-likelihoods of at most MAX_LIKELIHOOD_LANES models
+    void compute(std::vector<double>& logLikelihoods);
+
+private:
+
+    enum Rate
+    {
+        Lambda,
+        Mu,
+        NumberOfRates
+    };
+
+    void computeBranches();
+    void setSegment(int lane);
+    void setIdleSegment(int lane);
+    void computeMeanRates(Rate rate);
+    void computeSpExProbs();
+
+    const std::vector<SpExModel*>& _models;
+    int _lanes;
+    int _paddedLanes;
+
+    // Node and branch (to the node from its ancestor) of each lane
+    Node* _nodes[MAX_LIKELIHOOD_LANES];
+    Node* _branches[MAX_LIKELIHOOD_LANES];
+    SpExBranchEvent* _events[MAX_LIKELIHOOD_LANES];
+
+    // State of the segment walk on the current branches
+    bool _active[MAX_LIKELIHOOD_LANES];
+    bool _failed[MAX_LIKELIHOOD_LANES];
+    double _startTime[MAX_LIKELIHOOD_LANES];
+    double _endTime[MAX_LIKELIHOOD_LANES];
+    double _branchLogLikelihood[MAX_LIKELIHOOD_LANES];
+
+    // Current segment
+    double _rateInit[NumberOfRates][MAX_LIKELIHOOD_LANES];
+    double _rateShift[NumberOfRates][MAX_LIKELIHOOD_LANES];
+    double _meanRate[NumberOfRates][MAX_LIKELIHOOD_LANES];
+    double _eventTimeStart[MAX_LIKELIHOOD_LANES];
+    double _eventTimeEnd[MAX_LIKELIHOOD_LANES];
+    double _deltaT[MAX_LIKELIHOOD_LANES];
+    double _psi[MAX_LIKELIHOOD_LANES];
+    double _D0[MAX_LIKELIHOOD_LANES];
+    double _E0[MAX_LIKELIHOOD_LANES];
+    double _spProb[MAX_LIKELIHOOD_LANES];
+    double _exProb[MAX_LIKELIHOOD_LANES];
+
+    // Arguments and results of laneExp() and laneLog()
+    double _x[2 * MAX_LIKELIHOOD_LANES];
+    double _y[2 * MAX_LIKELIHOOD_LANES];
+};
+
+
+#endif
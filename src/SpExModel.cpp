@@ -1,6 +1,7 @@
 #include "SpExModel.h"
 #include "Model.h"
 #include "Random.h"
+#include "RandomStreams.h"
 #include "Settings.h"
 #include "Tree.h"
 #include "Node.h"
@@ -13,55 +14,61 @@
 #include "MuShiftProposal.h"
 #include "LambdaTimeModeProposal.h"
 #include "PreservationRateProposal.h"
+#include "PreservationBins.h"
+#include "SpExLaneLikelihood.h"
 
 #include "Log.h"
 #include "Prior.h"
 #include "Tools.h"
 
 #include <cstdlib>
+#include <algorithm>
 #include <cmath>
 #include <vector>
 #include <string>
 #include <fstream>
+#include <new>
+#include <memory>
    
 
 #define JUMP_VARIANCE_NORMAL 0.05
 
 #define NEVER_RECOMPUTE_E0
 
-SpExModel::SpExModel(Random& random, Settings& settings) :
+SpExModel::SpExModel(Random& random, const RandomStreams& streams,
+    Settings& settings) :
     Model(random, settings)
 {
+    const SpExSettings& spExSettings = _settings.spExSettings();
+    const ModelSettings& modelSettings = _settings.modelSettings();
+
     // Initial values
-    _lambdaInit0 = _settings.get<double>("lambdaInit0");
-    _lambdaShift0 = _settings.get<double>("lambdaShift0");
-    _muInit0 = _settings.get<double>("muInit0");
-    _muShift0 = _settings.get<double>("muShift0");
+    _lambdaInit0 = spExSettings.lambdaInit0;
+    _lambdaShift0 = spExSettings.lambdaShift0;
+    _muInit0 = spExSettings.muInit0;
+    _muShift0 = spExSettings.muShift0;
 
-    _alwaysRecomputeE0 = _settings.get<bool>("alwaysRecomputeE0");
+    _alwaysRecomputeE0 = spExSettings.alwaysRecomputeE0;
     
     
-    _combineExtinctionAtNodes = _settings.get<std::string>("combineExtinctionAtNodes");
+    _combineExtinctionAtNodes = spExSettings.combineExtinctionAtNodes;
     
     // Move this to a separate function at some point
 
-    if (_combineExtinctionAtNodes == "random"){
+    if (_combineExtinctionAtNodes == RandomDescendant){
         
-        // This is currently incompatible with MC3
-        // so throw exception if called:
-        if (_settings.get<int>("numberOfChains") != 1){
-            std::cout << "Can't use option 'random' for combineExtinctionAtNodes\n";
-            std::cout << "with Metropolis-coupled MCMC. Only single chain analysis";
-            std::cout << "\npermitted at present" << std::endl;
-            exit(0);
-        }
+        // The inheritance is part of the likelihood, so every chain
+        // (and multiple-try worker) of a run draws the same one
+        // from a shared stream; MC3 swaps then compare like with like
+        Random inheritanceRandom
+            (streams.seed(0, RandomStreams::InheritanceStream));
         
         int numNodes = _tree->getNumberOfNodes();
         const std::vector<Node*>& postOrderNodes = _tree->postOrderNodes();
         
         for (int i = 0; i < numNodes; i++) {
             Node* node = postOrderNodes[i];
-            bool left = _random.uniform() <= 0.5;
+            bool left = inheritanceRandom.uniform() <= 0.5;
             node->setInheritFromLeft(left);
             //std::cout << left << std::endl;
         }
@@ -74,27 +81,20 @@ SpExModel::SpExModel(Random& random, Settings& settings) :
     
     initializeHasPaleoData();
     
-    int cs = _settings.get<int>("conditionOnSurvival");
+    // Already validated by Settings to be -1, 0 or 1
+    int cs = spExSettings.conditionOnSurvival;
     if (cs == -1){
         if (_hasPaleoData){
             _conditionOnSurvival = false;
         }else{
             _conditionOnSurvival = true;
         }
-    }else if (cs == 0){
-        _conditionOnSurvival = false;
-    }else if (cs == 1){
-        _conditionOnSurvival = true;
     }else{
-        exitWithError("Invalid initial value for parameter <<conditionOnSurvivial>>");
+        _conditionOnSurvival = (cs == 1);
     }
 
-    // Initialize fossil preservation rate:
-    //      will not be relevant if this is not paleo data.
-    _preservationRate = _settings.get<double>("preservationRateInit");
-    
      
-    double timeVarPrior = _settings.get<double>("lambdaIsTimeVariablePrior");
+    double timeVarPrior = _settings.priorSettings().lambdaIsTimeVariablePrior;
     if (timeVarPrior == 0.0) {
         _initialLambdaIsTimeVariable = false;
         if (_lambdaShift0 != 0.0) {
@@ -112,15 +112,20 @@ SpExModel::SpExModel(Random& random, Settings& settings) :
         _lambdaIsTimeVariable = true;
     }
 
-    _sampleFromPriorOnly = _settings.get<bool>("sampleFromPriorOnly");
+    _sampleFromPriorOnly = modelSettings.sampleFromPriorOnly;
 
     // Parameter for splitting branch into pieces for numerical computation
     _segLength =
-        _settings.get<double>("segLength") * _tree->maxRootToTipLength();
+        spExSettings.segLength * _tree->maxRootToTipLength();
+
+    _delayedAcceptance = spExSettings.delayedAcceptance;
+    _surrogateSegLength = spExSettings.delayedAcceptanceSegLength *
+        _tree->maxRootToTipLength();
 
     
     //// Change from BranchEvent to SpExBranchEvent:
-    BranchEvent* x =  new SpExBranchEvent(_lambdaInit0, _lambdaShift0,
+    BranchEvent* x =  new (_eventPool.allocate(sizeof(SpExBranchEvent)))
+        SpExBranchEvent(_lambdaInit0, _lambdaShift0,
         _muInit0, _muShift0, _initialLambdaIsTimeVariable,
         _tree->getRoot(), _tree, _random, 0);
     
@@ -137,14 +142,14 @@ SpExModel::SpExModel(Random& random, Settings& settings) :
     _tree->setNodeSpeciationParameters();
     _tree->setNodeExtinctionParameters();
     
-    _extinctionProbMax = _settings.get<double>("extinctionProbMax");
+    _extinctionProbMax = spExSettings.extinctionProbMax;
 
     
     // Initialize by previous event histories (or from initial event number)
-    if (_settings.get<bool>("loadEventData")) {
-        initializeModelFromEventDataFile(_settings.get("eventDataInfile"));
+    if (modelSettings.loadEventData) {
+        initializeModelFromEventDataFile(modelSettings.eventDataInfile);
     } else {
-        int initialNumberOfEvents = _settings.get<int>("initialNumberEvents");
+        int initialNumberOfEvents = modelSettings.initialNumberEvents;
         for (int i = 0; i < initialNumberOfEvents; i++) {
             
             // TODO: this adds event to tree with parameters sampled from the prior
@@ -164,7 +169,7 @@ SpExModel::SpExModel(Random& random, Settings& settings) :
         }
     }
 
-    if (_settings.get<bool>("validateEventConfiguration")){
+    if (modelSettings.validateEventConfiguration){
         bool isValid = testEventConfigurationComprehensive();
         if (!isValid){
             std::cout << "\nInitial event configuration is invalid\n";
@@ -186,17 +191,21 @@ SpExModel::SpExModel(Random& random, Settings& settings) :
         log() << "Note that you have chosen to sample from prior only.\n";
 
     // Add proposals
-    _proposals.push_back
-        (new LambdaInitProposal(random, settings, *this, _prior));
-    _proposals.push_back
-        (new LambdaShiftProposal(random, settings, *this, _prior));
-    _proposals.push_back(new MuInitProposal(random, settings, *this, _prior));
-    _proposals.push_back(new MuShiftProposal(random, settings, *this, _prior));
-    _proposals.push_back(new LambdaTimeModeProposal(random, settings, *this));
+    addProposal(new LambdaInitProposal(random, settings, *this, _prior),
+        "lambdaInit");
+    addProposal(new LambdaShiftProposal(random, settings, *this, _prior),
+        "lambdaShift");
+    addProposal(new MuInitProposal(random, settings, *this, _prior),
+        "muInit");
+    addProposal(new MuShiftProposal(random, settings, *this, _prior),
+        "muShift");
+    addProposal(new LambdaTimeModeProposal(random, settings, *this),
+        "lambdaTimeMode");
 
     if (_hasPaleoData){
         // Cannot set this parameter unless you have paleo data....
-        _proposals.push_back(new PreservationRateProposal(random, settings, *this, _prior));
+        addProposal(new PreservationRateProposal
+            (random, settings, *this, _prior), "preservationRate");
     }
 
 
@@ -210,9 +219,27 @@ SpExModel::SpExModel(Random& random, Settings& settings) :
 // Sets the _hasPaleoData parameter.
 void SpExModel::initializeHasPaleoData()
 {
-    _numberOccurrences = _settings.get<int>("numberOccurrences");
+    const SpExSettings& spExSettings = _settings.spExSettings();
+    _numberOccurrences = spExSettings.numberOccurrences;
+
+    // With preservation bins, the occurrences are counted by bin
+    std::unique_ptr<PreservationBins> bins;
+    if (!spExSettings.preservationBinsFilename.empty()) {
+        bins.reset(new PreservationBins(spExSettings.preservationBinsFilename));
+
+        if (_numberOccurrences > 0 &&
+                _numberOccurrences != bins->totalOccurrences()) {
+            log(Error) << "numberOccurrences (" << _numberOccurrences
+                << ") differs from the number of occurrences\n"
+                << "in the preservation bin file ("
+                << bins->totalOccurrences() << ").\n";
+            std::exit(1);
+        }
+
+        _numberOccurrences = bins->totalOccurrences();
+    }
     
-    if (_numberOccurrences > 0 & _settings.get<double>("preservationRateInit") < 0.000000001){
+    if (_numberOccurrences > 0 & spExSettings.preservationRateInit < 0.000000001){
         std::cout << "Invalid initial settings " << std::endl;
         std::cout << " cannot have <<numberOccurrences>> greater than 0 and " << std::endl;
         std::cout << " <<preservationRateInit>> equal to zero. Check control file " << std::endl;
@@ -220,7 +247,7 @@ void SpExModel::initializeHasPaleoData()
     
     }
     
-    double updateRatePreservationRate = _settings.get<double>("updateRatePreservationRate");
+    double updateRatePreservationRate = spExSettings.updateRatePreservationRate;
     
     
     if (_numberOccurrences == 0){
@@ -243,7 +270,7 @@ void SpExModel::initializeHasPaleoData()
         _hasPaleoData = true;
         
         // Observation time of tree:
-        _observationTime = _settings.get<double>("observationTime");
+        _observationTime = spExSettings.observationTime;
         if (_observationTime <= 0){
             _observationTime = _tree->getAge();
         }else if ( _observationTime < _tree->getAge() ){
@@ -256,8 +283,52 @@ void SpExModel::initializeHasPaleoData()
         std::cout << "Invalid number of occurrences in controlfile" << std::endl;
         exit(0);
     }
-    
 
+    initializePreservationBins(bins.get());
+}
+
+
+// Without a bin file, a single bin covers all time
+void SpExModel::initializePreservationBins(const PreservationBins* bins)
+{
+    _preservationBinStart.assign(1, -INFINITY);
+    _binOccurrences.assign(1, _numberOccurrences);
+
+    if (bins != NULL) {
+        if (!_hasPaleoData) {
+            log(Error) << "Preservation bins require fossil occurrences.\n";
+            std::exit(1);
+        }
+
+        std::vector<double> startTimes =
+            bins->binStartTimes(_observationTime);
+        _preservationBinStart.insert(_preservationBinStart.end(),
+            startTimes.begin(), startTimes.end());
+
+        _binOccurrences.clear();
+        for (int i = 0; i < bins->numberOfBins(); i++) {
+            _binOccurrences.push_back(bins->occurrences(i));
+        }
+    }
+
+    // Not relevant if this is not paleo data
+    _preservationRates.assign(_binOccurrences.size(),
+        _settings.spExSettings().preservationRateInit);
+    updatePreservationLogProb();
+}
+
+
+// Bins without occurrences contribute nothing
+// (whatever their rate, which is 0 without paleo data)
+void SpExModel::updatePreservationLogProb()
+{
+    _preservationLogProb = 0.0;
+    for (int i = 0; i < (int)_preservationRates.size(); i++) {
+        if (_binOccurrences[i] > 0) {
+            _preservationLogProb +=
+                (double)_binOccurrences[i] * std::log(_preservationRates[i]);
+        }
+    }
 }
 
 
@@ -283,7 +354,8 @@ BranchEvent* SpExModel::newBranchEventWithReadParameters
     double muShift = muShiftParameter(parameters);
 
     // TODO: Fix reading of parameters (for now, send true for time-variable)
-    return new SpExBranchEvent(lambdaInit, lambdaShift,
+    return new (_eventPool.allocate(sizeof(SpExBranchEvent)))
+        SpExBranchEvent(lambdaInit, lambdaShift,
         muInit, muShift, true, x, _tree, _random, time);
 }
 
@@ -327,11 +399,11 @@ BranchEvent* SpExModel::newBranchEventWithParametersFromSettings(double x)
     // x is map time
     
     
-    double newLam = _settings.get<double>("lambdaInit0");
-    double newMu = _settings.get<double>("muInit0");
-    double newMuShift = _settings.get<double>("muShift0");
+    double newLam = _lambdaInit0;
+    double newMu = _muInit0;
+    double newMuShift = _muShift0;
     bool newIsTimeVariable = _prior.generateLambdaIsTimeVariableFromPrior();
-    double newLambdaShift = _settings.get<double>("lambdaShift0");
+    double newLambdaShift = _lambdaShift0;
     
     // TODO: This needs to be refactored somewhere else
     // Computes the jump density for the addition of new parameters.
@@ -343,9 +415,10 @@ BranchEvent* SpExModel::newBranchEventWithParametersFromSettings(double x)
     _logQRatioJump += _prior.muInitPrior(newMu);
     _logQRatioJump += _prior.muShiftPrior(newMuShift);
     
-    return new SpExBranchEvent(newLam, newLambdaShift, newMu,
-                               newMuShift, newIsTimeVariable, _tree->mapEventToTree(x),
-                               _tree, _random, x);
+    return new (_eventPool.allocate(sizeof(SpExBranchEvent)))
+        SpExBranchEvent(newLam, newLambdaShift, newMu,
+        newMuShift, newIsTimeVariable, _tree->mapEventToTree(x),
+        _tree, _random, x);
 
 }
 
@@ -372,7 +445,8 @@ BranchEvent* SpExModel::newBranchEventWithRandomParameters(double x)
     _logQRatioJump += _prior.muInitPrior(newMu);
     _logQRatioJump += _prior.muShiftPrior(newMuShift);
 
-    return new SpExBranchEvent(newLam, newLambdaShift, newMu,
+    return new (_eventPool.allocate(sizeof(SpExBranchEvent)))
+        SpExBranchEvent(newLam, newLambdaShift, newMu,
         newMuShift, newIsTimeVariable, _tree->mapEventToTree(x),
         _tree, _random, x);
 }
@@ -412,7 +486,8 @@ double SpExModel::calculateLogQRatioJump()
 
 BranchEvent* SpExModel::newBranchEventFromLastDeletedEvent()
 {
-    return new SpExBranchEvent(_lastDeletedEventLambdaInit,
+    return new (_eventPool.allocate(sizeof(SpExBranchEvent)))
+        SpExBranchEvent(_lastDeletedEventLambdaInit,
         _lastDeletedEventLambdaShift, _lastDeletedEventMuInit,
         _lastDeletedEventMuShift, _lastDeletedEventTimeVariable,
         _tree->mapEventToTree(_lastDeletedEventMapTime), _tree, _random,
@@ -420,14 +495,54 @@ BranchEvent* SpExModel::newBranchEventFromLastDeletedEvent()
 }
 
 
+BranchEvent* SpExModel::newBranchEventCopy(BranchEvent* event)
+{
+    SpExBranchEvent* spExEvent = static_cast<SpExBranchEvent*>(event);
+
+    return new (_eventPool.allocate(sizeof(SpExBranchEvent)))
+        SpExBranchEvent(spExEvent->getLamInit(),
+        spExEvent->getLamShift(), spExEvent->getMuInit(),
+        spExEvent->getMuShift(), spExEvent->isTimeVariable(),
+        _tree->mapEventToTree(event->getMapTime()), _tree, _random,
+        event->getMapTime());
+}
+
+
+void SpExModel::copyEventParameters(BranchEvent* to, BranchEvent* from)
+{
+    SpExBranchEvent* spExTo = static_cast<SpExBranchEvent*>(to);
+    SpExBranchEvent* spExFrom = static_cast<SpExBranchEvent*>(from);
+
+    spExTo->setLamInit(spExFrom->getLamInit());
+    spExTo->setLamShift(spExFrom->getLamShift());
+    spExTo->setMuInit(spExFrom->getMuInit());
+    spExTo->setMuShift(spExFrom->getMuShift());
+    spExTo->setTimeVariable(spExFrom->isTimeVariable());
+}
+
+
+void SpExModel::copyModelParameters(Model& model)
+{
+    SpExModel& spExModel = static_cast<SpExModel&>(model);
+    _preservationRates = spExModel._preservationRates;
+    _preservationLogProb = spExModel._preservationLogProb;
+}
+
+
 // TODO: Not transparent, but this is where
 //  Di for internal nodes is being set to 1.0
  
 double SpExModel::computeLogLikelihood()
 {
+    ScopedPhaseTimer timer(_proposalTimer, ProposalTimer::Likelihood);
+
     if (_sampleFromPriorOnly)
         return 0.0;
- 
+
+    double laneLogLikelihood;
+    if (takeLaneLogLikelihood(laneLogLikelihood)) {
+        return laneLogLikelihood;
+    }
 
     
     
@@ -452,73 +567,9 @@ double SpExModel::computeLogLikelihood()
             double LR = computeSpExProbBranch(node->getRtDesc());
             
 #ifdef NEVER_RECOMPUTE_E0
-            
-            double E_left = node->getLfDesc()->getExtinctionEnd();
-            double E_right = node->getRtDesc()->getExtinctionEnd();
-            
-            bool left_shift = node->getLfDesc()->getHasDownstreamRateShift();
-            bool right_shift = node->getRtDesc()->getHasDownstreamRateShift();
-            
-            
-            // random: favor extinction probs of right or left branch
-            //   based on pre-determined inheritance sequence
-            //   Avoids conditioning on tree shape, but conditions
-            //   on observed set of distinct processes.
-            
-            // if_different is (probably) the theoretically justified option
-            // and is now the default in BAMM
-            //  but the other options are included for comparison,
-            //  as this is not straightforward.
-            
-            if (_combineExtinctionAtNodes == "random"){
-                
-                if (node->getInheritFromLeft() == true){
-                    node->setEinit(E_left);
-                 
-                }else{
-                    node->setEinit(E_right);
-                 }
-                
-                
-            }else if(_combineExtinctionAtNodes  == "if_different"){
-                
-                double delta = std::fabs(E_left - E_right);
-                
-                if (delta < 0.001){
-                    node->setEinit(E_left);
-                }else{
-                    E_left *= E_right;
-                    node->setEinit(E_left);
-                }
-                
-            }else if (_combineExtinctionAtNodes == "favor_shift"){
-                if (left_shift == true & right_shift == true){
-                    node->setEinit( E_left * E_right );
-                }else if (left_shift == true & right_shift == false){
-                    node->setEinit(E_left);
-                }else if (left_shift == false & right_shift == true){
-                    node->setEinit(E_right);
-                }else if (left_shift == false & right_shift == false){
-                    node->setEinit(E_left);
-                }else{
-                    std::cout << "problem in computeLogLikelihood()" << std::endl;
-                    std::cout << "Error in _combineExtinctionAtNodes option" << std::endl;
-                    exit(0);
-                }
-            }else if (_combineExtinctionAtNodes == "left"){
-                node->setEinit(E_left);
-            }else if (_combineExtinctionAtNodes == "right"){
-                node->setEinit(E_right);
-            }else{
-                std::cout << "unsupported option for combining extinction probabilities" << std::endl;
-                exit(0);
-            }
-            
-            
+            combineExtinctionAtNode(node);
 #endif
-            
-            
-            
+
             logLikelihood += (LL + LR);
 
             // Does not include root node, so it is conditioned
@@ -541,6 +592,135 @@ double SpExModel::computeLogLikelihood()
 }
 
 
+// Models are computed in groups of at most MAX_LIKELIHOOD_LANES, and the
+// time of each group is shared equally among the proposals of its models.
+// A single model is faster to compute on its own.
+void SpExModel::computeLogLikelihoodLanes(const std::vector<Model*>& models)
+{
+    std::vector<SpExModel*> lanes;
+    for (Model* model : models) {
+        SpExModel* spExModel = static_cast<SpExModel*>(model);
+        if (!spExModel->_hasPaleoData && !spExModel->_sampleFromPriorOnly) {
+            lanes.push_back(spExModel);
+        }
+    }
+
+    if (lanes.size() < 2) {
+        return;
+    }
+
+    std::vector<SpExModel*> group;
+    std::vector<double> logLikelihoods;
+
+    for (int first = 0; first < (int)lanes.size();
+            first += MAX_LIKELIHOOD_LANES) {
+        int last = std::min(first + MAX_LIKELIHOOD_LANES, (int)lanes.size());
+        group.assign(lanes.begin() + first, lanes.begin() + last);
+
+        ProposalTimer::Clock::time_point start = ProposalTimer::Clock::now();
+
+        SpExLaneLikelihood laneLikelihood(group);
+        laneLikelihood.compute(logLikelihoods);
+
+        ProposalTimer::Clock::duration share =
+            (ProposalTimer::Clock::now() - start) / group.size();
+
+        for (int i = 0; i < (int)group.size(); i++) {
+            group[i]->setLaneLogLikelihood(logLikelihoods[i]);
+            group[i]->_proposalTimer.addTime(ProposalTimer::Likelihood, share);
+        }
+    }
+}
+
+
+// Extinction probability at the start of the branch above an internal
+// node, from those at the ends of its two descendant branches
+void SpExModel::combineExtinctionAtNode(Node* node)
+{
+    double E_left = node->getLfDesc()->getExtinctionEnd();
+    double E_right = node->getRtDesc()->getExtinctionEnd();
+
+    bool left_shift = node->getLfDesc()->getHasDownstreamRateShift();
+    bool right_shift = node->getRtDesc()->getHasDownstreamRateShift();
+
+
+    // random: favor extinction probs of right or left branch
+    //   based on pre-determined inheritance sequence
+    //   Avoids conditioning on tree shape, but conditions
+    //   on observed set of distinct processes.
+
+    // if_different is (probably) the theoretically justified option
+    // and is now the default in BAMM
+    //  but the other options are included for comparison,
+    //  as this is not straightforward.
+
+    switch (_combineExtinctionAtNodes) {
+    case RandomDescendant:
+
+        if (node->getInheritFromLeft() == true){
+            node->setEinit(E_left);
+
+        }else{
+            node->setEinit(E_right);
+        }
+        break;
+
+    case IfDifferent:
+
+        if (std::fabs(E_left - E_right) < 0.001){
+            node->setEinit(E_left);
+        }else{
+            E_left *= E_right;
+            node->setEinit(E_left);
+        }
+        break;
+
+    case FavorShift:
+        if (left_shift == true & right_shift == true){
+            node->setEinit( E_left * E_right );
+        }else if (left_shift == true & right_shift == false){
+            node->setEinit(E_left);
+        }else if (left_shift == false & right_shift == true){
+            node->setEinit(E_right);
+        }else if (left_shift == false & right_shift == false){
+            node->setEinit(E_left);
+        }else{
+            std::cout << "problem in computeLogLikelihood()" << std::endl;
+            std::cout << "Error in _combineExtinctionAtNodes option" << std::endl;
+            exit(0);
+        }
+        break;
+
+    case LeftDescendant:
+        node->setEinit(E_left);
+        break;
+
+    case RightDescendant:
+        node->setEinit(E_right);
+        break;
+    }
+}
+
+
+// The coarse likelihood can overflow the extinction probability bound
+// where the exact one does not; fall back to the exact likelihood there,
+// so that the surrogate is positive wherever the posterior is.
+double SpExModel::computeSurrogateLogLikelihood()
+{
+    double segLength = _segLength;
+
+    _segLength = _surrogateSegLength;
+    double logLikelihood = computeLogLikelihood();
+    _segLength = segLength;
+
+    if (std::isinf(logLikelihood)) {
+        logLikelihood = computeLogLikelihood();
+    }
+
+    return logLikelihood;
+}
+
+
 double SpExModel::computeSpExProbBranch(Node* node)
 {
  
@@ -589,12 +769,23 @@ double SpExModel::computeSpExProbBranch(Node* node)
         
         double startTime = node->getBrlen() + ddt;
         double endTime = startTime;
+
+        int bin = preservationBinEndingAt(_observationTime);
         
         while (startTime > node->getBrlen()){
             startTime -= _segLength;
             if (startTime < node->getBrlen() ){
                 startTime = node->getBrlen();
             }
+
+            // Segments end at the start of their preservation bin
+            double binStartTime =
+                _preservationBinStart[bin] - node->getAnc()->getTime();
+            bool binStarts = (binStartTime >= startTime);
+            if (binStarts) {
+                startTime = binStartTime;
+            }
+
             double deltaT = endTime - startTime;
             
             double curLam = node->computeSpeciationRateIntervalRelativeTime
@@ -603,7 +794,7 @@ double SpExModel::computeSpExProbBranch(Node* node)
             double curMu = node->computeExtinctionRateIntervalRelativeTime
             (startTime, endTime);
             
-            double curPsi = _preservationRate;
+            double curPsi = _preservationRates[bin];
             
             double spProb = 0.0;
             double exProb = 0.0;
@@ -618,6 +809,10 @@ double SpExModel::computeSpExProbBranch(Node* node)
             E0 = exProb;
             
             endTime = startTime;
+
+            if (binStarts) {
+                bin--;
+            }
             
         }
         
@@ -640,6 +835,8 @@ double SpExModel::computeSpExProbBranch(Node* node)
     double endTime = node->getBrlen();
  
     SpExBranchEvent* be = static_cast<SpExBranchEvent*>(node->getBranchHistory()->getLastEvent(node->getTime()));
+
+    int bin = preservationBinEndingAt(node->getTime());
  
     while (startTime > 0) {
         startTime -= _segLength;
@@ -647,6 +844,14 @@ double SpExModel::computeSpExProbBranch(Node* node)
             startTime = 0.0;
         }
 
+        // Segments end at the start of their preservation bin (bin 0
+        // starts at -INFINITY, so without bins this is never the case)
+        bool binStarts =
+            (_preservationBinStart[bin] >= node->getAnc()->getTime() + startTime);
+        if (binStarts) {
+            startTime = _preservationBinStart[bin] - node->getAnc()->getTime();
+        }
+
         double abs_start_time = node->getAnc()->getTime() + startTime;
         double abs_end_time   = node->getAnc()->getTime() + endTime;
         
@@ -666,6 +871,7 @@ double SpExModel::computeSpExProbBranch(Node* node)
             
             // Reset start time to absolute time of event if we pass an event on branch
             abs_start_time = node->getAnc()->getTime() + startTime;
+            binStarts = (_preservationBinStart[bin] >= abs_start_time);
             be = static_cast<SpExBranchEvent*>(node->getBranchHistory()->getLastEvent(be));
             
             // set flag to recompute_E0 if you switch to new process.
@@ -691,7 +897,7 @@ double SpExModel::computeSpExProbBranch(Node* node)
         double curLam = computeMeanExponentialRateForInterval(lam_init, lam_shift, event_t_start, event_t_end);
         double curMu  = computeMeanExponentialRateForInterval(mu_init, mu_shift, event_t_start, event_t_end);
         
-        double curPsi = _preservationRate;
+        double curPsi = _preservationRates[bin];
         double spProb = 0.0;
         double exProb = 0.0;
         
@@ -762,7 +968,9 @@ double SpExModel::computeSpExProbBranch(Node* node)
         
         endTime = startTime;
 
-    
+        if (binStarts) {
+            bin--;
+        }
     
     }
     
@@ -842,7 +1050,8 @@ double SpExModel::recomputeE0(double start_time, double end_time, double lam_ini
         double curLam = computeMeanExponentialRateForInterval(lam_init, lam_shift, decrementer, end_time);
         double curMu  = computeMeanExponentialRateForInterval(mu_init, mu_shift, decrementer, end_time);
         
-        double cpsi = _preservationRate;
+        // Assumes a single preservation rate
+        double cpsi = _preservationRates[0];
         
         double sprob = 0.0;
         double eprob = 0.0;
@@ -960,6 +1169,8 @@ void SpExModel::computeSpExProb(double& spProb, double& exProb,
 
 double SpExModel::computeLogPrior()
 {
+    ScopedPhaseTimer timer(_proposalTimer, ProposalTimer::Prior);
+
     double logPrior = 0.0;
 
     SpExBranchEvent* rootEvent = static_cast<SpExBranchEvent*>(_rootEvent);
@@ -995,7 +1206,9 @@ double SpExModel::computeLogPrior()
     
     // Prior density on the preservation rate, if paleo data:
     if (_hasPaleoData){
-        logPrior += _prior.preservationRatePrior(_preservationRate);
+        for (int i = 0; i < (int)_preservationRates.size(); i++) {
+            logPrior += _prior.preservationRatePrior(_preservationRates[i]);
+        }
     }
 
     
@@ -1008,9 +1221,7 @@ double SpExModel::computeLogPrior()
 
 double SpExModel::computePreservationLogProb()
 {
-    double logLik = (double)_numberOccurrences * std::log(_preservationRate);
-
-    return logLik;
+    return _preservationLogProb;
 }
 
 /************************/
@@ -3,17 +3,21 @@
 
 
 #include "Model.h"
+#include "TypedSettings.h"
 
 #include <iosfwd>
 #include <vector>
 #include <string>
+#include <algorithm>
 
 class Node;
 class Random;
+class RandomStreams;
 class Settings;
 class BranchEvent;
 class Proposal;
 class SpExBranchEvent;
+class PreservationBins;
 
 
 class SpExModel : public Model
@@ -21,10 +25,17 @@ class SpExModel : public Model
 
 public:
 
-    SpExModel(Random& rng, Settings& settings);
+    SpExModel(Random& rng, const RandomStreams& streams, Settings& settings);
 
     virtual double computeLogLikelihood();
     virtual double computeLogPrior();
+
+    // Likelihood on coarser segments, for delayed acceptance
+    virtual double computeSurrogateLogLikelihood();
+
+    // Computed with SpExLaneLikelihood, except for models with paleo
+    // data or sampling from the prior only
+    virtual void computeLogLikelihoodLanes(const std::vector<Model*>& models);
  
 	// Methods for auto-tuning
     //   no auto-tuning yet implemented
@@ -34,8 +45,10 @@ public:
     
     
     // FOSSIL STUFF
-    double getPreservationRate();
-    void setPreservationRate(double x);
+    // Preservation rates are piecewise constant in time, one per bin
+    int numberOfPreservationBins() const;
+    double getPreservationRate(int bin);
+    void setPreservationRate(int bin, double x);
     
     bool   getHasPaleoData();
     void   setHasPaleoData(bool x);
@@ -47,6 +60,8 @@ public:
 
 private:
 
+    friend class SpExLaneLikelihood;
+
     virtual void setRootEventWithReadParameters
         (const std::vector<std::string>& parameters);
     virtual BranchEvent* newBranchEventWithReadParameters
@@ -61,10 +76,15 @@ private:
     virtual BranchEvent* newBranchEventWithParametersFromSettings(double x);
     virtual BranchEvent* newBranchEventFromLastDeletedEvent();
 
+    virtual BranchEvent* newBranchEventCopy(BranchEvent* event);
+    virtual void copyEventParameters(BranchEvent* to, BranchEvent* from);
+    virtual void copyModelParameters(Model& model);
+
     virtual void setMeanBranchParameters();
     virtual void setDeletedEventParameters(BranchEvent* be);
 
     double computeSpExProbBranch(Node* node);
+    void combineExtinctionAtNode(Node* node);
     void computeSpExProb(double& spProb, double& exProb,
         double lambda, double mu, double psi, double D0, double E0, double deltaT);
 
@@ -90,6 +110,7 @@ private:
     double _lastDeletedEventTimeVariable;
 
     double _segLength;
+    double _surrogateSegLength;
 
     double _readLambdaInit;
     double _readLambdaShift;
@@ -99,15 +120,26 @@ private:
     double _extinctionProbMax;
     
     //FOSSIL
-    // Fossil preservation rate. Assume 1 value for now.
-    double _preservationRate;
+    // Fossil preservation rate of each stratigraphic time bin, from the
+    // oldest; a single bin unless preservationBinsFilename is given.
+    // Bin i starts at _preservationBinStart[i] (time from the root),
+    // which is -INFINITY for bin 0, and ends where bin i + 1 starts.
+    std::vector<double> _preservationRates;
+    std::vector<double> _preservationBinStart;
+    std::vector<int> _binOccurrences;
     // Time at which tree is observed, relative to root
     double _observationTime;
     
-    // this will change at some point
-    //   to allow greater flexibility of preservation model
     int     _numberOccurrences;
     bool   _hasPaleoData;
+
+    // Sum over bins of the number of occurrences times the log of the
+    // preservation rate, kept up to date as rates change
+    double _preservationLogProb;
+
+    void initializePreservationBins(const PreservationBins* bins);
+    void updatePreservationLogProb();
+    int preservationBinEndingAt(double time) const;
     
     bool   _conditionOnSurvival;
     
@@ -136,21 +168,37 @@ private:
     
     bool _alwaysRecomputeE0;
     
-    std::string _combineExtinctionAtNodes;
+    ExtinctionCombination _combineExtinctionAtNodes;
     
     
     
 };
 
 
-inline double SpExModel::getPreservationRate(void)
+inline int SpExModel::numberOfPreservationBins() const
 {
-    return _preservationRate;
+    return (int)_preservationRates.size();
 }
 
-inline void SpExModel::setPreservationRate(double x)
+inline double SpExModel::getPreservationRate(int bin)
+{
+    return _preservationRates[bin];
+}
+
+inline void SpExModel::setPreservationRate(int bin, double x)
+{
+    _preservationRates[bin] = x;
+    updatePreservationLogProb();
+}
+
+
+// Bin of the segment of a branch that ends (toward the present)
+// at the given time
+inline int SpExModel::preservationBinEndingAt(double time) const
 {
-    _preservationRate = x;
+    return (int)(std::lower_bound(_preservationBinStart.begin(),
+        _preservationBinStart.end(), time) -
+        _preservationBinStart.begin()) - 1;
 }
 
 
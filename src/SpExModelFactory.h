@@ -10,6 +10,7 @@ class Model;
 class ModelDataWriter;
 
 class Random;
+class RandomStreams;
 class Settings;
 class Prior;
 
@@ -20,15 +21,16 @@ public:
 
     virtual ~SpExModelFactory() {}
 
-    virtual Model* createModel(Random& random, Settings& settings) const;
+    virtual Model* createModel(Random& random, const RandomStreams& streams,
+        Settings& settings) const;
     virtual ModelDataWriter* createModelDataWriter(Settings& settings) const;
 };
 
 
 inline Model* SpExModelFactory::createModel
-    (Random& random, Settings& settings) const
+    (Random& random, const RandomStreams& streams, Settings& settings) const
 {
-    return new SpExModel(random, settings);
+    return new SpExModel(random, streams, settings);
 }
 
 
@@ -0,0 +1,44 @@
+#include "SpExPosteriorSummaryDataWriter.h"
+#include "PosteriorSummaryDataWriter.h"
+#include "SpExBranchEvent.h"
+#include "Node.h"
+
+class Settings;
+
+
+SpExPosteriorSummaryDataWriter::SpExPosteriorSummaryDataWriter
+    (Settings& settings) : PosteriorSummaryDataWriter(settings)
+{
+}
+
+
+SpExPosteriorSummaryDataWriter::~SpExPosteriorSummaryDataWriter()
+{
+}
+
+
+double SpExPosteriorSummaryDataWriter::branchRate(Node* node, int rate)
+{
+    if (rate == 0) {
+        return node->getMeanSpeciationRate();
+    } else {
+        return node->getMeanExtinctionRate();
+    }
+}
+
+
+double SpExPosteriorSummaryDataWriter::rateAtTime
+    (BranchEvent* event, double time, int rate)
+{
+    SpExBranchEvent* specificEvent = static_cast<SpExBranchEvent*>(event);
+    Node* node = specificEvent->getEventNode();
+    double relativeTime = time - specificEvent->getAbsoluteTime();
+
+    if (rate == 0) {
+        return node->getExponentialRate(specificEvent->getLamInit(),
+            specificEvent->getLamShift(), relativeTime);
+    } else {
+        return node->getExponentialRate(specificEvent->getMuInit(),
+            specificEvent->getMuShift(), relativeTime);
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef SP_EX_POSTERIOR_SUMMARY_DATA_WRITER_H
+#define SP_EX_POSTERIOR_SUMMARY_DATA_WRITER_H
+
+
+#include "PosteriorSummaryDataWriter.h"
+#include <string>
+
+class Settings;
+class Node;
+class BranchEvent;
+
+
+class SpExPosteriorSummaryDataWriter : public PosteriorSummaryDataWriter
+{
+public:
+
+    SpExPosteriorSummaryDataWriter(Settings& settings);
+    virtual ~SpExPosteriorSummaryDataWriter();
+
+private:
+
+    virtual int numberOfRates();
+    virtual std::string rateName(int rate);
+    virtual double branchRate(Node* node, int rate);
+    virtual double rateAtTime(BranchEvent* event, double time, int rate);
+};
+
+
+inline int SpExPosteriorSummaryDataWriter::numberOfRates()
+{
+    return 2;
+}
+
+
+inline std::string SpExPosteriorSummaryDataWriter::rateName(int rate)
+{
+    return rate == 0 ? "lambda" : "mu";
+}
+
+
+#endif
@@ -2,24 +2,100 @@
 #define STAT_H
 
 
-#include "MbRandom.h"
 #include <vector>
+#include <cmath>
+#include <cstddef>
 
 
+// Log-density functions are stateless and defined inline so that they
+// can be called concurrently from all chain threads and be inlined into
+// the prior and likelihood loops.
+
 class Stat
 {
 public:
 
+    // Natural log of 2 * pi
+    static constexpr double lnTwoPi = 1.83787706640934548356;
+
     static double standard_deviation(const std::vector<double>& values);
     static double variance(const std::vector<double>& values);
 
+    // Normal density parameterized by the standard deviation
     static double lnNormalPDF(double x, double mean, double sd);
-    static double lnExponentialPDF(double x, double rate);
 
-private:
+    // Normal density parameterized by the variance
+    static double lnNormalPDFVar(double x, double mean, double var);
 
-    static MbRandom _random;
+    static double lnExponentialPDF(double x, double rate);
+    static double lnGammaPDF(double x, double shape, double rate);
+    static double lnLognormalPDF(double x, double logMean, double logSd);
+
+    // Batched versions: return the sum of the log-densities of n values
+    static double sumLnNormalPDFVar(const double* x, const double* var,
+        std::size_t n);
+    static double sumLnExponentialPDF(const double* x, std::size_t n,
+        double rate);
 };
 
 
+inline double Stat::lnNormalPDF(double x, double mean, double sd)
+{
+    return lnNormalPDFVar(x, mean, sd * sd);
+}
+
+
+inline double Stat::lnNormalPDFVar(double x, double mean, double var)
+{
+    double delta = x - mean;
+    return -0.5 * (lnTwoPi + std::log(var)) - (delta * delta) / (2.0 * var);
+}
+
+
+inline double Stat::lnExponentialPDF(double x, double rate)
+{
+    return std::log(rate) - rate * x;
+}
+
+
+inline double Stat::lnGammaPDF(double x, double shape, double rate)
+{
+    return shape * std::log(rate) - std::lgamma(shape) +
+        (shape - 1.0) * std::log(x) - rate * x;
+}
+
+
+inline double Stat::lnLognormalPDF(double x, double logMean, double logSd)
+{
+    double logX = std::log(x);
+    return lnNormalPDF(logX, logMean, logSd) - logX;
+}
+
+
+// The mean is zero (as for trait changes along branches)
+inline double Stat::sumLnNormalPDFVar(const double* x, const double* var,
+    std::size_t n)
+{
+    double sum = 0.0;
+    for (std::size_t i = 0; i < n; i++) {
+        sum += -0.5 * (lnTwoPi + std::log(var[i])) -
+            (x[i] * x[i]) / (2.0 * var[i]);
+    }
+
+    return sum;
+}
+
+
+inline double Stat::sumLnExponentialPDF(const double* x, std::size_t n,
+    double rate)
+{
+    double sumX = 0.0;
+    for (std::size_t i = 0; i < n; i++) {
+        sumX += x[i];
+    }
+
+    return (double)n * std::log(rate) - rate * sumX;
+}
+
+
 #endif
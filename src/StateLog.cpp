@@ -0,0 +1,38 @@
+#include "StateLog.h"
+
+
+StateLog::StateLog() : _recording(false)
+{
+}
+
+
+void StateLog::begin()
+{
+    _rateChanges.clear();
+    _eventChanges.clear();
+    _recording = true;
+}
+
+
+void StateLog::commit()
+{
+    _rateChanges.clear();
+    _eventChanges.clear();
+    _recording = false;
+}
+
+
+// Changes are undone in reverse order, so a field changed more than once
+// ends with the value it had when recording began
+void StateLog::rollback()
+{
+    for (int i = (int)_rateChanges.size() - 1; i >= 0; i--) {
+        *_rateChanges[i].first = _rateChanges[i].second;
+    }
+
+    for (int i = (int)_eventChanges.size() - 1; i >= 0; i--) {
+        *_eventChanges[i].first = _eventChanges[i].second;
+    }
+
+    commit();
+}
@@ -0,0 +1,74 @@
+#ifndef STATE_LOG_H
+#define STATE_LOG_H
+
+
+#include <vector>
+#include <utility>
+
+class BranchEvent;
+
+
+// Undo log of the state derived from the events on the tree: the event
+// pointers of the branch histories and the branch and node rates.
+// While recording (between begin() and commit()), each setter of these
+// fields saves the value it overwrites, if it changes it, so that a
+// rejected proposal can restore the tree with rollback() in time
+// proportional to the number of changes instead of recomputing it.
+// Likelihood partials are not saved, because every likelihood
+// computation overwrites them.
+
+class StateLog
+{
+public:
+
+    StateLog();
+
+    void begin();
+    void commit();
+    void rollback();
+
+    bool isRecording() const;
+    int numberOfChanges() const;
+
+    // Saves the current value of a field before it is set to value
+    void record(double& field, double value);
+    void record(BranchEvent*& field, BranchEvent* value);
+
+private:
+
+    bool _recording;
+
+    std::vector<std::pair<double*, double> > _rateChanges;
+    std::vector<std::pair<BranchEvent**, BranchEvent*> > _eventChanges;
+};
+
+
+inline bool StateLog::isRecording() const
+{
+    return _recording;
+}
+
+
+inline int StateLog::numberOfChanges() const
+{
+    return (int)(_rateChanges.size() + _eventChanges.size());
+}
+
+
+inline void StateLog::record(double& field, double value)
+{
+    if (_recording && field != value) {
+        _rateChanges.push_back(std::make_pair(&field, field));
+    }
+}
+
+
+inline void StateLog::record(BranchEvent*& field, BranchEvent* value)
+{
+    if (_recording && field != value) {
+        _eventChanges.push_back(std::make_pair(&field, field));
+    }
+}
+
+
+#endif
@@ -1,6 +1,7 @@
 #include "StdOutDataWriter.h"
 #include "Settings.h"
 #include "Model.h"
+#include "ConvergenceDiagnostics.h"
 
 #include <iostream>
 #include <iomanip>
@@ -8,7 +9,12 @@
 
 StdOutDataWriter::StdOutDataWriter(Settings& settings) :
     _outputFreq(settings.get<int>("printFreq")),
-    _headerWritten(false)
+    _headerWritten(false),
+    _lastWriteTime(Clock::now()),
+    _lastWriteGeneration(0),
+    _likelihoodEvaluations(0),
+    _lastModel(NULL),
+    _lastModelLikelihoodEvaluations(0)
 {
 }
 
@@ -18,24 +24,74 @@ StdOutDataWriter::~StdOutDataWriter()
 }
 
 
-void StdOutDataWriter::writeData(int generation, Model& model)
+void StdOutDataWriter::writeData(int generation, Model& model,
+    const ConvergenceDiagnostics& convergenceDiagnostics)
 {
     if (!_headerWritten && _outputFreq > 0) {
         writeHeader();
         _headerWritten = true;
     }
 
-    if (_outputFreq == 0 || generation % _outputFreq != 0) {
+    if (_outputFreq == 0) {
         return;
     }
 
+    countLikelihoodEvaluations(model);
+
+    if (generation % _outputFreq != 0) {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    double seconds = std::chrono::duration_cast
+        <std::chrono::duration<double> >(now - _lastWriteTime).count();
+
+    double generationsPerSecond = 0.0;
+    double likelihoodsPerSecond = 0.0;
+    if (seconds > 0.0) {
+        generationsPerSecond = (generation - _lastWriteGeneration) / seconds;
+        likelihoodsPerSecond = _likelihoodEvaluations / seconds;
+    }
+
+    _lastWriteTime = now;
+    _lastWriteGeneration = generation;
+    _likelihoodEvaluations = 0;
+
     std::cout << std::setw(12) << generation
               << std::setw(12) << model.getNumberOfEvents()
               << std::setw(12) << model.computeLogPrior()
               << std::setw(12) << model.getCurrentLogLikelihood()
               << std::setw(12) << model.getEventRate()
               << std::setw(12) << model.getMHAcceptanceRate()
-              << std::endl;
+              << std::setw(12) << (int)generationsPerSecond
+              << std::setw(12) << (int)likelihoodsPerSecond;
+
+    if (convergenceDiagnostics.hasDiagnostics()) {
+        std::cout << std::setw(12)
+                  << (int)convergenceDiagnostics.minEffectiveSampleSize()
+                  << std::setw(12) << convergenceDiagnostics.maxSplitRhat();
+    } else {
+        std::cout << std::setw(12) << "NA" << std::setw(12) << "NA";
+    }
+
+    std::cout << std::endl;
+}
+
+
+// The generation in which the cold chain changes is not counted,
+// since the new cold chain's count at the previous generation is unknown
+void StdOutDataWriter::countLikelihoodEvaluations(Model& model)
+{
+    long long evaluations =
+        model.proposalTimer().totalLikelihoodEvaluations();
+
+    if (&model == _lastModel) {
+        _likelihoodEvaluations +=
+            evaluations - _lastModelLikelihoodEvaluations;
+    }
+
+    _lastModel = &model;
+    _lastModelLikelihoodEvaluations = evaluations;
 }
 
 
@@ -52,5 +108,9 @@ std::string StdOutDataWriter::header()
            "    logPrior"
            "      logLik"
            "   eventRate"
-           "  acceptRate";
+           "  acceptRate"
+           "    gens/sec"
+           "  logLik/sec"
+           "     min_ESS"
+           "    max_Rhat";
 }
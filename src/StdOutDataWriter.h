@@ -4,9 +4,11 @@
 
 #include <string>
 #include <fstream>
+#include <chrono>
 
 class Settings;
 class Model;
+class ConvergenceDiagnostics;
 
 
 class StdOutDataWriter
@@ -16,15 +18,30 @@ public:
     StdOutDataWriter(Settings& settings);
     ~StdOutDataWriter();
 
-    void writeData(int generation, Model& model);
+    void writeData(int generation, Model& model,
+        const ConvergenceDiagnostics& convergenceDiagnostics);
 
 private:
 
+    typedef std::chrono::steady_clock Clock;
+
     void writeHeader();
     std::string header();
 
+    void countLikelihoodEvaluations(Model& model);
+
     int _outputFreq;
     bool _headerWritten;
+
+    // Throughput since the previous line was written
+    Clock::time_point _lastWriteTime;
+    int _lastWriteGeneration;
+
+    // Likelihood evaluations of the cold chain, counted generation by
+    // generation because the cold chain changes when chains are swapped
+    long long _likelihoodEvaluations;
+    Model* _lastModel;
+    long long _lastModelLikelihoodEvaluations;
 };
 
 
@@ -39,8 +39,9 @@ void TimeModeProposal::propose()
 
     setModelParameters();
 
-    _proposedLogLikelihood = _model.computeLogLikelihood();
     _proposedLogPrior = _model.computeLogPrior();
+
+    _canBeAccepted = canBeAccepted();
 }
 
 
@@ -165,18 +166,25 @@ void TimeModeProposal::reject()
     setEventParameters(_event, _currentInitParam, _currentRateParam,
         _currentIsTimeVariable);
 
-    setModelParameters();
+    _model.rollbackState();
 }
 
 
+// The likelihood is not computed at all if the proposal is rejected
+// whatever its value
 double TimeModeProposal::acceptanceRatio()
 {
+    if (!_canBeAccepted) {
+        _model.skipLikelihoodEvaluation();
+        return 0.0;
+    }
+
+    _proposedLogLikelihood = _model.computeLogLikelihood();
     double logLikelihoodRatio = computeLogLikelihoodRatio();
-    double logPriorRatio = computeLogPriorRatio();
-    double logJacobian = computeLogJacobian();
 
     double t = _model.getTemperatureMH();
-    double logRatio = t * (logLikelihoodRatio + logPriorRatio) + logJacobian;
+    double logRatio =
+        t * (logLikelihoodRatio + _logPriorRatio) + _logJacobian;
 
     if (std::isfinite(logRatio)) {
         return std::min(1.0, std::exp(logRatio));
@@ -186,6 +194,23 @@ double TimeModeProposal::acceptanceRatio()
 }
 
 
+bool TimeModeProposal::needsLikelihood() const
+{
+    return _canBeAccepted;
+}
+
+
+// Computes the prior ratio and Jacobian, which do not depend
+// on the likelihood
+bool TimeModeProposal::canBeAccepted()
+{
+    _logPriorRatio = computeLogPriorRatio();
+    _logJacobian = computeLogJacobian();
+
+    return std::isfinite(_logPriorRatio) && std::isfinite(_logJacobian);
+}
+
+
 double TimeModeProposal::computeLogLikelihoodRatio()
 {
     return _proposedLogLikelihood - _currentLogLikelihood;
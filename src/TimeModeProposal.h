@@ -28,6 +28,7 @@ public:
     virtual void reject();
 
     virtual double acceptanceRatio();
+    virtual bool needsLikelihood() const;
 
 protected:
 
@@ -48,6 +49,9 @@ protected:
     double computeMeanRate(double init, double k, double T);
     double computeRateInit(double mean, double k, double T);
 
+    // Whether the proposal can be accepted whatever its likelihood
+    bool canBeAccepted();
+
     double computeLogLikelihoodRatio();
     double computeLogPriorRatio();
     double computeLogJacobian();
@@ -70,6 +74,10 @@ protected:
     double _proposedLogLikelihood;
     double _proposedLogPrior;
 
+    bool _canBeAccepted;
+    double _logPriorRatio;
+    double _logJacobian;
+
     ProposalType _lastTimeModeProposal;
 };
 
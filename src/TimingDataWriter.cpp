@@ -0,0 +1,93 @@
+#include "TimingDataWriter.h"
+#include "Settings.h"
+#include "Model.h"
+#include "MCMC.h"
+#include "ProposalTimer.h"
+#include "BranchEventPool.h"
+
+#include <iostream>
+
+
+TimingDataWriter::TimingDataWriter(Settings& settings) :
+    _shouldOutputData(settings.get<bool>("outputTimingInfo")),
+    _outputFreq(settings.get<int>("timingInfoWriteFreq")),
+    _lastWriteGeneration(0),
+    _outputFileName(settings.get("timingInfoFileName"))
+{
+    if (_shouldOutputData) {
+        initializeStream();
+        writeHeader();
+    }
+}
+
+
+void TimingDataWriter::initializeStream()
+{
+    _outputStream.open(_outputFileName.c_str());
+}
+
+
+void TimingDataWriter::writeHeader()
+{
+    _outputStream << header() << std::endl;
+}
+
+
+std::string TimingDataWriter::header() const
+{
+    return "generation,chain,proposal,name,count,proposeTime,"
+        "likelihoodTime,priorTime,acceptRejectTime,likelihoodEvaluations,"
+        "skippedLikelihoodEvaluations,eventAllocations,eventReuses,"
+        "eventChunks";
+}
+
+
+TimingDataWriter::~TimingDataWriter()
+{
+    if (_shouldOutputData) {
+        _outputStream.close();
+    }
+}
+
+
+// Chains advance several generations at a time (up to a chain swap),
+// so data is written once the generation passes a multiple of the
+// output frequency, and always at the last generation
+void TimingDataWriter::writeData(int generation,
+    const std::vector<MCMC*>& chains, bool lastGeneration)
+{
+    if (!_shouldOutputData) {
+        return;
+    }
+
+    bool passedOutputGeneration = _outputFreq > 0 &&
+        generation / _outputFreq > _lastWriteGeneration / _outputFreq;
+    if (!passedOutputGeneration && !lastGeneration) {
+        return;
+    }
+
+    _lastWriteGeneration = generation;
+
+    for (int c = 0; c < (int)chains.size(); c++) {
+        Model& model = chains[c]->model();
+        const ProposalTimer& timer = model.proposalTimer();
+        const BranchEventPool& eventPool = model.eventPool();
+
+        for (int p = 0; p < timer.numberOfProposals(); p++) {
+            _outputStream << generation                            << ","
+                << c                                               << ","
+                << p                                               << ","
+                << model.proposalName(p)                           << ","
+                << timer.proposalCount(p)                          << ","
+                << timer.seconds(p, ProposalTimer::Propose)        << ","
+                << timer.seconds(p, ProposalTimer::Likelihood)     << ","
+                << timer.seconds(p, ProposalTimer::Prior)          << ","
+                << timer.seconds(p, ProposalTimer::AcceptReject)   << ","
+                << timer.likelihoodEvaluations(p)                  << ","
+                << timer.skippedLikelihoodEvaluations(p)           << ","
+                << eventPool.numberOfAllocations()                 << ","
+                << eventPool.numberOfReuses()                      << ","
+                << eventPool.numberOfChunks()                      << std::endl;
+        }
+    }
+}
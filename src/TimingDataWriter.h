@@ -0,0 +1,43 @@
+#ifndef TIMING_DATA_WRITER_H
+#define TIMING_DATA_WRITER_H
+
+
+#include <vector>
+#include <string>
+#include <fstream>
+
+class Settings;
+class MCMC;
+
+
+// Writes the cumulative time spent in each proposal type of each chain,
+// and the branch event allocation counters of each chain (repeated on
+// each of the chain's lines).
+// Must only be called while the chains are not running.
+
+class TimingDataWriter
+{
+public:
+
+    TimingDataWriter(Settings& settings);
+    ~TimingDataWriter();
+
+    void writeData(int generation, const std::vector<MCMC*>& chains,
+        bool lastGeneration);
+
+private:
+
+    void initializeStream();
+    void writeHeader();
+    std::string header() const;
+
+    bool _shouldOutputData;
+    int _outputFreq;
+    int _lastWriteGeneration;
+
+    std::string _outputFileName;
+    std::ofstream _outputStream;
+};
+
+
+#endif
@@ -0,0 +1,22 @@
+#include "TraitBranchRatesDataWriter.h"
+#include "BranchRatesDataWriter.h"
+#include "Node.h"
+
+class Settings;
+
+
+TraitBranchRatesDataWriter::TraitBranchRatesDataWriter(Settings& settings) :
+    BranchRatesDataWriter(settings)
+{
+}
+
+
+TraitBranchRatesDataWriter::~TraitBranchRatesDataWriter()
+{
+}
+
+
+double TraitBranchRatesDataWriter::branchRate(Node* node, int)
+{
+    return node->getMeanBeta();
+}
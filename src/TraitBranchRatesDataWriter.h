@@ -0,0 +1,39 @@
+#ifndef TRAIT_BRANCH_RATES_DATA_WRITER_H
+#define TRAIT_BRANCH_RATES_DATA_WRITER_H
+
+
+#include "BranchRatesDataWriter.h"
+#include <string>
+
+class Settings;
+class Node;
+
+
+class TraitBranchRatesDataWriter : public BranchRatesDataWriter
+{
+public:
+
+    TraitBranchRatesDataWriter(Settings& settings);
+    virtual ~TraitBranchRatesDataWriter();
+
+private:
+
+    virtual int numberOfRates();
+    virtual std::string rateName(int rate);
+    virtual double branchRate(Node* node, int rate);
+};
+
+
+inline int TraitBranchRatesDataWriter::numberOfRates()
+{
+    return 1;
+}
+
+
+inline std::string TraitBranchRatesDataWriter::rateName(int)
+{
+    return "beta";
+}
+
+
+#endif
@@ -9,7 +9,8 @@ class Model;
 
 TraitDataWriter::TraitDataWriter(Settings &settings) :
     ModelDataWriter(settings), _eventDataWriter(settings),
-    _nodeStateDataWriter(settings)
+    _nodeStateDataWriter(settings), _branchRatesDataWriter(settings),
+    _posteriorSummaryDataWriter(settings)
 {
 }
 
@@ -19,4 +20,12 @@ void TraitDataWriter::writeData(int generation, Model& model)
     ModelDataWriter::writeData(generation, model);
     _eventDataWriter.writeData(generation, model);
     _nodeStateDataWriter.writeData(generation, static_cast<TraitModel&>(model));
+    _branchRatesDataWriter.writeData(generation, model);
+    _posteriorSummaryDataWriter.writeData(generation, model);
+}
+
+
+void TraitDataWriter::writeFinalData(Model& model)
+{
+    _posteriorSummaryDataWriter.writeFinalData(model);
 }
@@ -5,6 +5,8 @@
 #include "ModelDataWriter.h"
 #include "TraitEventDataWriter.h"
 #include "NodeStateDataWriter.h"
+#include "TraitBranchRatesDataWriter.h"
+#include "TraitPosteriorSummaryDataWriter.h"
 
 class Settings;
 class Model;
@@ -17,11 +19,14 @@ public:
     TraitDataWriter(Settings &settings);
 
     virtual void writeData(int generation, Model& model);
+    virtual void writeFinalData(Model& model);
 
 protected:
 
     TraitEventDataWriter _eventDataWriter;
     NodeStateDataWriter _nodeStateDataWriter;
+    TraitBranchRatesDataWriter _branchRatesDataWriter;
+    TraitPosteriorSummaryDataWriter _posteriorSummaryDataWriter;
 };
 
 
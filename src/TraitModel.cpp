@@ -32,6 +32,7 @@
 #include <cstdlib>
 #include <sstream>
 #include <cmath>
+#include <new>
 
 
 TraitModel::TraitModel(Random& random, Settings& settings) :
@@ -46,13 +47,17 @@ TraitModel::TraitModel(Random& random, Settings& settings) :
     }
 #endif
     
-    _sampleFromPriorOnly = _settings.get<bool>("sampleFromPriorOnly");
+    _sampleFromPriorOnly = _settings.modelSettings().sampleFromPriorOnly;
 
-    double betaInit = _settings.get<double>("betaInit");
-    double betaShiftInit = _settings.get<double>("betaShiftInit");
+    // Buffers for the per-branch terms of the likelihood
+    _branchTraitDeltas.resize(_tree->getNumberOfNodes());
+    _branchTraitVariances.resize(_tree->getNumberOfNodes());
+
+    double betaInit = _settings.traitSettings().betaInit;
+    double betaShiftInit = _settings.traitSettings().betaShiftInit;
 
     bool isTimeVariable = false;
-    double timeVarPrior = _settings.get<double>("betaIsTimeVariablePrior");
+    double timeVarPrior = _settings.priorSettings().betaIsTimeVariablePrior;
     if (timeVarPrior == 0.0) {
         isTimeVariable = false;
         if (betaShiftInit != 0.0) {
@@ -65,7 +70,8 @@ TraitModel::TraitModel(Random& random, Settings& settings) :
         isTimeVariable = betaShiftInit != 0.0;
     }
 
-    BranchEvent* x = new TraitBranchEvent(betaInit, betaShiftInit,
+    BranchEvent* x = new (_eventPool.allocate(sizeof(TraitBranchEvent)))
+        TraitBranchEvent(betaInit, betaShiftInit,
         isTimeVariable, _tree->getRoot(), _tree, _random, 0);
     _rootEvent = x;
     _lastEventModified = x;
@@ -79,10 +85,11 @@ TraitModel::TraitModel(Random& random, Settings& settings) :
     _tree->setMeanBranchTraitRates();
 
     // Initialize by previous event histories (or from initial event number)
-    if (_settings.get<bool>("loadEventData")) {
-        initializeModelFromEventDataFile(_settings.get("eventDataInfile"));
+    const ModelSettings& modelSettings = _settings.modelSettings();
+    if (modelSettings.loadEventData) {
+        initializeModelFromEventDataFile(modelSettings.eventDataInfile);
     } else {
-        int initialNumberOfEvents = _settings.get<int>("initialNumberEvents");
+        int initialNumberOfEvents = modelSettings.initialNumberEvents;
         for (int i = 0; i < initialNumberOfEvents; i++) {
             addRandomEventToTree();
         }
@@ -103,11 +110,14 @@ TraitModel::TraitModel(Random& random, Settings& settings) :
     }
 
     // Add proposals
-    _proposals.push_back(new BetaInitProposal(random, settings, *this, _prior));
-    _proposals.push_back
-        (new BetaShiftProposal(random, settings, *this, _prior));
-    _proposals.push_back(new NodeStateProposal(random, settings, *this));
-    _proposals.push_back(new BetaTimeModeProposal(random, settings, *this));
+    addProposal(new BetaInitProposal(random, settings, *this, _prior),
+        "betaInit");
+    addProposal(new BetaShiftProposal(random, settings, *this, _prior),
+        "betaShift");
+    addProposal(new NodeStateProposal(random, settings, *this),
+        "nodeState");
+    addProposal(new BetaTimeModeProposal(random, settings, *this),
+        "betaTimeMode");
 
  
     Model::calculateUpdateWeights();
@@ -133,7 +143,8 @@ BranchEvent* TraitModel::newBranchEventWithReadParameters
     double betaShift = betaShiftParameter(parameters);
 
     // TODO: Return true for now for time-variable
-    return new TraitBranchEvent(betaInit, betaShift, true,
+    return new (_eventPool.allocate(sizeof(TraitBranchEvent)))
+        TraitBranchEvent(betaInit, betaShift, true,
             x, _tree, _random, time);
 }
 
@@ -180,7 +191,8 @@ BranchEvent* TraitModel::newBranchEventWithRandomParameters(double x)
         _logQRatioJump += dens_term + _prior.betaShiftPrior(newBetaShift);
     }
 
-    return new TraitBranchEvent(newbeta, newBetaShift, newIsTimeVariable,
+    return new (_eventPool.allocate(sizeof(TraitBranchEvent)))
+        TraitBranchEvent(newbeta, newBetaShift, newIsTimeVariable,
         _tree->mapEventToTree(x), _tree, _random, x);
 }
 
@@ -191,8 +203,8 @@ BranchEvent* TraitModel::newBranchEventWithParametersFromSettings(double x)
 {
     
     // x is map time
-    double newbeta = _settings.get<double>("betaInit0");
-    double newBetaShift = _settings.get<double>("betaShift0");
+    double newbeta = _settings.traitSettings().betaInit;
+    double newBetaShift = _settings.traitSettings().betaShiftInit;
     bool newIsTimeVariable = _prior.generateBetaIsTimeVariableFromPrior();
 
     
@@ -212,8 +224,9 @@ BranchEvent* TraitModel::newBranchEventWithParametersFromSettings(double x)
         _logQRatioJump += dens_term + _prior.betaShiftPrior(newBetaShift);
     }
     
-    return new TraitBranchEvent(newbeta, newBetaShift, newIsTimeVariable,
-                                _tree->mapEventToTree(x), _tree, _random, x);
+    return new (_eventPool.allocate(sizeof(TraitBranchEvent)))
+        TraitBranchEvent(newbeta, newBetaShift, newIsTimeVariable,
+        _tree->mapEventToTree(x), _tree, _random, x);
     
 }
 
@@ -242,15 +255,54 @@ double TraitModel::calculateLogQRatioJump()
 
 BranchEvent* TraitModel::newBranchEventFromLastDeletedEvent()
 {
-    return new TraitBranchEvent(_lastDeletedEventBetaInit,
+    return new (_eventPool.allocate(sizeof(TraitBranchEvent)))
+        TraitBranchEvent(_lastDeletedEventBetaInit,
         _lastDeletedEventBetaShift, _lastDeletedEventTimeVariable,
         _tree->mapEventToTree(_lastDeletedEventMapTime), _tree, _random,
         _lastDeletedEventMapTime);
 }
 
 
+BranchEvent* TraitModel::newBranchEventCopy(BranchEvent* event)
+{
+    TraitBranchEvent* traitEvent = static_cast<TraitBranchEvent*>(event);
+
+    return new (_eventPool.allocate(sizeof(TraitBranchEvent)))
+        TraitBranchEvent(traitEvent->getBetaInit(),
+        traitEvent->getBetaShift(), traitEvent->isTimeVariable(),
+        _tree->mapEventToTree(event->getMapTime()), _tree, _random,
+        event->getMapTime());
+}
+
+
+void TraitModel::copyEventParameters(BranchEvent* to, BranchEvent* from)
+{
+    TraitBranchEvent* traitTo = static_cast<TraitBranchEvent*>(to);
+    TraitBranchEvent* traitFrom = static_cast<TraitBranchEvent*>(from);
+
+    traitTo->setBetaInit(traitFrom->getBetaInit());
+    traitTo->setBetaShift(traitFrom->getBetaShift());
+    traitTo->setTimeVariable(traitFrom->isTimeVariable());
+}
+
+
+// Both trees are read from the same file, so their nodes are
+// in the same order
+void TraitModel::copyModelParameters(Model& model)
+{
+    const std::vector<Node*>& nodes = _tree->postOrderNodes();
+    const std::vector<Node*>& otherNodes = model.getTreePtr()->postOrderNodes();
+
+    for (int i = 0; i < (int)nodes.size(); i++) {
+        nodes[i]->setTraitValue(otherNodes[i]->getTraitValue());
+    }
+}
+
+
 double TraitModel::computeLogLikelihood()
 {
+    ScopedPhaseTimer timer(_proposalTimer, ProposalTimer::Likelihood);
+
 
     double LnL = 0.0;
 
@@ -266,18 +318,21 @@ double TraitModel::computeLogLikelihood()
 
     // iterate over non-root nodes and compute LnL
 
+    // Gather the branch contrasts first so that the densities
+    // are evaluated in a single (vectorizable) pass
+    int numBranches = 0;
+
     const std::vector<Node*>& postOrderNodes = _tree->postOrderNodes();
     for (int i = 0; i < numNodes; i++) {
         Node* xnode = postOrderNodes[i];
         if ( (xnode != _tree->getRoot()) && (xnode->getCanHoldEvent() == true) ) {
 
-
-            double var = xnode->getBrlen() * xnode->getMeanBeta();
-
-            // change in phenotype:
-            double delta = xnode->getTraitValue() - xnode->getAnc()->getTraitValue();
-
-            LnL += Stat::lnNormalPDF(delta, 0.0, std::sqrt(var));
+            // change in phenotype and its variance along the branch:
+            _branchTraitDeltas[numBranches] =
+                xnode->getTraitValue() - xnode->getAnc()->getTraitValue();
+            _branchTraitVariances[numBranches] =
+                xnode->getBrlen() * xnode->getMeanBeta();
+            numBranches++;
 
             //std::cout << xnode << "dz: " << delta << "\tT: " << xnode->getBrlen() << "\tRate: " << xnode->getMeanBeta();
             //std::cout << "\tLf: " << _rng->lnNormalPdf(0, var, delta) << std::endl;
@@ -291,6 +346,9 @@ double TraitModel::computeLogLikelihood()
 
     }
 
+    LnL = Stat::sumLnNormalPDFVar(&_branchTraitDeltas[0],
+        &_branchTraitVariances[0], numBranches);
+
 #endif
 
     return LnL;
@@ -321,7 +379,7 @@ double TraitModel::computeTriadLikelihoodTraits(Node* x)
             double delta = x->getLfDesc()->getTraitValue() - x->getTraitValue();
             double var = x->getLfDesc()->getBrlen() *
                 x->getLfDesc()->getMeanBeta();
-            logL += Stat::lnNormalPDF(delta, 0.0, std::sqrt(var));
+            logL += Stat::lnNormalPDFVar(delta, 0.0, var);
         }
 
 
@@ -330,7 +388,7 @@ double TraitModel::computeTriadLikelihoodTraits(Node* x)
             double delta = x->getRtDesc()->getTraitValue() - x->getTraitValue();
             double var = x->getRtDesc()->getBrlen() *
                 x->getRtDesc()->getMeanBeta();
-            logL += Stat::lnNormalPDF(delta, 0.0, std::sqrt(var));
+            logL += Stat::lnNormalPDFVar(delta, 0.0, var);
         }
 
 
@@ -340,7 +398,7 @@ double TraitModel::computeTriadLikelihoodTraits(Node* x)
 
             double delta = x->getTraitValue() - x->getAnc()->getTraitValue();
             double var = x->getBrlen() * x->getMeanBeta();
-            logL += Stat::lnNormalPDF(delta, 0.0, std::sqrt(var));
+            logL += Stat::lnNormalPDFVar(delta, 0.0, var);
         }
     }
 
@@ -355,6 +413,8 @@ double TraitModel::computeTriadLikelihoodTraits(Node* x)
 
 double TraitModel::computeLogPrior()
 {
+    ScopedPhaseTimer timer(_proposalTimer, ProposalTimer::Prior);
+
 #ifdef NEGATIVE_SHIFT_PARAM
     double dens_term = std::log(2.0);
 #else
@@ -41,6 +41,10 @@ private:
     virtual BranchEvent* newBranchEventWithParametersFromSettings(double x);
     virtual BranchEvent* newBranchEventFromLastDeletedEvent();
 
+    virtual BranchEvent* newBranchEventCopy(BranchEvent* event);
+    virtual void copyEventParameters(BranchEvent* to, BranchEvent* from);
+    virtual void copyModelParameters(Model& model);
+
     virtual void setMeanBranchParameters();
     virtual void setDeletedEventParameters(BranchEvent* be);
 
@@ -51,6 +55,10 @@ private:
 
     bool _sampleFromPriorOnly;
 
+    // Per-branch trait changes and variances (reused by each likelihood call)
+    std::vector<double> _branchTraitDeltas;
+    std::vector<double> _branchTraitVariances;
+
     double _lastDeletedEventBetaInit;;
     double _lastDeletedEventBetaShift;
     bool _lastDeletedEventTimeVariable;
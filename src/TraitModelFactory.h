@@ -10,6 +10,7 @@ class Model;
 class ModelDataWriter;
 
 class Random;
+class RandomStreams;
 class Settings;
 class Prior;
 
@@ -20,13 +21,14 @@ public:
 
     virtual ~TraitModelFactory() {}
 
-    virtual Model* createModel(Random& random, Settings& settings) const;
+    virtual Model* createModel(Random& random, const RandomStreams& streams,
+        Settings& settings) const;
     virtual ModelDataWriter* createModelDataWriter(Settings& settings) const;
 };
 
 
 inline Model* TraitModelFactory::createModel
-    (Random& random, Settings& settings) const
+    (Random& random, const RandomStreams&, Settings& settings) const
 {
     return new TraitModel(random, settings);
 }
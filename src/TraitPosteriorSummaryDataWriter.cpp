@@ -0,0 +1,35 @@
+#include "TraitPosteriorSummaryDataWriter.h"
+#include "PosteriorSummaryDataWriter.h"
+#include "TraitBranchEvent.h"
+#include "Node.h"
+
+class Settings;
+
+
+TraitPosteriorSummaryDataWriter::TraitPosteriorSummaryDataWriter
+    (Settings& settings) : PosteriorSummaryDataWriter(settings)
+{
+}
+
+
+TraitPosteriorSummaryDataWriter::~TraitPosteriorSummaryDataWriter()
+{
+}
+
+
+double TraitPosteriorSummaryDataWriter::branchRate(Node* node, int)
+{
+    return node->getMeanBeta();
+}
+
+
+double TraitPosteriorSummaryDataWriter::rateAtTime
+    (BranchEvent* event, double time, int)
+{
+    TraitBranchEvent* specificEvent = static_cast<TraitBranchEvent*>(event);
+    Node* node = specificEvent->getEventNode();
+    double relativeTime = time - specificEvent->getAbsoluteTime();
+
+    return node->getExponentialRate(specificEvent->getBetaInit(),
+        specificEvent->getBetaShift(), relativeTime);
+}
@@ -0,0 +1,41 @@
+#ifndef TRAIT_POSTERIOR_SUMMARY_DATA_WRITER_H
+#define TRAIT_POSTERIOR_SUMMARY_DATA_WRITER_H
+
+
+#include "PosteriorSummaryDataWriter.h"
+#include <string>
+
+class Settings;
+class Node;
+class BranchEvent;
+
+
+class TraitPosteriorSummaryDataWriter : public PosteriorSummaryDataWriter
+{
+public:
+
+    TraitPosteriorSummaryDataWriter(Settings& settings);
+    virtual ~TraitPosteriorSummaryDataWriter();
+
+private:
+
+    virtual int numberOfRates();
+    virtual std::string rateName(int rate);
+    virtual double branchRate(Node* node, int rate);
+    virtual double rateAtTime(BranchEvent* event, double time, int rate);
+};
+
+
+inline int TraitPosteriorSummaryDataWriter::numberOfRates()
+{
+    return 1;
+}
+
+
+inline std::string TraitPosteriorSummaryDataWriter::rateName(int)
+{
+    return "beta";
+}
+
+
+#endif
@@ -7,6 +7,7 @@
 #include "TraitBranchEvent.h"
 #include "Log.h"
 #include "Stat.h"
+#include "SamplingFractions.h"
 
 #include <cstdlib>
 #include <fstream>
@@ -15,11 +16,12 @@
 #include <cmath>
 #include <iomanip>
 #include <algorithm>
+#include <limits>
 
 
 Tree::Tree(Random& random, Settings& settings) : _random(random)
 {
-    readTree(settings.get("treefile"));
+    readTree(settings.get("treefile"), settings.get<int>("treeNumber"));
 
     setPreOrderNodes(root);
     setPostOrderNodes(root);
@@ -35,7 +37,7 @@ Tree::Tree(Random& random, Settings& settings) : _random(random)
     if (settings.get<bool>("checkUltrametric")) {
         assertTreeIsUltrametric();
     }
-    assertTipsHaveUniqueNames();
+    setTipIndices();
 
     // Output stuff here
     log() << "Tree contains " << getNumberTips() << " taxa.\n";
@@ -47,6 +49,7 @@ Tree::Tree(Random& random, Settings& settings) : _random(random)
     _treeLength = calculateTreeLength();
 
     setInternalNodes();
+    setCladeRanges();
     setNodeTipCounts();
 
     // Initialize tree according to model type
@@ -69,6 +72,8 @@ Tree::Tree(Random& random, Settings& settings) : _random(random)
         getPhenotypesMissingLatent(settings.get("traitfile"));
         initializeTraitValues();
     }
+
+    setMapBins();
 }
 
 
@@ -94,6 +99,30 @@ void Tree::setInternalNodes()
 }
 
 
+// In _preOrderNodes, the clade of a node ends where that of its right
+// descendant (visited last) ends, so the ends are set from the tips up
+void Tree::setCladeRanges()
+{
+    int numberOfNodes = (int)_preOrderNodes.size();
+
+    _cladeEnds.assign(numberOfNodes, 0);
+    for (int i = numberOfNodes - 1; i >= 0; --i) {
+        Node* node = _preOrderNodes[i];
+        if (node->getRtDesc() != NULL) {
+            _cladeEnds[i] = _cladeEnds[node->getRtDesc()->getPreOrderIndex()];
+        } else {
+            _cladeEnds[i] = i + 1;
+        }
+    }
+
+    _internalNodesBefore.assign(numberOfNodes + 1, 0);
+    for (int i = 0; i < numberOfNodes; ++i) {
+        _internalNodesBefore[i + 1] = _internalNodesBefore[i] +
+            (_preOrderNodes[i]->isInternal() ? 1 : 0);
+    }
+}
+
+
 void Tree::setNodeTipCounts()
 {
     for (int i = 0; i < (int)_preOrderNodes.size(); ++i) {
@@ -106,6 +135,7 @@ void Tree::setNodeTipCounts()
 void Tree::setPreOrderNodes(Node* node)
 {
     if (node != NULL) {
+        node->setPreOrderIndex((int)_preOrderNodes.size());
         _preOrderNodes.push_back(node);
         setPreOrderNodes(node->getLfDesc());
         setPreOrderNodes(node->getRtDesc());
@@ -169,6 +199,7 @@ void Tree::setTreeMap(Node* p)
     p->setMapStart(_totalMapLength);
     _totalMapLength += p->getBrlen();
     p->setMapEnd(_totalMapLength);
+    _mapNodes.push_back(p);
 
     if (p->getRtDesc() != NULL) {
         if (p->getRtDesc()->getCanHoldEvent()) {
@@ -182,6 +213,47 @@ void Tree::setTreeMap(Node* p)
     }
 }
 
+
+// There are as many bins as mappable branches, so a bin holds
+// few branches unless the branch lengths are very uneven
+void Tree::setMapBins()
+{
+    int numberOfBins = std::max((int)_mapNodes.size(), 1);
+    _mapBinWidth = _totalMapLength / numberOfBins;
+
+    _mapBins.assign(numberOfBins, 0);
+    int first = 0;
+    for (int b = 0; b < numberOfBins; b++) {
+        while (first < (int)_mapNodes.size() &&
+                _mapNodes[first]->getMapEnd() < b * _mapBinWidth) {
+            first++;
+        }
+        _mapBins[b] = first;
+    }
+}
+
+
+// Map ends increase along _mapNodes; returns _mapNodes.size() if
+// x is beyond the end of the map. The scan also steps back, in case
+// rounding put x in the bin after its own.
+int Tree::firstMapNodeEndingAtOrAfter(double x)
+{
+    int b = 0;
+    if (x > 0.0 && _mapBinWidth > 0.0) {
+        b = std::min((int)(x / _mapBinWidth), (int)_mapBins.size() - 1);
+    }
+
+    int i = _mapBins[b];
+    while (i > 0 && _mapNodes[i - 1]->getMapEnd() >= x) {
+        i--;
+    }
+    while (i < (int)_mapNodes.size() && _mapNodes[i]->getMapEnd() < x) {
+        i++;
+    }
+
+    return i;
+}
+
 /*
 
  Function to recover absolute time (0 at root, T at present)
@@ -190,17 +262,21 @@ void Tree::setTreeMap(Node* p)
  */
 
 // Should NEVER be applied to value of 0.0 (eg at the root).
+// Each branch holds [start, end) here, unlike in mapEventToTree().
 double Tree::getAbsoluteTimeFromMapTime(double x)
 {
     double abstime = 0.0;
     bool done = false;
-    for (std::vector<Node*>::iterator i = _preOrderNodes.begin();
-            i != _preOrderNodes.end(); ++i) {
-        if (x >= (*i)->getMapStart()  && x < (*i)->getMapEnd()) {
-            double delta = x - (*i)->getMapStart(); // difference in times...
-            abstime = (*i)->getTime() - delta;
-            done = true;
-        }
+
+    int i = firstMapNodeEndingAtOrAfter(x);
+    while (i < (int)_mapNodes.size() && _mapNodes[i]->getMapEnd() == x) {
+        i++;
+    }
+
+    if (i < (int)_mapNodes.size() && x >= _mapNodes[i]->getMapStart()) {
+        double delta = x - _mapNodes[i]->getMapStart(); // difference in times...
+        abstime = _mapNodes[i]->getTime() - delta;
+        done = true;
     }
     if (done == false) {
         std::cout << "could not find abs time from map time \n";
@@ -214,33 +290,23 @@ double Tree::getAbsoluteTimeFromMapTime(double x)
 // Get number of descendant nodes from a given node
 int Tree::getDescNodeCount(Node* p)
 {
-    int count = 0;
-    if (p->getLfDesc() != NULL) {
-        count++;
-        count += getDescNodeCount(p->getLfDesc());
-    }
-    if (p->getRtDesc() != NULL) {
-        count++;
-        count += getDescNodeCount(p->getRtDesc());
-    }
-    return count;
+    return cladeEnd(p) - cladeBegin(p) - 1;
 }
 
 /*
  mapEventToTree
  Event is mapped to tree by map value; each "mappable" branch
  on tree has start and end values for mapping that define a unique interval
- of a real number line.
+ of a real number line, (start, end].
+ The branch is found through the map bins in (expected) constant time.
  */
 
 Node* Tree::mapEventToTree(double x)
 {
     Node* y = NULL;
-    for (std::set<Node*>::iterator i = mappableNodes.begin();
-            i != mappableNodes.end(); i++) {
-        if ( x > (*i)->getMapStart() && x <= (*i)->getMapEnd()) {
-            y = (*i);
-        }
+    int i = firstMapNodeEndingAtOrAfter(x);
+    if (i < (int)_mapNodes.size() && x > _mapNodes[i]->getMapStart()) {
+        y = _mapNodes[i];
     }
     if (y == NULL) {
         std::cout << "error: unmapped event\n" << std::endl;
@@ -261,50 +327,6 @@ void Tree::printNodeMap()
 }
 
 
-// This requires that p be an internal node to begin with!
-void Tree::setTempInternalNodeArray(Node* p)
-{
-    if (p->getRtDesc() == NULL && p->getLfDesc() == NULL) {
-        std::cout << "Problem: sent terminal node to setTempInternalNodeArray" << std::endl;
-        throw;
-    }
-    tempNodeSetPassDown(p);
-}
-
-
-void Tree::tempNodeSetPassDown(Node* p)
-{
-    if (p->getLfDesc() != NULL && p->getRtDesc() != NULL) {
-        _tempNodeSet.insert(p);
-        tempNodeSetPassDown(p->getLfDesc());
-        tempNodeSetPassDown(p->getRtDesc());
-    }
-}
-
-
-void Tree::clearTempNodeArray()
-{
-    _tempNodeSet.clear();
-}
-
-
-Node* Tree::getRandomNodeFromTempArray()
-{
-    int chosen = _random.uniformInteger(0, (int)_tempNodeSet.size() - 1);
-    int myit = 0;
-    Node* xnode = (*_tempNodeSet.begin());
-
-    for (std::set<Node*>::iterator i = _tempNodeSet.begin();
-            i != _tempNodeSet.end(); i++) {
-        if (myit == chosen) {
-            xnode = (*i);
-        }
-        myit++;
-    }
-    return xnode;
-}
-
-
 Node* Tree::getRandomNonRootNode()
 {
     // Start at index = 1 because the root is at index = 0
@@ -468,20 +490,20 @@ void Tree::setIsLivingTipStatus()
 }
 
 
+// After nodes have been removed, rebuilds the node lists and everything
+// indexed by pre-order position (clade ranges, tip counts and indices)
 void Tree::rebuildTreeNodeSet()
 {
     _preOrderNodes.clear();
-    recursivelyAddNodesToSet(root);
-}
+    _postOrderNodes.clear();
+    _internalNodes.clear();
 
-
-void Tree::recursivelyAddNodesToSet(Node* p)
-{
-    if (p != NULL) {
-        _preOrderNodes.push_back(p);
-        recursivelyAddNodesToSet(p->getLfDesc());
-        recursivelyAddNodesToSet(p->getRtDesc());
-    }
+    setPreOrderNodes(root);
+    setPostOrderNodes(root);
+    setInternalNodes();
+    setCladeRanges();
+    setNodeTipCounts();
+    setTipIndices();
 }
 
 
@@ -645,17 +667,34 @@ void Tree::deleteExtinctNodes()
 }
 
 
-void Tree::readTree(const std::string& treeFileName)
+void Tree::readTree(const std::string& treeFileName, int treeNumber)
 {
     std::ifstream treeFileStream(treeFileName.c_str());
 
-    log() << "\nReading tree from file <" << treeFileName << ">.\n";
+    if (treeNumber == 1) {
+        log() << "\nReading tree from file <" << treeFileName << ">.\n";
+    } else {
+        log() << "\nReading tree " << treeNumber << " from file <"
+              << treeFileName << ">.\n";
+    }
 
     if (!treeFileStream.good()) {
         log(Error) << "Invalid file name for phylogenetic tree\n";
         std::exit(1);
     }
 
+    // Skip the trees before the requested one (each ends with a semicolon)
+    for (int i = 1; i < treeNumber; i++) {
+        treeFileStream.ignore(std::numeric_limits<std::streamsize>::max(), ';');
+    }
+    treeFileStream >> std::ws;
+
+    if (treeNumber < 1 || !treeFileStream.good()) {
+        log(Error) << "Tree " << treeNumber << " is not in file <"
+                   << treeFileName << ">.\n";
+        std::exit(1);
+    }
+
     _treeReader.read(treeFileStream, *this);
 }
 
@@ -792,6 +831,15 @@ void Tree::setMeanBranchExtinction()
 }
 
 
+void Tree::setStateLog(StateLog* stateLog)
+{
+    for (std::vector<Node*>::iterator i = _preOrderNodes.begin();
+            i != _preOrderNodes.end(); ++i) {
+        (*i)->setStateLog(stateLog);
+    }
+}
+
+
 void Tree::echoMeanBranchRates()
 {
     for (std::vector<Node*>::iterator i = _preOrderNodes.begin();
@@ -942,6 +990,24 @@ void Tree::writeBranchPhenotypes(Node* p, std::ostream& out)
 }
 
 
+void Tree::writeBranchLengthTree(Node* p, std::ostream& out)
+{
+    if (p->getLfDesc() == NULL && p-> getRtDesc() == NULL) {
+        if (p->getName() == "") {
+            out << p->getIndex() << ":" << p->getBrlen();
+        } else {
+            out << p->getName() << ":" << p->getBrlen();
+        }
+    } else {
+        out << "(";
+        writeBranchLengthTree(p->getLfDesc(), out);
+        out << ",";
+        writeBranchLengthTree(p->getRtDesc(), out);
+        out << "):" << p->getBrlen();
+    }
+}
+
+
 /*
 Tree::getPhenotypes
 Read file. First column = species name exactly as matching in phylogeny.
@@ -1033,17 +1099,20 @@ void Tree::getPhenotypesMissingLatent(std::string fileName)
 
     log() << "Read " << traitValues.size() << " species with trait data.\n";
 
+    // Species that are not in the tree are ignored
+    for (int k = 0; k < (int)speciesNames.size(); k++) {
+        Node* tip = findTip(speciesNames[k]);
+        if (tip != NULL) {
+            tip->setTraitValue(traitValues[k]);
+            tip->setIsTraitFixed(true);
+        }
+    }
+
     int missingTerminalCount = 0;
 
     for (std::vector<Node*>::iterator i = _preOrderNodes.begin();
             i != _preOrderNodes.end(); ++i) {
         if ((*i)->getLfDesc() == NULL && (*i)->getRtDesc() == NULL ) {
-            for (int k = 0; k < (int)speciesNames.size(); k++) {
-                if ((*i)->getName() == speciesNames[k]) {
-                    (*i)->setTraitValue(traitValues[k]);
-                    (*i)->setIsTraitFixed(true);
-                }
-            }
             if ((*i)->getIsTraitFixed() == false) {
                 missingTerminalCount++;
             }
@@ -1099,13 +1168,22 @@ void Tree::generateTraitsAllNodesBM(Node* xnode, double varx)
 
 Node* Tree::chooseInternalNodeAtRandom()
 {
-    int snode = _random.uniformInteger(0, (int)_internalNodes.size() - 1);
-    std::vector<Node*>::iterator myIt = _internalNodes.begin();
+    return chooseInternalNodeAtRandom(root);
+}
+
 
-    for (int i = 0; i < snode; i++ ) {
-        myIt++;
+// This requires that clade be an internal node to begin with!
+Node* Tree::chooseInternalNodeAtRandom(Node* clade)
+{
+    int first = internalCladeBegin(clade);
+    int last = internalCladeEnd(clade) - 1;
+    if (last < first) {
+        log(Error) << "Sent terminal node to "
+            << "Tree::chooseInternalNodeAtRandom(...)\n";
+        std::exit(1);
     }
-    return  (*myIt);
+
+    return _internalNodes[_random.uniformInteger(first, last)];
 }
 
 
@@ -1166,111 +1244,30 @@ void Tree::initializeSpeciationExtinctionModel(std::string fname)
     // TODO: this check for ultrametric must be more informative
     
     assertTreeIsUltrametric();
-    
-    std::ifstream infile(fname.c_str());
-
-    
-    
-    if (!infile.good()) {
-        log(Error) << "Bad sampling fraction file.\n";
-        std::exit(1);
-    }
-
-    log() << "Reading sampling fractions from file <<" << fname << ">>...\n";
-
-    std::vector<std::string> stringvec;
-    std::vector<std::string> spnames;
-    std::vector<std::string> spfamilies;
-    std::vector<double> sfracs;
-
-    std::string tempstring;
-
-    // First number in file is sampling probability for "backbone" of the tree
-    getline(infile, tempstring, '\n');
-    double backboneSampProb = std::atof(tempstring.c_str());
-    double backboneInitial = 1.0 - backboneSampProb;
-
-    // std::atof returns 0.0 if the conversion fails
-    if (backboneSampProb == 0.0) {
-        log(Error) << "The first line of the sampling probability file\n"
-                   << "must be the global sampling probability (> 0.0).\n";
-        std::exit(1);
-    }
-
-    while (infile) {
-        getline(infile, tempstring);
-        std::istringstream inStream(tempstring);
-
-        std::string spname;
-        std::string spfamily;
-        double sfrac = 0.0;
-
-        bool eof = false;
-
-        eof = inStream.eof();
-        inStream >> spname;
 
-        eof = inStream.eof();
-        inStream >> spfamily;
+    // The file is read once and shared by the trees of all chains
+    const SamplingFractions& fractions = SamplingFractions::load(fname);
+    crossValidateSpecies(fractions);
 
-        eof = inStream.eof();
-        inStream >> sfrac;
-
-        if (eof) {
-            log(Error) << "Sampling probability file is not formatted "
-                       << "properly.\nPlease see the documentation.\n";
-            std::exit(1);
-        }
-
-        if (sfrac <= 0.0 || sfrac > 1.0) {
-            log(Error) << "In line with species <<" << spname << ">> and "
-                       << "family name\n<<" << spfamily << ">>, "
-                       << "sampling fraction must be greater than 0 and less\n"
-                       << "than or equal to 1. This error may also occur if\n"
-                       << "the input line is not formatted properly.\n";
-            std::exit(1);
-        }
-
-        spnames.push_back(spname);
-        spfamilies.push_back(spfamily);
-        sfracs.push_back(sfrac);
-
-        if (infile.peek() == EOF) {
-            break;
-        }
-    }
-
-    infile.close();
-
-    std::cout << "Read a total of " << sfracs.size() << " initial values.\n";
-
-    crossValidateSpecies(spnames);
+    double backboneInitial = 1.0 - fractions.backboneFraction();
+    const std::vector<std::string>& cladeNames = fractions.cladeNames();
 
     int counter = 0;
     for (std::vector<Node*>::iterator i = _postOrderNodes.begin();
             i != _postOrderNodes.end(); i++) {
 
         if ((*i)->getLfDesc() == NULL && (*i)->getRtDesc() == NULL ) {
-            for (std::vector<std::string>::size_type k = 0; k < spnames.size(); k++) {
-                if ((*i)->getName() == spnames[k]) {
-                    double Einit = (double)1 - sfracs[k];
-                    double Dinit = sfracs[k];
-
-                    (*i)->setEinit(Einit);
-                    (*i)->setEtip(Einit);
-                    (*i)->setDinit(Dinit);
-                    (*i)->setCladeName(spfamilies[k]);
-                    counter++;
-                }
-                //std::cout << spfamilies[k] << std::endl;
-            }
+            const SamplingFractions::Species* species =
+                fractions.findSpecies((*i)->getName());
 
-            if ((*i)->getEinit() == -1) {
-                log(Warning) << "The species " << (*i)->getName() << " "
-                    << "has an E_init value of -1.\n"
-                    << "Check that this species is spelled correctly "
-                    << "in the sampling file.\n";
-            }
+            double Einit = (double)1 - species->fraction;
+            double Dinit = species->fraction;
+
+            (*i)->setEinit(Einit);
+            (*i)->setEtip(Einit);
+            (*i)->setDinit(Dinit);
+            (*i)->setCladeName(cladeNames[species->clade]);
+            counter++;
         } else {
             // Node is internal
             if ((*i)->getLfDesc()->getCladeName() == (*i)->getRtDesc()->getCladeName()) {
@@ -1304,24 +1301,23 @@ void Tree::initializeSpeciationExtinctionModel(std::string fname)
 }
 
 
-// Assert that all elements in species are in the tree and vice versa
-void Tree::crossValidateSpecies(const std::vector<std::string>& species)
+// Assert that all species in the file are in the tree and vice versa
+void Tree::crossValidateSpecies(const SamplingFractions& fractions)
 {
-    const std::vector<std::string>& treeSpecies = terminalNames();
-
-    assertIsSubset(species, treeSpecies, "tree");
-    assertIsSubset(treeSpecies, species, "file");
-}
-
+    const std::vector<std::string>& species = fractions.speciesNames();
+    for (std::vector<std::string>::const_iterator it = species.begin();
+            it != species.end(); ++it) {
+        if (findTip(*it) == NULL) {
+            log(Error) << "<<" << *it << ">> is not in tree.\n";
+            std::exit(1);
+        }
+    }
 
-void Tree::assertIsSubset(const std::vector<std::string>& list1,
-                          const std::vector<std::string>& list2,
-                          const std::string& list2Name)
-{
-    std::vector<std::string>::const_iterator it;
-    for (it = list1.begin(); it != list1.end(); ++it) {
-        if (std::find(list2.begin(), list2.end(), *it) == list2.end()) {
-            log(Error) << "<<" << *it << ">> is not in " << list2Name << ".\n";
+    for (std::vector<Node*>::iterator i = _preOrderNodes.begin();
+            i != _preOrderNodes.end(); ++i) {
+        if ((*i)->getLfDesc() == NULL && (*i)->getRtDesc() == NULL &&
+                fractions.findSpecies((*i)->getName()) == NULL) {
+            log(Error) << "<<" << (*i)->getName() << ">> is not in file.\n";
             std::exit(1);
         }
     }
@@ -1362,16 +1358,11 @@ void Tree::setCanNodeBeMapped(int ndesc)
 }
 
 
+// Every node of the clade that is not internal is a tip
 int Tree::getDescTipCount(Node* p)
 {
-    int count = 0;
-    if ((p->getLfDesc() == NULL) & (p->getRtDesc() == NULL)) {
-        count++;
-    } else {
-        count += getDescTipCount(p->getLfDesc());
-        count += getDescTipCount(p->getRtDesc());
-    }
-    return count;
+    return (cladeEnd(p) - cladeBegin(p)) -
+        (internalCladeEnd(p) - internalCladeBegin(p));
 }
 
 /*
@@ -1383,12 +1374,11 @@ int Tree::getDescTipCount(Node* p)
 int Tree::countDescendantsWithValidTraitData(Node* p)
 {
     int count = 0;
-    if ((p->getLfDesc() == NULL) && (p->getRtDesc() == NULL)) {
-        if (p->getIsTraitFixed())
+    for (int i = cladeBegin(p); i < cladeEnd(p); i++) {
+        Node* node = _preOrderNodes[i];
+        if (!node->isInternal() && node->getIsTraitFixed()) {
             count++;
-    } else {
-        count += countDescendantsWithValidTraitData(p->getLfDesc());
-        count += countDescendantsWithValidTraitData(p->getRtDesc());
+        }
     }
     return count;
 }
@@ -1428,7 +1418,12 @@ void Tree::setTreeMap(int ndesc)
 {
     // set bool flag on each node, depending on whether event can be mapped...
     setCanNodeBeMapped(ndesc);
+
+    // Start over if the tree has already been mapped
+    _mapNodes.clear();
+    _totalMapLength = 0.0;
     setTreeMap(root);
+    setMapBins();
     std::cout << "Map length: " << getTotalMapLength() << std::endl;
     std::cout << "Total mappable nodes: " << mappableNodes.size() << std::endl;
 }
@@ -1695,23 +1690,12 @@ Node* Tree::getNodeMRCA(const std::string& A, const std::string& B)
 {
     //std::cout << "MRCA of " << A << "\t" << B << std::endl;
 
-    Node* nodeA = NULL;
-    Node* nodeB = NULL;
-    bool Agood = false;
-    bool Bgood = false;
-
-    clearTempNodeArray();
-    for (std::vector<Node*>::iterator i = _preOrderNodes.begin();
-            i != _preOrderNodes.end(); ++i) {
-        if ((*i)->getName() == A) {
-            nodeA = (*i);
-            Agood = true;
-        }
-        if ((*i)->getName() == B) {
-            nodeB = (*i);
-            Bgood = true;
-        }
-    }
+    int countA;
+    int countB;
+    Node* nodeA = findNodeByName(A, countA);
+    Node* nodeB = findNodeByName(B, countB);
+    bool Agood = (nodeA != NULL);
+    bool Bgood = (nodeB != NULL);
 
     if (!Agood | !Bgood) {
         log(Error) << "Invalid nodes " << A << " and " << B
@@ -1720,47 +1704,19 @@ Node* Tree::getNodeMRCA(const std::string& A, const std::string& B)
         throw;
     }
 
-    passUpFillTempNodeArray(nodeA);
-    //std::cout << _tempNodeSet.size() << std::endl;
-
-    bool isFoundMRCA = false;
-    while (!isFoundMRCA) {
+    // The first ancestor of B whose clade holds A
+    do {
         nodeB = nodeB->getAnc();
-        //std::cout << nodeB << std::endl;
-        if (_tempNodeSet.count(nodeB) > 0) {
-            //std::cout << nodeB << " in common" << std::endl;
-            break;
-        }
-    }
-    //std::cout << std::endl << std::endl;
-    //std::cout << nodeB << std::endl;
-    //for (std::set<Node*>::iterator i = _tempNodeSet.begin(); i != _tempNodeSet.end(); i++)
-    //  std::cout << "From A: " << (*i) << std::endl;
-    clearTempNodeArray();
-    return nodeB;
-}
-
+    } while (!isInClade(nodeA, nodeB));
 
-void Tree::passUpFillTempNodeArray(Node* x)
-{
-    if (x != NULL) {
-        _tempNodeSet.insert(x);
-        passUpFillTempNodeArray(x->getAnc());
-    }
+    return nodeB;
 }
 
 
 Node* Tree::getNodeByName(const std::string& A)
 {
-    Node* x = root;
-    int count = 0;
-    for (std::vector<Node*>::iterator i = _preOrderNodes.begin();
-            i != _preOrderNodes.end(); ++i) {
-        if ((*i)->getName() == A) {
-            count++;
-            x = (*i);
-        }
-    }
+    int count;
+    Node* x = findNodeByName(A, count);
     if (count == 0) {
         std::cout << "Invalid node name: name not found in Tree:: getNodeByName" << std::endl;
         exit(0);
@@ -1896,50 +1852,56 @@ void Tree::assertTreeIsUltrametric()
 }
 
 
-void Tree::assertTipsHaveUniqueNames()
+// Also asserts that no two tips have the same name
+void Tree::setTipIndices()
 {
-    std::vector<std::string> names = terminalNames();
-
-    // Sort names
-    std::sort(names.begin(), names.end());
+    _tipIndices.clear();
+    _tipIndices.reserve(_preOrderNodes.size());
 
-    // Find consecutive duplicates
-    std::vector<std::string>::const_iterator it;
-    it = std::adjacent_find(names.begin(), names.end());
+    for (int i = 0; i < (int)_preOrderNodes.size(); ++i) {
+        Node* node = _preOrderNodes[i];
+        if (node->getLfDesc() != NULL || node->getRtDesc() != NULL) {
+            continue;
+        }
 
-    if (it != names.end()) {
-        log(Error) << "Tree contains tips with the same name.\n";
-        std::exit(1);
+        if (!_tipIndices.insert(std::make_pair(node->getName(), i)).second) {
+            log(Error) << "Tree contains tips with the same name.\n";
+            std::exit(1);
+        }
     }
 }
 
 
-std::vector<std::string> Tree::terminalNames()
+Node* Tree::findTip(const std::string& name) const
 {
-    std::vector<std::string> names;
-    storeTerminalNamesRecurse(getRoot(), names);
-    return names;
+    std::unordered_map<std::string, int>::const_iterator it =
+        _tipIndices.find(name);
+    return (it != _tipIndices.end()) ? _preOrderNodes[it->second] : NULL;
 }
 
 
-void Tree::storeTerminalNamesRecurse
-    (Node* node, std::vector<std::string>& names)
+// Tips are found through _tipIndices; internal nodes, which have names
+// only if the tree file labels them, are searched for. Returns the last
+// node found (in pre-order) and their number in count.
+Node* Tree::findNodeByName(const std::string& name, int& count)
 {
-    Node* leftNode = node->getLfDesc();
-    Node* rightNode = node->getRtDesc();
-
-    if (leftNode == NULL && rightNode == NULL) {
-        names.push_back(node->getName());
-        return;
+    Node* tip = findTip(name);
+    if (tip != NULL) {
+        count = 1;
+        return tip;
     }
 
-    if (leftNode != NULL) {
-        storeTerminalNamesRecurse(leftNode, names);
+    Node* node = NULL;
+    count = 0;
+    for (std::vector<Node*>::iterator i = _internalNodes.begin();
+            i != _internalNodes.end(); ++i) {
+        if ((*i)->getName() == name) {
+            node = (*i);
+            count++;
+        }
     }
 
-    if (rightNode != NULL) {
-        storeTerminalNamesRecurse(rightNode, names);
-    }
+    return node;
 }
 
 
@@ -6,6 +6,7 @@
 
 #include <string>
 #include <set>
+#include <unordered_map>
 #include <vector>
 #include <iosfwd>
 
@@ -17,6 +18,8 @@ class Phenotype;
 class BranchHistory;
 class TraitBranchHistory;
 class Node;
+class StateLog;
+class SamplingFractions;
 
 
 // The variance of the root-to-tip lengths must be less than
@@ -41,6 +44,7 @@ private:
 
     double calculateTreeLength();
     void setInternalNodes();
+    void setCladeRanges();
     void setNodeTipCounts();
 
     std::vector<double> terminalPathLengthsToRoot();
@@ -54,16 +58,15 @@ private:
     void assertBranchLengthsArePositive();
     void assertBranchLengthsArePositiveRecurse(Node* node);
     void assertTreeIsUltrametric();
-    void assertTipsHaveUniqueNames();
-    std::vector<std::string> terminalNames();
-    void storeTerminalNamesRecurse(Node* node, std::vector<std::string>& names);
+    void setTipIndices();
+    Node* findNodeByName(const std::string& name, int& count);
 
     void storeTerminalNodesRecurse(Node* node, std::vector<Node*>& nodes);
 
-    void crossValidateSpecies(const std::vector<std::string>& species);
-    void assertIsSubset(const std::vector<std::string>& list1,
-                        const std::vector<std::string>& list2,
-                        const std::string& list2Name);
+    void crossValidateSpecies(const SamplingFractions& fractions);
+
+    void setMapBins();
+    int firstMapNodeEndingAtOrAfter(double x);
 
     Random& _random;
 
@@ -73,10 +76,17 @@ private:
 
     std::vector<Node*> _internalNodes;
 
+    // A clade (a node and its descendants) is a contiguous range of
+    // _preOrderNodes, from the node to _cladeEnds[its pre-order index].
+    // _internalNodes is in pre-order, so the internal nodes of a clade
+    // are also contiguous; _internalNodesBefore[i] is the number of
+    // internal nodes in _preOrderNodes[0, i).
+    std::vector<int> _cladeEnds;
+    std::vector<int> _internalNodesBefore;
+
     double _startTime;
     double _tmax;
     bool _isExtant;
-    void recursivelyAddNodesToSet(Node* p);
     void rebuildTreeNodeSet();
     double _age; // time to root node, from present
 
@@ -95,7 +105,17 @@ private:
     std::set<Node*> mappableNodes;
     double _totalMapLength;
 
-    std::set<Node*> _tempNodeSet;
+    // Mappable nodes in map order, and for each of the equal bins that
+    // divide the map, the index in _mapNodes of the first node whose
+    // branch ends in or after the bin, so a map position is resolved
+    // to its branch by scanning only the branches in its bin
+    std::vector<Node*> _mapNodes;
+    std::vector<int> _mapBins;
+    double _mapBinWidth;
+
+    // Index in _preOrderNodes of the tip with each name, used by
+    // everything that looks up tips by name (data files, event data)
+    std::unordered_map<std::string, int> _tipIndices;
 
     NewickTreeReader _treeReader;
 
@@ -123,7 +143,18 @@ public:
     double getAbsoluteTimeFromMapTime(double x);
 
     int   getNumberOfNodes();
+    const std::vector<Node*>& preOrderNodes();
     const std::vector<Node*>& postOrderNodes();
+    const std::vector<Node*>& internalNodes();
+
+    // Clade ranges: the nodes of the clade of a node are
+    // preOrderNodes()[cladeBegin, cladeEnd), and its internal nodes
+    // internalNodes()[internalCladeBegin, internalCladeEnd)
+    int  cladeBegin(Node* clade);
+    int  cladeEnd(Node* clade);
+    int  internalCladeBegin(Node* clade);
+    int  internalCladeEnd(Node* clade);
+    bool isInClade(Node* node, Node* clade);
 
     // Count number of descendant nodes from a given node
     int getDescNodeCount(Node* p);
@@ -157,7 +188,8 @@ public:
     void writeNodeData();
     void setBranchLengths();
     void deleteExtinctNodes();
-    void readTree(const std::string& treeFileName);
+    // Reads the treeNumber-th tree (starting at 1) of the file
+    void readTree(const std::string& treeFileName, int treeNumber = 1);
     bool isValidChar(char x);
 
     void setNodeTimes();
@@ -180,6 +212,9 @@ public:
     void  recursiveSetTraitValues(Node* x, double mn, double mx);
     Node* chooseInternalNodeAtRandom();
 
+    // Uniform among the internal nodes of an internal node's clade
+    Node* chooseInternalNodeAtRandom(Node* clade);
+
     void   generateTraitsAllNodesBM(Node* xnode, double varx);
     void   generateTraitsAllNodesFromEventBeta(Node* xnode);
     void   printTraitRange();
@@ -195,6 +230,10 @@ public:
     
     void echoMeanBranchRates();
 
+    // Rates and branch history events set on the nodes are saved in
+    // the state log while it is recording
+    void setStateLog(StateLog* stateLog);
+
     void writeMeanBranchSpeciationTree(Node* p, std::stringstream& ss);
     void writeBranchSpeciationRatesToFile(std::string fname, bool append);
     void writeBranchExtinctionRatesToFile(std::string fname, bool append);
@@ -205,6 +244,7 @@ public:
 
     void writeMeanBranchNetDivRateTree(Node* p, std::stringstream& ss);
     void writeBranchPhenotypes(Node* p, std::ostream& out);
+    void writeBranchLengthTree(Node* p, std::ostream& out);
 
     // speciation-extinction initialization:
 
@@ -222,12 +262,6 @@ public:
 
     void setCanNodeBeMapped(int ndesc);
 
-    // Functions for random access of nodes from temporary nodeset array
-    void  setTempInternalNodeArray(Node* p);
-    void  tempNodeSetPassDown(Node* p);
-    void  clearTempNodeArray();
-    Node* getRandomNodeFromTempArray();
-
     Node* getRandomNonRootNode();
 
     void printNodeBranchRates();
@@ -235,9 +269,11 @@ public:
     void computeMeanTraitRatesByNode(Node* x);
 
     Node* getNodeMRCA(const std::string& A, const std::string& B);
-    void  passUpFillTempNodeArray(Node* x);
     Node* getNodeByName(const std::string& A);
 
+    // Returns the tip with the given name, or NULL if there is none
+    Node* findTip(const std::string& name) const;
+
     void printNodeTraitRates();
 
     void echoMeanBranchTraitRates();
@@ -259,12 +295,55 @@ inline int Tree::getNumberOfNodes()
 }
 
 
+inline const std::vector<Node*>& Tree::preOrderNodes()
+{
+    return _preOrderNodes;
+}
+
+
 inline const std::vector<Node*>& Tree::postOrderNodes()
 {
     return _postOrderNodes;
 }
 
 
+inline const std::vector<Node*>& Tree::internalNodes()
+{
+    return _internalNodes;
+}
+
+
+inline int Tree::cladeBegin(Node* clade)
+{
+    return clade->getPreOrderIndex();
+}
+
+
+inline int Tree::cladeEnd(Node* clade)
+{
+    return _cladeEnds[clade->getPreOrderIndex()];
+}
+
+
+inline int Tree::internalCladeBegin(Node* clade)
+{
+    return _internalNodesBefore[cladeBegin(clade)];
+}
+
+
+inline int Tree::internalCladeEnd(Node* clade)
+{
+    return _internalNodesBefore[cladeEnd(clade)];
+}
+
+
+inline bool Tree::isInClade(Node* node, Node* clade)
+{
+    int i = node->getPreOrderIndex();
+    return i >= cladeBegin(clade) && i < cladeEnd(clade);
+}
+
+
 inline void Tree::setStartTime(double x)
 {
     _startTime = x;
@@ -0,0 +1,170 @@
+#include "TreeBatch.h"
+
+#include "Random.h"
+#include "Settings.h"
+#include "ModelFactory.h"
+#include "MetropolisCoupledMCMC.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <cstdlib>
+
+
+TreeBatch::TreeBatch
+    (Random& random, Settings& settings, ModelFactory* modelFactory) :
+        _settings(settings), _modelFactory(modelFactory), _runInfo(NULL),
+        _nextTree(0)
+{
+    _numberOfTrees = countTrees(_settings.get("treefile"));
+    if (_numberOfTrees == 0) {
+        log(Error) << "No trees found in tree file <<"
+            << _settings.get("treefile") << ">>.\n";
+        std::exit(1);
+    }
+
+    _numberOfConcurrentTrees = _settings.get<int>("numberOfConcurrentTrees");
+    if (_numberOfConcurrentTrees < 1) {
+        log(Error) << "numberOfConcurrentTrees must be at least 1.\n";
+        std::exit(1);
+    }
+
+    for (int i = 0; i < _numberOfTrees; i++) {
+        _seeds.push_back(random.uniformInteger
+            (1, std::numeric_limits<int>::max()));
+    }
+}
+
+
+// Each tree ends with a semicolon
+int TreeBatch::countTrees(const std::string& treeFileName)
+{
+    std::ifstream treeFile(treeFileName.c_str());
+    if (!treeFile) {
+        log(Error) << "Could not read tree file <<" << treeFileName << ">>.\n";
+        std::exit(1);
+    }
+
+    return (int)std::count(std::istreambuf_iterator<char>(treeFile),
+        std::istreambuf_iterator<char>(), ';');
+}
+
+
+void TreeBatch::run(std::ostream& runInfo)
+{
+    _runInfo = &runInfo;
+
+    int numberOfWorkers = std::min(_numberOfConcurrentTrees, _numberOfTrees);
+
+    log() << "\nRunning " << _numberOfTrees << " trees, "
+          << numberOfWorkers << " at a time.\n";
+    log(Message, runInfo) << "Number of trees: " << _numberOfTrees << "\n";
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < numberOfWorkers; i++) {
+        workers.push_back(std::thread(&TreeBatch::runTrees, this));
+    }
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+
+void TreeBatch::runTrees()
+{
+    int treeIndex;
+    while ((treeIndex = nextTree()) < _numberOfTrees) {
+        runTree(treeIndex);
+    }
+}
+
+
+int TreeBatch::nextTree()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _nextTree++;
+}
+
+
+void TreeBatch::runTree(int treeIndex)
+{
+    std::ostringstream treeNumber;
+    treeNumber << treeIndex + 1;
+
+    Settings treeSettings(_settings);
+    treeSettings.set("treeNumber", treeNumber.str());
+    treeSettings.attachRunPrefix(outputPrefix(treeIndex));
+
+    // The screen output of concurrent runs would be interleaved, so
+    // their messages are kept and shown when the tree finishes
+    std::ostringstream treeLog;
+    if (_numberOfConcurrentTrees > 1) {
+        treeSettings.set("printFreq", "0");
+        Log::setThreadMessageStream(&treeLog);
+    }
+
+    Random random(_seeds[treeIndex]);
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+
+    MetropolisCoupledMCMC mc3(random, treeSettings, _modelFactory);
+    if (treeSettings.get<bool>("runMCMC")) {
+        mc3.run();
+    }
+
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double> >
+        (std::chrono::steady_clock::now() - start).count();
+
+    Log::setThreadMessageStream(NULL);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    writeTreeLog(treeIndex, treeLog.str());
+    log() << "\nFinished tree " << treeIndex + 1 << " of "
+          << _numberOfTrees << ".\n";
+    log(Message, *_runInfo) << "Tree " << treeIndex + 1
+        << ": seed " << _seeds[treeIndex]
+        << ", output prefix " << outputPrefix(treeIndex)
+        << ", run time " << seconds << " seconds\n";
+    if (treeSettings.get<bool>("autotune") &&
+        treeSettings.get<bool>("runMCMC")) {
+        log(Message, *_runInfo) << "Tree " << treeIndex + 1
+            << " tuned proposal scales:\n";
+        mc3.writeProposalScales(*_runInfo);
+    }
+    if (treeSettings.get<bool>("adaptProposalWeights") &&
+        treeSettings.get<bool>("runMCMC")) {
+        log(Message, *_runInfo) << "Tree " << treeIndex + 1
+            << " adapted proposal probabilities:\n";
+        mc3.writeProposalProbabilities(*_runInfo);
+    }
+    _runInfo->flush();
+}
+
+
+// Each line is prefixed with the number of its tree
+void TreeBatch::writeTreeLog(int treeIndex, const std::string& treeLog) const
+{
+    std::istringstream lines(treeLog);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (!line.empty()) {
+            log() << "[tree " << treeIndex + 1 << "] " << line << "\n";
+        }
+    }
+}
+
+
+std::string TreeBatch::outputPrefix(int treeIndex) const
+{
+    std::ostringstream prefix;
+    prefix << "tree" << treeIndex + 1;
+    return prefix.str();
+}
@@ -0,0 +1,61 @@
+#ifndef TREE_BATCH_H
+#define TREE_BATCH_H
+
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <iosfwd>
+
+class Random;
+class Settings;
+class ModelFactory;
+
+
+// Runs the analysis on every tree of a file of trees (multipleTrees = 1),
+// such as a posterior sample of trees, in a single process.
+// Each tree is run with its own copy of the settings, in which
+// treeNumber selects the tree and the output files are prefixed with
+// "tree<number>", and with its own pseudorandom generator, seeded from
+// the main one before any tree starts (so results do not depend on the
+// order in which trees finish). Up to numberOfConcurrentTrees trees are
+// run at a time, each with its own numberOfChains chains.
+
+class TreeBatch
+{
+public:
+
+    TreeBatch(Random& random, Settings& settings, ModelFactory* modelFactory);
+
+    // The seed, output prefix and run time of each tree
+    // are written to runInfo as the tree finishes
+    void run(std::ostream& runInfo);
+
+    static int countTrees(const std::string& treeFileName);
+
+private:
+
+    void runTrees();
+    void runTree(int treeIndex);
+    int nextTree();
+
+    void writeTreeLog(int treeIndex, const std::string& treeLog) const;
+    std::string outputPrefix(int treeIndex) const;
+
+    Settings& _settings;
+    ModelFactory* _modelFactory;
+
+    int _numberOfTrees;
+    int _numberOfConcurrentTrees;
+
+    std::vector<unsigned long int> _seeds;
+
+    std::ostream* _runInfo;
+
+    // Guards _nextTree and writes to _runInfo
+    std::mutex _mutex;
+    int _nextTree;
+};
+
+
+#endif
@@ -0,0 +1,777 @@
+#include "TreeSimulator.h"
+#include "Tools.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <set>
+#include <cmath>
+#include <cstdlib>
+
+
+TreeSimulator::TreeSimulator(const std::vector<UserParameter>& parameters)
+{
+    readParameters(parameters);
+}
+
+
+void TreeSimulator::readParameters
+    (const std::vector<UserParameter>& parameters)
+{
+    long int seed = -1;
+
+    _numberOfTips = 100;
+    _numberOfShifts = 0;
+    _lambdaInit = 0.2;
+    _lambdaShift = 0.0;
+    _muInit = 0.05;
+    _betaInit = 0.1;
+    _betaShift = 0.0;
+    _shiftScale = 0.5;
+    _preservationRate = 0.0;
+    _simulateTraits = true;
+    _maxAttempts = 1000;
+    _overwrite = false;
+
+    _outName = "";
+    _treeFileName = "simulated_tree.tre";
+    _eventDataFileName = "simulated_event_data.txt";
+    _traitFileName = "simulated_traits.txt";
+    _traitEventDataFileName = "simulated_trait_event_data.txt";
+
+    for (const UserParameter& parameter : parameters) {
+        const std::string& name = parameter.first;
+        const std::string& value = parameter.second;
+
+        if (name == "seed") {
+            seed = convert_string<long int>(value);
+        } else if (name == "numberOfTips") {
+            _numberOfTips = convert_string<int>(value);
+        } else if (name == "numberOfShifts") {
+            _numberOfShifts = convert_string<int>(value);
+        } else if (name == "lambdaInit0") {
+            _lambdaInit = convert_string<double>(value);
+        } else if (name == "lambdaShift0") {
+            _lambdaShift = convert_string<double>(value);
+        } else if (name == "muInit0") {
+            _muInit = convert_string<double>(value);
+        } else if (name == "betaInit") {
+            _betaInit = convert_string<double>(value);
+        } else if (name == "betaShiftInit") {
+            _betaShift = convert_string<double>(value);
+        } else if (name == "shiftScale") {
+            _shiftScale = convert_string<double>(value);
+        } else if (name == "preservationRateInit") {
+            _preservationRate = convert_string<double>(value);
+        } else if (name == "simulateTraits") {
+            _simulateTraits = convert_string<bool>(value);
+        } else if (name == "maxAttempts") {
+            _maxAttempts = convert_string<int>(value);
+        } else if (name == "overwrite") {
+            _overwrite = convert_string<bool>(value);
+        } else if (name == "outName") {
+            _outName = value;
+        } else if (name == "treefile") {
+            _treeFileName = value;
+        } else if (name == "eventDataOutfile") {
+            _eventDataFileName = value;
+        } else if (name == "traitfile") {
+            _traitFileName = value;
+        } else if (name == "traitEventDataOutfile") {
+            _traitEventDataFileName = value;
+        } else {
+            log(Error) << "Parameter " << name
+                << " is not a simulation parameter.\n";
+            std::exit(1);
+        }
+    }
+
+    if (_numberOfTips < 2) {
+        log(Error) << "numberOfTips must be at least 2.\n";
+        std::exit(1);
+    }
+
+    // Shifts happen when the number of lineages first reaches
+    // distinct counts from 3 to numberOfTips - 1
+    if (_numberOfShifts < 0 || _numberOfShifts > _numberOfTips - 3) {
+        log(Error) << "numberOfShifts must be between 0 and "
+            << "numberOfTips - 3.\n";
+        std::exit(1);
+    }
+
+    if (_lambdaInit <= 0.0 || _muInit < 0.0 || _betaInit <= 0.0 ||
+            _shiftScale < 0.0 || _preservationRate < 0.0) {
+        log(Error) << "Rates must be positive "
+            << "(muInit0 and preservationRateInit may be 0).\n";
+        std::exit(1);
+    }
+
+    _random = (seed > 0) ? Random(seed) : Random();
+}
+
+
+void TreeSimulator::checkOutputFiles() const
+{
+    if (_overwrite) {
+        return;
+    }
+
+    std::vector<std::string> fileNames;
+    fileNames.push_back(_treeFileName);
+    fileNames.push_back(_eventDataFileName);
+    if (_simulateTraits) {
+        fileNames.push_back(_traitFileName);
+        fileNames.push_back(_traitEventDataFileName);
+    }
+
+    for (const std::string& fileName : fileNames) {
+        std::ifstream file(outputFileName(fileName).c_str());
+        if (file) {
+            log(Error) << "Output file " << outputFileName(fileName)
+                << " already exists.\n"
+                << "Fix by removing it or using --overwrite 1.\n";
+            std::exit(1);
+        }
+    }
+}
+
+
+void TreeSimulator::run()
+{
+    checkOutputFiles();
+
+    log() << "Simulating a tree of " << _numberOfTips << " tips with "
+          << _numberOfShifts << " rate shifts (seed "
+          << _random.getSeed() << ").\n";
+
+    int attempts = 0;
+    bool done = false;
+    while (!done) {
+        if (attempts == _maxAttempts) {
+            log(Error) << "No tree was simulated in " << _maxAttempts
+                << " attempts.\nFix by increasing maxAttempts, lowering "
+                << "muInit0, or lowering numberOfShifts.\n";
+            std::exit(1);
+        }
+
+        attempts++;
+        done = simulate() && reconstructTree();
+    }
+
+    writeTree();
+    writeEventData();
+
+    if (_simulateTraits) {
+        simulateTraits();
+        writeTraits();
+    }
+
+    writeSummary(attempts);
+}
+
+
+bool TreeSimulator::Event::operator<(const Event& other) const
+{
+    // Reversed, so that the heap gives the earliest event first
+    return time > other.time;
+}
+
+
+// Returns false if a root lineage or a shift has no descendant left
+// to be sampled (alive or with fossil occurrences)
+bool TreeSimulator::simulate()
+{
+    startSimulation();
+
+    while (!_events.empty()) {
+        std::pop_heap(_events.begin(), _events.end());
+        Event event = _events.back();
+        _events.pop_back();
+
+        if (event.version != _lineages[event.lineage].version) {
+            continue;
+        }
+
+        if (event.type == Extinction) {
+            goExtinct(event.lineage, event.time);
+            if (_cladeLost) {
+                return false;
+            }
+        } else if (event.type == Fossil) {
+            addFossil(event.lineage, event.time);
+            scheduleEvent(event.lineage, event.time);
+        } else {
+            const Regime& regime = _regimes[_lineages[event.lineage].regime];
+            if (_random.uniform() * event.rateBound >
+                    speciationRate(regime, event.time)) {
+                scheduleEvent(event.lineage, event.time);
+                continue;
+            }
+
+            speciate(event.lineage, event.time);
+
+            if ((int)_alive.size() > _maxAlive) {
+                _maxAlive = (int)_alive.size();
+                if (!_shiftCounts.empty() && _shiftCounts.back() == _maxAlive) {
+                    _shiftCounts.pop_back();
+                    shiftRandomLineage(event.time);
+                }
+            }
+
+            // The present is halfway to the next event
+            if ((int)_alive.size() == _numberOfTips) {
+                while (!_events.empty() && _events.front().version !=
+                        _lineages[_events.front().lineage].version) {
+                    std::pop_heap(_events.begin(), _events.end());
+                    _events.pop_back();
+                }
+
+                double nextTime = _events.empty() ?
+                    event.time + 1.0 : _events.front().time;
+                _presentTime = (event.time + nextTime) / 2.0;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+// The simulation starts at the root, with two lineages
+void TreeSimulator::startSimulation()
+{
+    Regime rootRegime = {_lambdaInit, _lambdaShift, _muInit,
+        _betaInit, _betaShift, 0.0};
+    _regimes.assign(1, rootRegime);
+
+    _lineages.clear();
+    _shifts.clear();
+    _events.clear();
+    _alive.clear();
+    _clades.clear();
+    _cladeLost = false;
+
+    Lineage root = {{1, 2}, 0.0, 0.0, false, 0, -1, 0, 0.0, 0, -1};
+    _lineages.push_back(root);
+
+    for (int i = 0; i < 2; i++) {
+        Clade clade = {-1, 0, false};
+        _clades.push_back(clade);
+
+        Lineage child = {{-1, -1}, 0.0, 0.0, false, 0, i, 0, 0.0, 0, -1};
+        _lineages.push_back(child);
+
+        addAlive(i + 1);
+        scheduleEvent(i + 1, 0.0);
+    }
+
+    _maxAlive = 2;
+    _shiftCounts = chooseShiftCounts();
+}
+
+
+// Draws the time and type of the lineage's next event. Speciation times
+// are drawn by thinning, with a rate that bounds the speciation rate
+// from time onward.
+void TreeSimulator::scheduleEvent(int lineage, double time)
+{
+    const Lineage& current = _lineages[lineage];
+    const Regime& regime = _regimes[current.regime];
+
+    double rateBound = regime.lambdaInit;
+    if (regime.lambdaShift < 0.0) {
+        rateBound = speciationRate(regime, time);
+    } else if (regime.lambdaShift > 0.0) {
+        rateBound = 2.0 * regime.lambdaInit;
+    }
+
+    double totalRate = rateBound + regime.muInit + _preservationRate;
+    if (totalRate <= 0.0) {
+        return;
+    }
+
+    Event event;
+    event.time = time + _random.exponential(totalRate);
+    event.lineage = lineage;
+    event.version = current.version;
+    event.rateBound = rateBound;
+
+    double r = _random.uniform(0.0, totalRate);
+    if (r < rateBound) {
+        event.type = Speciation;
+    } else if (r < rateBound + regime.muInit) {
+        event.type = Extinction;
+    } else {
+        event.type = Fossil;
+    }
+
+    _events.push_back(event);
+    std::push_heap(_events.begin(), _events.end());
+}
+
+
+// The children are added before the lineage is removed,
+// so that the clades of the lineage are never left empty
+void TreeSimulator::speciate(int lineage, double time)
+{
+    _lineages[lineage].endTime = time;
+    _lineages[lineage].version++;
+
+    for (int i = 0; i < 2; i++) {
+        Lineage child = {{-1, -1}, time, 0.0, false,
+            _lineages[lineage].regime, _lineages[lineage].clade,
+            0, 0.0, 0, -1};
+
+        int childIndex = (int)_lineages.size();
+        _lineages.push_back(child);
+        _lineages[lineage].children[i] = childIndex;
+
+        addAlive(childIndex);
+        scheduleEvent(childIndex, time);
+    }
+
+    removeAlive(lineage);
+}
+
+
+void TreeSimulator::goExtinct(int lineage, double time)
+{
+    _lineages[lineage].endTime = time;
+    _lineages[lineage].extinct = true;
+    _lineages[lineage].version++;
+    removeAlive(lineage);
+}
+
+
+// A lineage that started before time (not one just born at time) moves
+// to a new regime, whose initial rates are those of the root regime
+// times a log-normal factor with standard deviation shiftScale
+void TreeSimulator::shiftRandomLineage(double time)
+{
+    int lineage;
+    do {
+        lineage = _alive[_random.uniformInteger(0, (int)_alive.size() - 1)];
+    } while (_lineages[lineage].startTime >= time);
+
+    const Regime& root = _regimes[0];
+    Regime regime = {
+        root.lambdaInit * std::exp(_random.normal(0.0, _shiftScale)),
+        root.lambdaShift,
+        root.muInit * std::exp(_random.normal(0.0, _shiftScale)),
+        root.betaInit * std::exp(_random.normal(0.0, _shiftScale)),
+        root.betaShift,
+        time
+    };
+
+    Shift shift = {lineage, time, (int)_regimes.size(), -1};
+    _regimes.push_back(regime);
+    _shifts.push_back(shift);
+
+    // The lineage is already counted in the clades that contain the new one
+    Clade clade = {_lineages[lineage].clade, 1, false};
+    _lineages[lineage].clade = (int)_clades.size();
+    _clades.push_back(clade);
+
+    _lineages[lineage].regime = shift.regime;
+    _lineages[lineage].version++;
+    scheduleEvent(lineage, time);
+}
+
+
+void TreeSimulator::addAlive(int lineage)
+{
+    _lineages[lineage].alivePosition = (int)_alive.size();
+    _alive.push_back(lineage);
+
+    for (int c = _lineages[lineage].clade; c >= 0; c = _clades[c].parent) {
+        _clades[c].alive++;
+    }
+}
+
+
+void TreeSimulator::removeAlive(int lineage)
+{
+    int position = _lineages[lineage].alivePosition;
+    int last = _alive.back();
+
+    _alive[position] = last;
+    _lineages[last].alivePosition = position;
+    _alive.pop_back();
+
+    _lineages[lineage].alivePosition = -1;
+
+    for (int c = _lineages[lineage].clade; c >= 0; c = _clades[c].parent) {
+        _clades[c].alive--;
+        if (_clades[c].alive == 0 && !_clades[c].fossil) {
+            _cladeLost = true;
+        }
+    }
+}
+
+
+void TreeSimulator::addFossil(int lineage, double time)
+{
+    _lineages[lineage].occurrences++;
+    _lineages[lineage].lastOccurrence = time;
+
+    for (int c = _lineages[lineage].clade; c >= 0; c = _clades[c].parent) {
+        _clades[c].fossil = true;
+    }
+}
+
+
+std::vector<int> TreeSimulator::chooseShiftCounts()
+{
+    std::set<int> counts;
+    while ((int)counts.size() < _numberOfShifts) {
+        counts.insert(_random.uniformInteger(3, _numberOfTips - 1));
+    }
+
+    return std::vector<int>(counts.rbegin(), counts.rend());
+}
+
+
+// Builds the tree of the sampled lineages (those alive at the present or
+// with fossil occurrences, and their ancestors). Returns false if either
+// root lineage or any shift has no sampled descendant.
+bool TreeSimulator::reconstructTree()
+{
+    _nodes.clear();
+    _numberOfExtantTips = 0;
+    _numberOfFossilTips = 0;
+
+    _lineageShifts.clear();
+    for (int i = 0; i < (int)_shifts.size(); i++) {
+        _lineageShifts.insert(std::make_pair(_shifts[i].lineage, i));
+    }
+
+    int left = reconstruct(_lineages[0].children[0]);
+    int right = reconstruct(_lineages[0].children[1]);
+    if (left < 0 || right < 0) {
+        return false;
+    }
+
+    _root = addNode(0.0, 0, "");
+    _nodes[_root].left = left;
+    _nodes[_root].right = right;
+    _nodes[left].parent = _root;
+    _nodes[right].parent = _root;
+
+    _nodeShifts.clear();
+    for (int i = 0; i < (int)_shifts.size(); i++) {
+        if (_shifts[i].node < 0) {
+            return false;
+        }
+        _nodeShifts.insert(std::make_pair(_shifts[i].node, i));
+    }
+
+    return true;
+}
+
+
+// Returns the node at the end of the lineage's reconstructed branch,
+// or -1 if the lineage has no sampled descendant. A lineage with a single
+// sampled descendant is merged into the branch of that descendant.
+int TreeSimulator::reconstruct(int lineage)
+{
+    const Lineage& current = _lineages[lineage];
+
+    if (current.alivePosition >= 0) {
+        std::ostringstream name;
+        name << "s" << ++_numberOfExtantTips;
+
+        int node = addNode(_presentTime, current.occurrences, name.str());
+        assignShifts(lineage, node, _presentTime);
+        return node;
+    }
+
+    int left = -1;
+    int right = -1;
+    if (current.children[0] >= 0) {
+        left = reconstruct(current.children[0]);
+        right = reconstruct(current.children[1]);
+    }
+
+    if (left >= 0 && right >= 0) {
+        int node = addNode(current.endTime, current.occurrences, "");
+        _nodes[node].left = left;
+        _nodes[node].right = right;
+        _nodes[left].parent = node;
+        _nodes[right].parent = node;
+
+        assignShifts(lineage, node, current.endTime);
+        return node;
+    } else if (left >= 0 || right >= 0) {
+        int node = (left >= 0) ? left : right;
+        _nodes[node].occurrences += current.occurrences;
+
+        assignShifts(lineage, node, current.endTime);
+        return node;
+    } else if (current.occurrences > 0) {
+        std::ostringstream name;
+        name << "f" << ++_numberOfFossilTips;
+
+        int node = addNode
+            (current.lastOccurrence, current.occurrences, name.str());
+        assignShifts(lineage, node, current.lastOccurrence);
+        return node;
+    }
+
+    return -1;
+}
+
+
+int TreeSimulator::addNode
+    (double time, int occurrences, const std::string& name)
+{
+    TreeNode node = {-1, -1, -1, time, occurrences, name};
+    _nodes.push_back(node);
+    return (int)_nodes.size() - 1;
+}
+
+
+// Shifts on the lineage before endTime are on the branch of node
+void TreeSimulator::assignShifts(int lineage, int node, double endTime)
+{
+    typedef std::multimap<int, int>::const_iterator Iterator;
+    std::pair<Iterator, Iterator> range = _lineageShifts.equal_range(lineage);
+
+    for (Iterator it = range.first; it != range.second; ++it) {
+        Shift& shift = _shifts[it->second];
+        if (shift.time < endTime) {
+            shift.node = node;
+        }
+    }
+}
+
+
+// Brownian motion from 0 at the root, with a variance on each branch
+// equal to the rate (beta) of TraitModel integrated over the branch
+void TreeSimulator::simulateTraits()
+{
+    _traits.assign(_nodes.size(), 0.0);
+    std::vector<int> endRegimes(_nodes.size(), 0);
+
+    std::vector<int> stack;
+    stack.push_back(_root);
+
+    while (!stack.empty()) {
+        int node = stack.back();
+        stack.pop_back();
+
+        if (node != _root) {
+            int regime = endRegimes[_nodes[node].parent];
+            double variance = integratedBeta(node, regime);
+
+            _traits[node] = _traits[_nodes[node].parent] +
+                _random.normal(0.0, std::sqrt(variance));
+            endRegimes[node] = regime;
+        }
+
+        if (_nodes[node].left >= 0) {
+            stack.push_back(_nodes[node].right);
+            stack.push_back(_nodes[node].left);
+        }
+    }
+}
+
+
+// Integrates beta over the branch of node, starting in regime,
+// which is updated to the regime at the end of the branch
+double TreeSimulator::integratedBeta(int node, int& regime) const
+{
+    double time = _nodes[_nodes[node].parent].time;
+    double integral = 0.0;
+
+    typedef std::multimap<int, int>::const_iterator Iterator;
+    std::pair<Iterator, Iterator> range = _nodeShifts.equal_range(node);
+
+    // Shifts are stored in order of time
+    for (Iterator it = range.first; it != range.second; ++it) {
+        const Shift& shift = _shifts[it->second];
+        const Regime& current = _regimes[regime];
+
+        integral += integrateExponentialRate(current.betaInit,
+            current.betaShift, time - current.startTime,
+            shift.time - current.startTime);
+
+        regime = shift.regime;
+        time = shift.time;
+    }
+
+    const Regime& current = _regimes[regime];
+    integral += integrateExponentialRate(current.betaInit, current.betaShift,
+        time - current.startTime, _nodes[node].time - current.startTime);
+
+    return integral;
+}
+
+
+void TreeSimulator::writeTree() const
+{
+    std::ofstream treeFile(outputFileName(_treeFileName).c_str());
+    treeFile << std::setprecision(12);
+    writeNewick(treeFile, _root);
+    treeFile << ";\n";
+}
+
+
+void TreeSimulator::writeNewick(std::ostream& out, int node) const
+{
+    const TreeNode& current = _nodes[node];
+
+    if (current.left >= 0) {
+        out << "(";
+        writeNewick(out, current.left);
+        out << ",";
+        writeNewick(out, current.right);
+        out << ")";
+    } else {
+        out << current.name;
+    }
+
+    if (node != _root) {
+        out << ":" << current.time - _nodes[current.parent].time;
+    }
+}
+
+
+// The true shift configuration, as generation 0 of an event data file
+void TreeSimulator::writeEventData() const
+{
+    std::ofstream eventFile(outputFileName(_eventDataFileName).c_str());
+    eventFile << std::setprecision(12);
+    eventFile << "generation,leftchild,rightchild,abstime,"
+              << "lambdainit,lambdashift,muinit,mushift\n";
+
+    std::ofstream traitEventFile;
+    if (_simulateTraits) {
+        traitEventFile.open(outputFileName(_traitEventDataFileName).c_str());
+        traitEventFile << std::setprecision(12);
+        traitEventFile << "generation,leftchild,rightchild,abstime,"
+                       << "betainit,betashift\n";
+    }
+
+    for (int i = -1; i < (int)_shifts.size(); i++) {
+        int node = (i < 0) ? _root : _shifts[i].node;
+        double time = (i < 0) ? 0.0 : _shifts[i].time;
+        const Regime& regime = _regimes[(i < 0) ? 0 : _shifts[i].regime];
+
+        std::ostringstream event;
+        event << std::setprecision(12) << "0,";
+        if (_nodes[node].left >= 0) {
+            event << tipInSubtree(_nodes[node].left) << ","
+                  << tipInSubtree(_nodes[node].right) << ",";
+        } else {
+            event << _nodes[node].name << ",NA,";
+        }
+        event << time << ",";
+
+        eventFile << event.str() << regime.lambdaInit << ","
+                  << regime.lambdaShift << "," << regime.muInit << ",0\n";
+
+        if (_simulateTraits) {
+            traitEventFile << event.str() << regime.betaInit << ","
+                           << regime.betaShift << "\n";
+        }
+    }
+}
+
+
+void TreeSimulator::writeTraits() const
+{
+    std::ofstream traitFile(outputFileName(_traitFileName).c_str());
+    traitFile << std::setprecision(12);
+
+    for (int i = 0; i < (int)_nodes.size(); i++) {
+        if (_nodes[i].left < 0) {
+            traitFile << _nodes[i].name << "\t" << _traits[i] << "\n";
+        }
+    }
+}
+
+
+void TreeSimulator::writeSummary(int attempts) const
+{
+    // Occurrences on the root's (empty) branch are not part of the tree
+    int occurrences = 0;
+    for (int i = 0; i < (int)_nodes.size(); i++) {
+        if (i != _root) {
+            occurrences += _nodes[i].occurrences;
+        }
+    }
+
+    log() << "Simulated tree in " << attempts << " attempt(s): "
+          << _numberOfExtantTips << " extant tips, "
+          << _numberOfFossilTips << " fossil tips, "
+          << _shifts.size() << " rate shifts, root age "
+          << _presentTime << ".\n";
+    log() << "Tree written to " << outputFileName(_treeFileName)
+          << ", shifts to " << outputFileName(_eventDataFileName) << ".\n";
+
+    if (_simulateTraits) {
+        log() << "Traits written to " << outputFileName(_traitFileName)
+              << ", shifts to " << outputFileName(_traitEventDataFileName)
+              << ".\n";
+    }
+
+    if (_preservationRate > 0.0) {
+        log() << "For a fossil analysis, set numberOccurrences = "
+              << occurrences << " and observationTime = "
+              << std::setprecision(12) << _presentTime << ".\n";
+    }
+}
+
+
+std::string TreeSimulator::tipInSubtree(int node) const
+{
+    while (_nodes[node].left >= 0) {
+        node = _nodes[node].left;
+    }
+
+    return _nodes[node].name;
+}
+
+
+std::string TreeSimulator::outputFileName(const std::string& fileName) const
+{
+    return (_outName == "") ? fileName : _outName + "_" + fileName;
+}
+
+
+double TreeSimulator::speciationRate(const Regime& regime, double time) const
+{
+    return exponentialRate(regime.lambdaInit, regime.lambdaShift,
+        time - regime.startTime);
+}
+
+
+// As Node::getExponentialRate
+double TreeSimulator::exponentialRate(double init, double shift, double t) const
+{
+    if (shift < 0) {
+        return init * std::exp(shift * t);
+    } else if (shift > 0) {
+        return init * (2 - std::exp(-shift * t));
+    } else {
+        return init;
+    }
+}
+
+
+// As Node::integrateExponentialRateFunction
+double TreeSimulator::integrateExponentialRate
+    (double init, double shift, double t1, double t2) const
+{
+    if (shift < 0) {
+        return (init / shift) * (std::exp(shift * t2) - std::exp(shift * t1));
+    } else if (shift > 0) {
+        return init * (2 * (t2 - t1) + (1.0 / shift) *
+            (std::exp(-shift * t2) - std::exp(-shift * t1)));
+    } else {
+        return init * (t2 - t1);
+    }
+}
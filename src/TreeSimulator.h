@@ -0,0 +1,193 @@
+#ifndef TREE_SIMULATOR_H
+#define TREE_SIMULATOR_H
+
+
+#include "Random.h"
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <map>
+
+typedef std::pair<std::string, std::string> UserParameter;
+
+
+// Simulates inputs for BAMM ("bamm simulate --<parameter> <value> ...").
+//
+// A tree is grown forward in time from two lineages under the process
+// SpExModel assumes: each rate regime has a speciation rate that varies
+// exponentially with the time since the regime started (as in
+// Node::getExponentialRate) and a constant extinction rate. When the
+// largest number of living lineages so far first reaches each of
+// numberOfShifts randomly chosen counts, a random lineage shifts to a new
+// regime. The simulation stops when numberOfTips lineages are alive.
+// With preservationRateInit > 0, fossil occurrences are sampled along
+// every lineage, and extinct lineages with occurrences are kept as tips
+// ending at their last occurrence.
+//
+// The reconstructed tree, the true shift configuration (in the event data
+// format read with loadEventData), and trait values simulated by Brownian
+// motion whose rate follows TraitModel's regimes with the same shifts are
+// written out. A simulation is discarded and run again as soon as either
+// root lineage or any shift is left with no descendant to be sampled.
+
+class TreeSimulator
+{
+public:
+
+    TreeSimulator(const std::vector<UserParameter>& parameters);
+
+    void run();
+
+private:
+
+    struct Regime
+    {
+        double lambdaInit;
+        double lambdaShift;
+        double muInit;
+        double betaInit;
+        double betaShift;
+        double startTime;
+    };
+
+    struct Lineage
+    {
+        int children[2];
+        double startTime;
+        double endTime;
+        bool extinct;
+        int regime;
+        int clade;
+        int occurrences;
+        double lastOccurrence;
+        int version;        // Invalidates its scheduled event when changed
+        int alivePosition;  // Position in _alive, or -1
+    };
+
+    struct Shift
+    {
+        int lineage;
+        double time;
+        int regime;
+        int node;           // Node of the reconstructed tree, or -1
+    };
+
+    // The descendants of a root lineage or of a shift, tracked to stop
+    // the simulation as soon as one of them can no longer be sampled
+    struct Clade
+    {
+        int parent;
+        int alive;
+        bool fossil;
+    };
+
+    enum EventType
+    {
+        Speciation,
+        Extinction,
+        Fossil
+    };
+
+    struct Event
+    {
+        double time;
+        int lineage;
+        int version;
+        EventType type;
+        double rateBound;   // For thinning speciation events
+
+        bool operator<(const Event& other) const;
+    };
+
+    struct TreeNode
+    {
+        int left;
+        int right;
+        int parent;
+        double time;
+        int occurrences;    // On the branch leading to the node
+        std::string name;
+    };
+
+    void readParameters(const std::vector<UserParameter>& parameters);
+    void checkOutputFiles() const;
+
+    bool simulate();
+    void startSimulation();
+    void scheduleEvent(int lineage, double time);
+    void speciate(int lineage, double time);
+    void goExtinct(int lineage, double time);
+    void shiftRandomLineage(double time);
+    void addAlive(int lineage);
+    void removeAlive(int lineage);
+    void addFossil(int lineage, double time);
+    std::vector<int> chooseShiftCounts();
+
+    bool reconstructTree();
+    int reconstruct(int lineage);
+    int addNode(double time, int occurrences, const std::string& name);
+    void assignShifts(int lineage, int node, double endTime);
+
+    void simulateTraits();
+    double integratedBeta(int node, int& regime) const;
+
+    void writeTree() const;
+    void writeNewick(std::ostream& out, int node) const;
+    void writeEventData() const;
+    void writeTraits() const;
+    void writeSummary(int attempts) const;
+
+    std::string tipInSubtree(int node) const;
+    std::string outputFileName(const std::string& fileName) const;
+
+    double speciationRate(const Regime& regime, double time) const;
+    double exponentialRate(double init, double shift, double t) const;
+    double integrateExponentialRate
+        (double init, double shift, double t1, double t2) const;
+
+    Random _random;
+
+    int _numberOfTips;
+    int _numberOfShifts;
+    double _lambdaInit;
+    double _lambdaShift;
+    double _muInit;
+    double _betaInit;
+    double _betaShift;
+    double _shiftScale;
+    double _preservationRate;
+    bool _simulateTraits;
+    int _maxAttempts;
+    bool _overwrite;
+
+    std::string _outName;
+    std::string _treeFileName;
+    std::string _eventDataFileName;
+    std::string _traitFileName;
+    std::string _traitEventDataFileName;
+
+    // State of the current simulation
+    std::vector<Regime> _regimes;
+    std::vector<Lineage> _lineages;
+    std::vector<Shift> _shifts;
+    std::vector<Clade> _clades;
+    bool _cladeLost;
+    std::vector<Event> _events;     // Heap ordered by time
+    std::vector<int> _alive;
+    std::vector<int> _shiftCounts;  // Decreasing, so the next is at back()
+    std::multimap<int, int> _lineageShifts;
+    int _maxAlive;
+    double _presentTime;
+
+    // Reconstructed tree, with the root at _nodes[_root]
+    std::vector<TreeNode> _nodes;
+    int _root;
+    int _numberOfExtantTips;
+    int _numberOfFossilTips;
+    std::multimap<int, int> _nodeShifts;
+    std::vector<double> _traits;
+};
+
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef TYPED_SETTINGS_H
+#define TYPED_SETTINGS_H
+
+
+#include <string>
+
+
+// Typed views of the control file settings, one per subsystem.
+// They are converted and validated once by Settings after all user
+// and command-line values are read, so that models and proposals never
+// need to look up a parameter by name while the MCMC is running.
+
+
+struct MCMCSettings
+{
+    int numberOfGenerations;
+
+    // Metropolis-coupled MCMC
+    int numberOfChains;
+    double deltaT;
+    int swapPeriod;
+    int numberOfChainThreads;
+
+    // Number of chains whose likelihoods are computed together
+    int numberOfChainLanes;
+
+    int acceptanceResetFreq;
+};
+
+
+struct ModelSettings
+{
+    bool sampleFromPriorOnly;
+    bool validateEventConfiguration;
+
+    bool loadEventData;
+    std::string eventDataInfile;
+    int initialNumberEvents;
+
+    // Number of candidates per multiple-try move (1 = single proposal)
+    int multipleTryCandidates;
+};
+
+
+struct ProposalSettings
+{
+    double updateRateEventNumber;
+    double updateRateEventNumberForBranch;
+    double updateRateEventPosition;
+    double updateRateEventRate;
+
+    double updateEventLocationScale;
+    double updateEventRateScale;
+    double localGlobalMoveRatio;
+
+    bool autotune;
+    bool adaptProposalWeights;
+    int autotuneGenerations;
+    double autotuneTargetAcceptance;
+};
+
+
+struct PriorSettings
+{
+    double poissonRatePrior;
+
+    // Speciation/extinction
+    double lambdaInitPrior;
+    double lambdaShiftPrior;
+    double muInitPrior;
+    double muShiftPrior;
+    double lambdaInitRootPrior;
+    double lambdaShiftRootPrior;
+    double muInitRootPrior;
+    double muShiftRootPrior;
+    double lambdaIsTimeVariablePrior;
+
+    double preservationRatePrior;
+
+    // Trait
+    double betaInitPrior;
+    double betaShiftPrior;
+    double betaInitRootPrior;
+    double betaShiftRootPrior;
+    double betaIsTimeVariablePrior;
+};
+
+
+// How the extinction probabilities of the two descendant branches
+// are combined at an internal node (combineExtinctionAtNodes)
+enum ExtinctionCombination
+{
+    RandomDescendant,
+    IfDifferent,
+    FavorShift,
+    LeftDescendant,
+    RightDescendant
+};
+
+
+struct SpExSettings
+{
+    // Starting parameters
+    double lambdaInit0;
+    double lambdaShift0;
+    double muInit0;
+    double muShift0;
+
+    // Parameter update rates
+    double updateRateLambda0;
+    double updateRateLambdaShift;
+    double updateRateMu0;
+    double updateRateMuShift;
+    double updateRateLambdaTimeMode;
+
+    // MCMC tuning
+    double updateLambdaInitScale;
+    double updateLambdaShiftScale;
+    double updateMuInitScale;
+    double updateMuShiftScale;
+
+    double segLength;
+    double extinctionProbMax;
+
+    // -1 = decide from the data, 0 = false, 1 = true
+    int conditionOnSurvival;
+    bool alwaysRecomputeE0;
+    ExtinctionCombination combineExtinctionAtNodes;
+
+    // Delayed acceptance (surrogate uses delayedAcceptanceSegLength)
+    bool delayedAcceptance;
+    double delayedAcceptanceSegLength;
+
+    // Fossil preservation
+    double preservationRateInit;
+    double observationTime;
+    int numberOccurrences;
+    std::string preservationBinsFilename;   // Empty for a single rate
+    double updateRatePreservationRate;
+    double updatePreservationRateScale;
+};
+
+
+struct TraitSettings
+{
+    // Starting parameters
+    double betaInit;
+    double betaShiftInit;
+
+    // Parameter update rates
+    double updateRateBeta0;
+    double updateRateBetaShift;
+    double updateRateNodeState;
+    double updateRateBetaTimeMode;
+
+    // MCMC tuning
+    double updateBetaInitScale;
+    double updateBetaShiftScale;
+    double updateNodeStateScale;
+
+    double traitPriorMin;
+    double traitPriorMax;
+};
+
+
+#endif
@@ -0,0 +1,98 @@
+#include "WorkerPool.h"
+
+
+WorkerPool::WorkerPool(int numberOfThreads) :
+    _task(NULL), _count(0), _nextTask(0), _unfinishedTasks(0), _round(0),
+    _stopping(false)
+{
+    for (int i = 1; i < numberOfThreads; i++) {
+        _threads.push_back(std::thread(&WorkerPool::work, this));
+    }
+}
+
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _tasksReady.notify_all();
+
+    for (std::thread& thread : _threads) {
+        thread.join();
+    }
+}
+
+
+void WorkerPool::run(int count, const std::function<void(int)>& task)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _task = &task;
+        _count = count;
+        _nextTask = 0;
+        _unfinishedTasks = count;
+        _round++;
+    }
+    _tasksReady.notify_all();
+
+    runTasks();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _tasksDone.wait(lock, [this]() { return _unfinishedTasks == 0; });
+    _task = NULL;
+}
+
+
+// Threads wait for a new round of tasks and help until none are left
+void WorkerPool::work()
+{
+    unsigned long lastRound = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _tasksReady.wait(lock,
+                [&]() { return _stopping || _round != lastRound; });
+            if (_stopping) {
+                return;
+            }
+            lastRound = _round;
+        }
+
+        runTasks();
+    }
+}
+
+
+void WorkerPool::runTasks()
+{
+    for (;;) {
+        int i;
+        const std::function<void(int)>* task;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_task == NULL || _nextTask >= _count) {
+                return;
+            }
+            i = _nextTask++;
+            task = _task;
+        }
+
+        (*task)(i);
+
+        bool allDone;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            allDone = (--_unfinishedTasks == 0);
+        }
+        if (allDone) {
+            _tasksDone.notify_all();
+        }
+    }
+}
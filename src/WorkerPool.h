@@ -0,0 +1,55 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+
+// A fixed set of threads, created once, that run the tasks of run()
+// together with the calling thread. Used by the multiple-try proposal
+// of a chain, so no threads are created for each proposal.
+
+class WorkerPool
+{
+public:
+
+    // Uses numberOfThreads threads in all, the calling thread included
+    WorkerPool(int numberOfThreads);
+    ~WorkerPool();
+
+    // Calls task(i) for each i in [0, count) and returns when all are done
+    void run(int count, const std::function<void(int)>& task);
+
+    int numberOfThreads() const;
+
+private:
+
+    void work();
+    void runTasks();
+
+    std::vector<std::thread> _threads;
+
+    std::mutex _mutex;
+    std::condition_variable _tasksReady;
+    std::condition_variable _tasksDone;
+
+    const std::function<void(int)>* _task;
+    int _count;
+    int _nextTask;
+    int _unfinishedTasks;
+    unsigned long _round;
+    bool _stopping;
+};
+
+
+inline int WorkerPool::numberOfThreads() const
+{
+    return (int)_threads.size() + 1;
+}
+
+
+#endif
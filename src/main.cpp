@@ -6,6 +6,8 @@
 #include "TraitModelFactory.h"
 #include "FastSimulatePrior.h"
 #include "MetropolisCoupledMCMC.h"
+#include "TreeBatch.h"
+#include "TreeSimulator.h"
 #include "Log.h"
 
 #include <iostream>
@@ -26,6 +28,13 @@ int main (int argc, char* argv[])
 {
     // Process command-line arguments and load settings
     CommandLineProcessor commandLine(argc, argv);
+
+    if (commandLine.command() == "simulate") {
+        TreeSimulator simulator(commandLine.parameters());
+        simulator.run();
+        return 0;
+    }
+
     Settings settings(commandLine.controlFileName(), commandLine.parameters());
 
     printAboutInformation();
@@ -48,28 +57,43 @@ int main (int argc, char* argv[])
     // Create model factory based on model type
     ModelFactory* modelFactory = createModelFactory(settings.get("modeltype"));
      
-    if (settings.get<bool>("initializeModel")) {
+    if (settings.get<bool>("multipleTrees")) {
+        // Each tree is run as in the single-tree case below
+        if (settings.get<bool>("initializeModel")) {
+            TreeBatch treeBatch(random, settings, modelFactory);
+            treeBatch.run(runInfoFile);
+        }
+    } else if (settings.get<bool>("initializeModel")) {
         // MetropolisCoupledMCMC will initialize model(s)
          MetropolisCoupledMCMC mc3(random, settings, modelFactory);
          
         if (settings.get<bool>("runMCMC")) {
         
              mc3.run();
+
+            // The tuned scales can be copied into the control file
+            if (settings.get<bool>("autotune")) {
+                log(Message, runInfoFile) << "Tuned proposal scales:\n";
+                mc3.writeProposalScales(runInfoFile);
+                log() << "\nTuned proposal scales:\n";
+                mc3.writeProposalScales(std::cout);
+            }
+
+            if (settings.get<bool>("adaptProposalWeights")) {
+                log(Message, runInfoFile)
+                    << "Adapted proposal probabilities:\n";
+                mc3.writeProposalProbabilities(runInfoFile);
+                log() << "\nAdapted proposal probabilities:\n";
+                mc3.writeProposalProbabilities(std::cout);
+            }
          }
         
     }
 
     delete modelFactory;
 
-    if (settings.get<bool>("simulatePriorShifts")){
-        
-        std::cout << "\n***********************************************" << std::endl;
-        std::cout << "You selected to simulate the prior distribution of shifts." << std::endl;
-        std::cout << "This option has been disabled, as the " << std::endl;
-        std::cout << "exact (analytical) prior is now implemented in BAMMtools. " << std::endl;
-        std::cout << "Please consult the website or BAMMtools documentation " << std::endl;
-        std::cout << "for more information\n\n" << std::endl;
-        //FastSimulatePrior fsp(random, &settings);
+    if (settings.get<bool>("simulatePriorShifts")) {
+        FastSimulatePrior fsp(random, &settings);
     }
 
     log(Message, runInfoFile) << "End time: " << currentTime() << "\n";
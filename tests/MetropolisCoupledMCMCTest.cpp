@@ -0,0 +1,169 @@
+#include "gtest/gtest.h"
+#include "MetropolisCoupledMCMC.h"
+#include "RandomStreams.h"
+#include "Random.h"
+#include "Settings.h"
+#include "SpExModelFactory.h"
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <climits>
+#include <cstdio>
+
+
+void writeReproducibilityInputFiles();
+void removeReproducibilityFiles();
+std::string runWithChainThreads(int numberOfChainThreads,
+    int multipleTryCandidates);
+std::string readFile(const std::string& fileName);
+
+
+TEST(RandomStreams, Derivation)
+{
+    RandomStreams streams(1979);
+
+    // Seeds depend only on the master seed and the stream's identity
+    EXPECT_EQ(streams.seed(2, RandomStreams::ChainStream),
+        RandomStreams(1979).seed(2, RandomStreams::ChainStream));
+
+    // Streams that differ in any one component have different seeds
+    unsigned long int seed = streams.seed(1, RandomStreams::WorkerStream, 3);
+    EXPECT_NE(seed, streams.seed(0, RandomStreams::WorkerStream, 3));
+    EXPECT_NE(seed, streams.seed(1, RandomStreams::ChainStream, 3));
+    EXPECT_NE(seed, streams.seed(1, RandomStreams::WorkerStream, 2));
+    EXPECT_NE(seed, RandomStreams(1980).seed(1, RandomStreams::WorkerStream, 3));
+
+    // Seeds are in the range accepted by MbRandom
+    for (int i = 0; i < 1000; i++) {
+        seed = streams.seed(i, RandomStreams::ChainStream);
+        EXPECT_GE(seed, 1UL);
+        EXPECT_LE(seed, (unsigned long int)(INT_MAX - 1));
+    }
+}
+
+
+// The cold chain must not depend on how many threads run the chains,
+// with and without multiple-try workers
+TEST(MetropolisCoupledMCMC, ReproducibleAcrossThreads)
+{
+    writeReproducibilityInputFiles();
+
+    for (int candidates = 1; candidates <= 3; candidates += 2) {
+        std::string mcmcOut = runWithChainThreads(1, candidates);
+        ASSERT_NE("", mcmcOut);
+
+        EXPECT_EQ(mcmcOut, runWithChainThreads(2, candidates));
+        EXPECT_EQ(mcmcOut, runWithChainThreads(8, candidates));
+    }
+
+    removeReproducibilityFiles();
+}
+
+
+void writeReproducibilityInputFiles()
+{
+    std::ofstream treeFile("mc3_test_tree.txt");
+    treeFile << "(((A:1.0,B:1.0):1.0,(C:1.5,D:1.5):0.5):2.0,"
+                "((E:0.5,F:0.5):2.5,(G:2.0,H:2.0):1.0):1.0);\n";
+
+    std::ofstream controlFile("mc3_test_control.txt");
+    controlFile
+        << "modeltype = speciationextinction\n"
+        << "treefile = mc3_test_tree.txt\n"
+        << "runInfoFilename = mc3_test_run_info.txt\n"
+        << "runMCMC = 1\n"
+        << "initializeModel = 1\n"
+        << "useGlobalSamplingProbability = 1\n"
+        << "globalSamplingFraction = 1.0\n"
+        << "overwrite = 1\n"
+        << "expectedNumberOfShifts = 1.0\n"
+        << "lambdaInitPrior = 1.0\n"
+        << "lambdaShiftPrior = 0.05\n"
+        << "muInitPrior = 1.0\n"
+        << "lambdaIsTimeVariablePrior = 1\n"
+        << "seed = 1979\n"
+        << "numberOfGenerations = 4000\n"
+        << "mcmcWriteFreq = 100\n"
+        << "eventDataWriteFreq = 1000\n"
+        << "printFreq = 0\n"
+        << "acceptanceResetFreq = 1000\n"
+        << "updateLambdaInitScale = 2.0\n"
+        << "updateLambdaShiftScale = 0.1\n"
+        << "updateMuInitScale = 2.0\n"
+        << "updateEventLocationScale = 0.05\n"
+        << "updateEventRateScale = 4.0\n"
+        << "updateRateEventNumber = 1\n"
+        << "updateRateEventPosition = 1\n"
+        << "updateRateEventRate = 1\n"
+        << "updateRateLambda0 = 1\n"
+        << "updateRateLambdaShift = 1\n"
+        << "updateRateMu0 = 1\n"
+        << "updateRateLambdaTimeMode = 0\n"
+        << "localGlobalMoveRatio = 10.0\n"
+        << "lambdaInit0 = 0.2\n"
+        << "lambdaShift0 = 0\n"
+        << "muInit0 = 0.01\n"
+        << "initialNumberEvents = 0\n"
+        << "numberOfChains = 8\n"
+        << "deltaT = 0.1\n"
+        << "swapPeriod = 100\n"
+        << "segLength = 0.02\n";
+}
+
+
+void removeReproducibilityFiles()
+{
+    const char* fileNames[] = {
+        "mc3_test_tree.txt", "mc3_test_control.txt",
+        "mc3_test_mcmc_out_1.txt", "mc3_test_mcmc_out_2.txt",
+        "mc3_test_mcmc_out_8.txt", "mc3_test_event_data.txt",
+        "mc3_test_chain_swap.txt", "mc3_test_run_info.txt" };
+
+    for (const char* fileName : fileNames) {
+        std::remove(fileName);
+    }
+}
+
+
+std::string runWithChainThreads(int numberOfChainThreads,
+    int multipleTryCandidates)
+{
+    std::ostringstream threads;
+    threads << numberOfChainThreads;
+    std::ostringstream candidates;
+    candidates << multipleTryCandidates;
+
+    std::string mcmcOutfile = "mc3_test_mcmc_out_" + threads.str() + ".txt";
+
+    std::vector<UserParameter> parameters;
+    parameters.push_back(UserParameter("numberOfChainThreads", threads.str()));
+    parameters.push_back
+        (UserParameter("multipleTryCandidates", candidates.str()));
+    parameters.push_back(UserParameter("mcmcOutfile", mcmcOutfile));
+    parameters.push_back(UserParameter("eventDataOutfile",
+        "mc3_test_event_data.txt"));
+    parameters.push_back(UserParameter("chainSwapFileName",
+        "mc3_test_chain_swap.txt"));
+
+    Settings settings("mc3_test_control.txt", parameters);
+    Random random(settings.get<long int>("seed"));
+    SpExModelFactory modelFactory;
+
+    {
+        MetropolisCoupledMCMC mc3(random, settings, &modelFactory);
+        mc3.run();
+    }
+
+    return readFile(mcmcOutfile);
+}
+
+
+std::string readFile(const std::string& fileName)
+{
+    std::ifstream file(fileName.c_str());
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
@@ -0,0 +1,212 @@
+#include "gtest/gtest.h"
+#include "Tree.h"
+#include "Node.h"
+#include "Random.h"
+#include "Settings.h"
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdio>
+
+
+void writeTreeTestInputFiles();
+void removeTreeTestFiles();
+
+
+// ((A,B)AB,(C,D)CD)R, with a zero-length root branch
+class TreeTest : public ::testing::Test
+{
+protected:
+
+    TreeTest() : random(1979)
+    {
+        writeTreeTestInputFiles();
+        settings = new Settings("tree_test_control.txt",
+            std::vector<UserParameter>());
+        tree = new Tree(random, *settings);
+    }
+
+    ~TreeTest()
+    {
+        delete tree;
+        delete settings;
+    }
+
+    virtual void TearDown()
+    {
+        removeTreeTestFiles();
+    }
+
+    Random random;
+    Settings* settings;
+    Tree* tree;
+};
+
+
+// A branch holds (start, end] of the map when events are placed on it
+TEST_F(TreeTest, MapEventToTreeBoundaries)
+{
+    Node* root = tree->getRoot();
+    EXPECT_EQ(0.0, root->getMapStart());
+    EXPECT_EQ(0.0, root->getMapEnd());
+    EXPECT_EQ(6.5, tree->getTotalMapLength());
+
+    const std::vector<Node*>& nodes = tree->preOrderNodes();
+    for (int i = 0; i < (int)nodes.size(); i++) {
+        Node* node = nodes[i];
+        if (node == root) {
+            continue;
+        }
+
+        EXPECT_EQ(node, tree->mapEventToTree(node->getMapEnd()));
+        if (node->getMapStart() > 0.0) {
+            EXPECT_NE(node, tree->mapEventToTree(node->getMapStart()));
+        }
+    }
+
+    // The zero-length root branch holds no part of the map
+    // (the "unmapped event" message this prints is not shown)
+    std::ostringstream unmappedMessage;
+    std::streambuf* screen = std::cout.rdbuf(unmappedMessage.rdbuf());
+    Node* unmapped = tree->mapEventToTree(0.0);
+    std::cout.rdbuf(screen);
+    EXPECT_EQ(NULL, unmapped);
+    EXPECT_NE(root, tree->mapEventToTree(1.0e-12));
+    EXPECT_NE(root, tree->mapEventToTree(tree->getTotalMapLength()));
+}
+
+
+// A branch holds [start, end) of the map when converted to times
+TEST_F(TreeTest, AbsoluteTimeFromMapTimeBoundaries)
+{
+    Node* root = tree->getRoot();
+
+    const std::vector<Node*>& nodes = tree->preOrderNodes();
+    for (int i = 0; i < (int)nodes.size(); i++) {
+        Node* node = nodes[i];
+        if (node == root) {
+            continue;
+        }
+
+        EXPECT_DOUBLE_EQ(node->getTime(),
+            tree->getAbsoluteTimeFromMapTime(node->getMapStart()));
+        double middle = (node->getMapStart() + node->getMapEnd()) / 2.0;
+        EXPECT_DOUBLE_EQ(node->getTime() - node->getBrlen() / 2.0,
+            tree->getAbsoluteTimeFromMapTime(middle));
+    }
+
+    // Map time 0 is past the end of the zero-length root branch
+    Node* first = tree->mapEventToTree(1.0e-12);
+    EXPECT_EQ(0.0, first->getMapStart());
+    EXPECT_DOUBLE_EQ(first->getTime(), tree->getAbsoluteTimeFromMapTime(0.0));
+}
+
+
+TEST_F(TreeTest, CladeRanges)
+{
+    Node* root = tree->getRoot();
+    Node* ab = tree->getNodeByName("AB");
+    Node* a = tree->getNodeByName("A");
+    Node* c = tree->getNodeByName("C");
+
+    const std::vector<Node*>& nodes = tree->preOrderNodes();
+    ASSERT_EQ(7, (int)nodes.size());
+
+    EXPECT_EQ(0, tree->cladeBegin(root));
+    EXPECT_EQ(7, tree->cladeEnd(root));
+    EXPECT_EQ(3, tree->cladeEnd(ab) - tree->cladeBegin(ab));
+    EXPECT_EQ(1, tree->cladeEnd(a) - tree->cladeBegin(a));
+    EXPECT_EQ(ab, nodes[tree->cladeBegin(ab)]);
+
+    EXPECT_EQ(3, tree->internalCladeEnd(root) - tree->internalCladeBegin(root));
+    EXPECT_EQ(1, tree->internalCladeEnd(ab) - tree->internalCladeBegin(ab));
+    EXPECT_EQ(0, tree->internalCladeEnd(a) - tree->internalCladeBegin(a));
+    EXPECT_EQ(ab, tree->internalNodes()[tree->internalCladeBegin(ab)]);
+
+    EXPECT_TRUE(tree->isInClade(a, ab));
+    EXPECT_TRUE(tree->isInClade(ab, ab));
+    EXPECT_FALSE(tree->isInClade(c, ab));
+    EXPECT_FALSE(tree->isInClade(ab, a));
+
+    EXPECT_EQ(4, tree->getDescTipCount(root));
+    EXPECT_EQ(2, tree->getDescTipCount(ab));
+    EXPECT_EQ(1, tree->getDescTipCount(a));
+    EXPECT_EQ(6, tree->getDescNodeCount(root));
+}
+
+
+TEST_F(TreeTest, NodeMRCA)
+{
+    Node* root = tree->getRoot();
+    Node* ab = tree->getNodeByName("AB");
+
+    EXPECT_EQ(ab, tree->getNodeMRCA("A", "B"));
+    EXPECT_EQ(root, tree->getNodeMRCA("A", "C"));
+
+    // When one node is an ancestor of the other, the MRCA is the first
+    // ancestor of the second node whose clade holds the first
+    EXPECT_EQ(ab, tree->getNodeMRCA("AB", "A"));
+    EXPECT_EQ(root, tree->getNodeMRCA("A", "AB"));
+    EXPECT_EQ(root, tree->getNodeMRCA("R", "CD"));
+}
+
+
+void writeTreeTestInputFiles()
+{
+    std::ofstream treeFile("tree_test_tree.txt");
+    treeFile << "((A:1.0,B:1.0)AB:1.0,(C:1.5,D:1.5)CD:0.5)R;\n";
+
+    std::ofstream controlFile("tree_test_control.txt");
+    controlFile
+        << "modeltype = speciationextinction\n"
+        << "treefile = tree_test_tree.txt\n"
+        << "runInfoFilename = tree_test_run_info.txt\n"
+        << "runMCMC = 0\n"
+        << "initializeModel = 0\n"
+        << "useGlobalSamplingProbability = 1\n"
+        << "globalSamplingFraction = 1.0\n"
+        << "overwrite = 1\n"
+        << "expectedNumberOfShifts = 1.0\n"
+        << "lambdaInitPrior = 1.0\n"
+        << "lambdaShiftPrior = 0.05\n"
+        << "muInitPrior = 1.0\n"
+        << "lambdaIsTimeVariablePrior = 1\n"
+        << "seed = 1979\n"
+        << "numberOfGenerations = 1\n"
+        << "mcmcWriteFreq = 1\n"
+        << "eventDataWriteFreq = 1\n"
+        << "printFreq = 0\n"
+        << "acceptanceResetFreq = 1\n"
+        << "updateLambdaInitScale = 2.0\n"
+        << "updateLambdaShiftScale = 0.1\n"
+        << "updateMuInitScale = 2.0\n"
+        << "updateEventLocationScale = 0.05\n"
+        << "updateEventRateScale = 4.0\n"
+        << "updateRateEventNumber = 1\n"
+        << "updateRateEventPosition = 1\n"
+        << "updateRateEventRate = 1\n"
+        << "updateRateLambda0 = 1\n"
+        << "updateRateLambdaShift = 1\n"
+        << "updateRateMu0 = 1\n"
+        << "updateRateLambdaTimeMode = 0\n"
+        << "localGlobalMoveRatio = 10.0\n"
+        << "lambdaInit0 = 0.2\n"
+        << "lambdaShift0 = 0\n"
+        << "muInit0 = 0.01\n"
+        << "initialNumberEvents = 0\n"
+        << "numberOfChains = 1\n"
+        << "deltaT = 0.1\n"
+        << "swapPeriod = 100\n"
+        << "segLength = 0.02\n";
+}
+
+
+void removeTreeTestFiles()
+{
+    std::remove("tree_test_tree.txt");
+    std::remove("tree_test_control.txt");
+    std::remove("tree_test_run_info.txt");
+}